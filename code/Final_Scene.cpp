@@ -58,6 +58,31 @@ namespace project_template
 
     unsigned Final_Scene::textures_count = sizeof(textures_data) / sizeof(Texture_Data);
 
+    // ---------------------------------------------------------------------------------------------
+
+    Texture_2D::Options Final_Scene::get_texture_options ()
+    {
+        // Tras subirlas a la GPU no se conservan sus píxeles. Si se pierde el contexto se vuelven a
+        // leer de los assets:
+
+        Texture_2D::Options options = Texture_2D::Options();
+
+        options.residency = Texture_2D::RELOAD_FROM_ASSET;
+
+        return options;
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    Asset_Prefetcher::Request_List Final_Scene::get_texture_requests ()
+    {
+        Asset_Prefetcher::Request_List requests;
+
+        Asset_Prefetcher::add_textures (requests, textures_data, textures_count, get_texture_options ());
+
+        return requests;
+    }
+
     Final_Scene::Final_Scene()
     {
         state         = LOADING;
@@ -65,6 +90,9 @@ namespace project_template
         canvas_width  = 720;
         canvas_height = 1280;
 
+        set_render_on_demand (true);            // La pantalla final es estática: solo se redibuja cuando cambia
+
+        add_successor_assets (Game_Scene::get_texture_requests ());     // Desde la pantalla final se vuelve a jugar
     }
 
     Final_Scene::Final_Scene(float _litters)
@@ -79,12 +107,18 @@ namespace project_template
         else if (_litters >= one_point_achivement && _litters < two_point_achivement)   points = 1;
         else if (_litters >= two_point_achivement && _litters < three_point_achivement) points = 2;
         else if (_litters >= three_point_achivement)                                    points = 3;
+
+        set_render_on_demand (true);
+
+        add_successor_assets (Game_Scene::get_texture_requests ());
     }
 
     // ---------------------------------------------------------------------------------------------
 
     bool Final_Scene::initialize ()
     {
+        loading_requested = false;
+
         state     = LOADING;
         suspended = true;
 
@@ -130,7 +164,7 @@ namespace project_template
 
         if (!suspended) switch (state)
             {
-                case LOADING: load_textures  ();     break;
+                case LOADING: load_textures  (); invalidate (); break;
                 case READY: run_simulation (time); break;
                 case ERROR:   break;
             }
@@ -172,8 +206,8 @@ namespace project_template
 
     // ---------------------------------------------------------------------------------------------
 
-    // En este método solo se carga una textura por fotograma para poder pausar la carga si el
-    // juego pasa a segundo plano inesperadamente. Otro aspecto interesante es que la carga no
+    // Las texturas se leen y decodifican en los hilos de texture_loader, por lo que la escena sigue
+    // atendiendo a la aplicación si el juego pasa a segundo plano inesperadamente. Otro aspecto interesante es que la carga no
     // comienza hasta que la escena se inicia para así tener la posibilidad de mostrar al usuario
     // que la carga está en curso en lugar de tener una pantalla en negro que no responde durante
     // un tiempo.
@@ -182,6 +216,25 @@ namespace project_template
     {
         if (textures.size () < textures_count)          // Si quedan texturas por cargar...
         {
+            // La primera vez se encargan todas las texturas a texture_loader, que las lee y decodifica
+            // en segundo plano mientras la escena sigue actualizándose:
+
+            if (!loading_requested)
+            {
+                texture_loader.load_batch
+                (
+                    textures_data,
+                    textures_count,
+                    [this] (Id id, const Texture_Handle & texture)
+                    {
+                        if (texture) textures[id] = texture; else state = ERROR;
+                    },
+                    get_texture_options ()
+                );
+
+                loading_requested = true;
+            }
+
             // Las texturas se cargan y se suben al contexto gráfico, por lo que es necesario disponer
             // de uno:
 
@@ -195,14 +248,10 @@ namespace project_template
                     adjust_aspect_ratio(context);
                 }
 
-                // Se carga la siguiente textura (textures.size() indica cuántas llevamos cargadas):
-
-                Texture_Data   & texture_data = textures_data[textures.size ()];
-                Texture_Handle & texture      = textures[texture_data.id] = Texture_2D::create (texture_data.id, context, texture_data.path);
+                // Solo la subida a la GPU tiene que hacerse en este hilo. En cada fotograma se suben
+                // las texturas ya decodificadas que quepan en el presupuesto del cargador:
 
-                // Se comprueba si la textura se ha podido cargar correctamente:
-
-                if (texture) context->add (texture); else state = ERROR;
+                texture_loader.upload (context);
 
                 // Cuando se han terminado de cargar todas las texturas se pueden crear los gameobjects que
                 // las usarán e iniciar el juego:
@@ -215,6 +264,10 @@ namespace project_template
             state = READY;                              // el mensaje de carga no aparezca y desaparezca
                                                         // demasiado rápido.
 
+            // Mientras se muestra la puntuación se preparan las imágenes de la siguiente partida:
+
+            prefetch_successors ();
+
         }
     }
 
@@ -315,12 +368,22 @@ namespace project_template
         }
 
 
+            GameObject * points_pointer = nullptr;
+
             switch (points)
             {
-                case 0: zero_points_pointer -> show(); break;
-                case 1: one_points_pointer -> show(); break;
-                case 2: two_points_pointer -> show(); break;
-                case 3: three_points_pointer -> show(); break;
+                case 0: points_pointer = zero_points_pointer;  break;
+                case 1: points_pointer = one_points_pointer;   break;
+                case 2: points_pointer = two_points_pointer;   break;
+                case 3: points_pointer = three_points_pointer; break;
+            }
+
+            // Solo hace falta redibujar la primera vez que aparece el marcador:
+
+            if (points_pointer && points_pointer->is_not_visible ())
+            {
+                points_pointer->show ();
+                invalidate ();
             }
 
 
@@ -18,7 +18,8 @@ namespace project_template
 
     GameObject::GameObject(Texture_2D * texture, float aspect_ratio)
     :
-        texture (texture)
+        texture (texture),
+        slice   (nullptr)
     {
         anchor   = basics::CENTER;
         position = { 0.f, 0.f };
@@ -28,6 +29,19 @@ namespace project_template
         visible  = true;
     }
 
+    GameObject::GameObject(const Atlas::Slice * slice, float aspect_ratio)
+    :
+        texture (nullptr),
+        slice   (slice)
+    {
+        anchor   = basics::CENTER;
+        position = { 0.f, 0.f };
+        scale    = 0.3f;
+        size     = { slice->width * scale , slice->height * scale * aspect_ratio};
+        speed    = { 0.f, 0.f };
+        visible  = true;
+    }
+
     bool GameObject::intersects (const GameObject & other)
     {
         // Se determinan las coordenadas de la esquina inferior izquierda y de la superior derecha
@@ -13,6 +13,7 @@
 #define GAMEOBJECT_HEADER
 
     #include <memory>
+    #include <basics/Atlas>
     #include <basics/Canvas>
     #include <basics/Texture_2D>
     #include <basics/Vector>
@@ -20,6 +21,7 @@
     namespace project_template
     {
 
+        using basics::Atlas;
         using basics::Canvas;
         using basics::Size2f;
         using basics::Point2f;
@@ -31,6 +33,7 @@
         protected:
 
             Texture_2D * texture;                   ///< Textura en la que está la imagen del sprite.
+            const Atlas::Slice * slice;             ///< Si no es nullptr, la imagen es este slice de un atlas.
             int          anchor;                    ///< Indica qué punto de la textura se colocará en 'position' (x,y).
 
             Size2f       size;                      ///< Tamaño del game object (normalmente en coordenadas virtuales).
@@ -49,6 +52,13 @@
              */
             GameObject(Texture_2D * texture, float aspect_ratio);
 
+            /**
+             * Inicializa una nueva instancia de GameObject cuya imagen es parte de un atlas, lo que
+             * permite dibujar los sprites que comparten atlas sin cambiar de textura.
+             * @param slice Puntero al slice del atlas. No debe ser nullptr.
+             */
+            GameObject(const Atlas::Slice * slice, float aspect_ratio);
+
             /**
              * Destructor virtual para facilitar heredar de esta clase si fuese necesario.
              */
@@ -151,6 +161,7 @@
             void set_texture (Texture_2D * _texture)
             {
               texture = _texture;
+              slice   = nullptr;
             }
 
         public:
@@ -213,7 +224,10 @@
             {
                 if (visible)
                 {
-                    canvas.fill_rectangle (position, size, texture, anchor);
+                    if (slice)
+                        canvas.fill_rectangle (position, size, slice,   anchor);
+                    else
+                        canvas.fill_rectangle (position, size, texture, anchor);
                 }
             }
 
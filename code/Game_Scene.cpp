@@ -53,6 +53,35 @@ namespace project_template
 
     unsigned Game_Scene::textures_count = sizeof(textures_data) / sizeof(Texture_Data);
 
+    // ---------------------------------------------------------------------------------------------
+
+    Texture_2D::Options Game_Scene::get_texture_options ()
+    {
+        // En pantallas pequeñas los sprites se dibujan más pequeños que sus imágenes, por lo que se
+        // generan mipmaps, que con el alfa premultiplicado no oscurecen los bordes. Tras subir el
+        // atlas no se conservan sus píxeles. Si se pierde el contexto se vuelve a componer a partir
+        // de los assets:
+
+        Texture_2D::Options options = Texture_2D::Options();
+
+        options.mipmaps       = Texture_2D::GPU_MIPMAPS;
+        options.premultiplied = true;
+        options.residency     = Texture_2D::RELOAD_FROM_ASSET;
+
+        return options;
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    Asset_Prefetcher::Request_List Game_Scene::get_texture_requests ()
+    {
+        Asset_Prefetcher::Request_List requests;
+
+        Asset_Prefetcher::add_textures (requests, textures_data, textures_count, get_texture_options ());
+
+        return requests;
+    }
+
     // ---------------------------------------------------------------------------------------------
     // Definiciones de los atributos estáticos de la clase:
 
@@ -84,6 +113,10 @@ namespace project_template
         // Se inicia la semilla del generador de números aleatorios:
         srand (unsigned(time(nullptr)));
 
+        // Al terminar la partida se pasa a la pantalla final:
+
+        add_successor_assets (Final_Scene::get_texture_requests ());
+
         // Se inicializan otros atributos:
 
         initialize ();
@@ -96,6 +129,8 @@ namespace project_template
 
     bool Game_Scene::initialize ()
     {
+        loading_requested = false;
+
         state     = LOADING;
         suspended = true;
         gameplay  = UNINITIALIZED;
@@ -246,7 +281,7 @@ namespace project_template
     }
 
     // ---------------------------------------------------------------------------------------------
-    // En este método solo se carga una textura por fotograma para poder pausar la carga si el
+    // Las imágenes se decodifican en los hilos de texture_loader para poder seguir atendiendo a la aplicación si el
     // juego pasa a segundo plano inesperadamente. Otro aspecto interesante es que la carga no
     // comienza hasta que la escena se inicia para así tener la posibilidad de mostrar al usuario
     // que la carga está en curso en lugar de tener una pantalla en negro que no responde durante
@@ -254,10 +289,22 @@ namespace project_template
 
     void Game_Scene::load_textures ()
     {
-        if (textures.size () < textures_count)          // Si quedan texturas por cargar...
+        if (atlases.empty ())                           // Si aún no se ha creado el atlas...
         {
-            // Las texturas se cargan y se suben al contexto gráfico, por lo que es necesario disponer
-            // de uno:
+            // La primera vez se encargan todas las imágenes a texture_loader, que las lee y decodifica
+            // a la vez en sus hilos mientras la escena sigue actualizándose. Después se juntan en un
+            // atlas para que toda la escena se dibuje con una sola textura:
+
+            if (!loading_requested)
+            {
+                atlas_packer = Atlas_Packer(get_texture_options ());
+
+                atlas_packer.add_batch (texture_loader, textures_data, textures_count);
+
+                loading_requested = true;
+            }
+
+            // El atlas se sube al contexto gráfico, por lo que es necesario disponer de uno:
 
             Graphics_Context::Accessor context = director.lock_graphics_context ();
 
@@ -269,17 +316,15 @@ namespace project_template
                     adjust_aspect_ratio(context);
                 }
 
-                // Se carga la siguiente textura (textures.size() indica cuántas llevamos cargadas):
-
-                Texture_Data   & texture_data = textures_data[textures.size ()];
-                Texture_Handle & texture      = textures[texture_data.id] = Texture_2D::create (texture_data.id, context, texture_data.path);
+                // Cuando se han decodificado todas las imágenes se empaquetan en el atlas. Después
+                // se pueden crear los gameobjects que lo usarán e iniciar el juego:
 
-                // Se comprueba si la textura se ha podido cargar correctamente:
-
-                if (texture) context->add (texture); else state = ERROR;
+                if (atlas_packer.is_ready ())
+                {
+                    atlases = atlas_packer.pack (context);
 
-                // Cuando se han terminado de cargar todas las texturas se pueden crear los gameobjects que
-                // las usarán e iniciar el juego:
+                    if (atlases.empty ()) state = ERROR;
+                }
             }
         }
         else {
@@ -288,6 +333,10 @@ namespace project_template
             restart_game();
 
             state = RUNNING;
+
+            // Durante la partida se preparan en segundo plano las imágenes de la pantalla final:
+
+            prefetch_successors ();
         }
 
     }
@@ -300,7 +349,7 @@ namespace project_template
         //TODO: crear y configurar los gameobjects de la escena
         // 1) Se crean y configuran los gameobjects:
 
-        //GameObject_Handle  nombre_objeto(new GameObject (textures[ID(nombre_ID)].get() ));
+        //GameObject_Handle  nombre_objeto(new GameObject (Atlas_Packer::find_slice (atlases, ID(nombre_ID)), real_aspect_ratio));
         //...
 
         // 2) Se establecen los anchor y position de los GameObject
@@ -313,11 +362,11 @@ namespace project_template
 
 
         // Se crean los objetos no dinámicos de la escena
-        GameObject_Handle first_udder  (new GameObject (textures[ID(left_udder)].  get(), real_aspect_ratio));
-        GameObject_Handle second_udder (new GameObject (textures[ID(right_udder)]. get(), real_aspect_ratio));
-        GameObject_Handle bucket       (new GameObject (textures[ID(bucket)].      get(), real_aspect_ratio));
-        GameObject_Handle pausa_button (new GameObject (textures[ID(pausa)].       get(), real_aspect_ratio));
-        GameObject_Handle pausa_signal (new GameObject (textures[ID(pausa_text)].  get(), real_aspect_ratio));
+        GameObject_Handle first_udder  (new GameObject (Atlas_Packer::find_slice (atlases, ID(left_udder)),   real_aspect_ratio));
+        GameObject_Handle second_udder (new GameObject (Atlas_Packer::find_slice (atlases, ID(right_udder)),  real_aspect_ratio));
+        GameObject_Handle bucket       (new GameObject (Atlas_Packer::find_slice (atlases, ID(bucket)),       real_aspect_ratio));
+        GameObject_Handle pausa_button (new GameObject (Atlas_Packer::find_slice (atlases, ID(pausa)),        real_aspect_ratio));
+        GameObject_Handle pausa_signal (new GameObject (Atlas_Packer::find_slice (atlases, ID(pausa_text)),   real_aspect_ratio));
 
         first_udder  -> set_position({(canvas_width * 0.5f) - (first_udder  -> get_width() * 0.5f) , (canvas_height - first_udder  -> get_height() * 0.5f)});
         second_udder -> set_position({(canvas_width * 0.5f) + (second_udder -> get_width() * 0.5f) , (canvas_height - second_udder -> get_height() * 0.5f)});
@@ -334,7 +383,7 @@ namespace project_template
        // Se crean los proyectiles de leche
         for(unsigned iterator = 0; iterator < bullet_amount; iterator++)
         {
-            GameObject_Handle milk_bullet (new GameObject (textures[ID(bullet)]. get(), real_aspect_ratio));
+            GameObject_Handle milk_bullet (new GameObject (Atlas_Packer::find_slice (atlases, ID(bullet)), real_aspect_ratio));
 
             milk_bullet -> hide ();
 
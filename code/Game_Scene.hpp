@@ -22,14 +22,16 @@
 #ifndef GAME_SCENE_HEADER
 #define GAME_SCENE_HEADER
 
-    #include <map>
     #include <list>
     #include <memory>
 
+    #include <basics/Asset_Prefetcher>
+    #include <basics/Atlas_Packer>
     #include <basics/Canvas>
     #include <basics/Id>
     #include <basics/Scene>
     #include <basics/Texture_2D>
+    #include <basics/Texture_Loader>
     #include <basics/Timer>
 
     #include "GameObject.hpp"
@@ -41,6 +43,8 @@
         using basics::Timer;
         using basics::Canvas;
         using basics::Texture_2D;
+        using basics::Atlas_Packer;
+        using basics::Texture_Loader;
 
         class Game_Scene : public basics::Scene
         {
@@ -49,8 +53,6 @@
 
             typedef std::shared_ptr < GameObject >         GameObject_Handle;
             typedef std::vector< GameObject_Handle >       GameObject_List;
-            typedef std::shared_ptr< Texture_2D  >         Texture_Handle;
-            typedef std::map< Id, Texture_Handle >         Texture_Map;
             typedef basics::Graphics_Context::Accessor     Context;
 
             /**
@@ -86,6 +88,11 @@
              */
             static unsigned textures_count;
 
+            /**
+             * Opciones con las que se cargan las texturas de la escena.
+             */
+            static basics::Texture_2D::Options get_texture_options ();
+
             /**
              * Cantidad de litros obtenidos por el jugador
              */
@@ -111,7 +118,10 @@
             bool           aspect_ratio_adjusted;               ///< False hasta que se ajuste el aspect ratio de la resolución.
             float          real_aspect_ratio;
 
-            Texture_Map        textures;                        ///< Mapa  en el que se guardan shared_ptr a las texturas cargadas.
+            Texture_Loader     texture_loader;                  ///< Lee y decodifica las imágenes en segundo plano.
+            Atlas_Packer       atlas_packer;                    ///< Junta las imágenes de la escena en un atlas.
+            Atlas_Packer::Atlas_List atlases;                   ///< Páginas del atlas en las que están las imágenes de todos los gameobjects.
+            bool               loading_requested;               ///< True cuando ya se han encargado las imágenes al texture_loader.
             GameObject_List    gameobjects;                     ///< Lista en la que se guardan shared_ptr a los gameobject creados.
             GameObject_List    bullets;                         ///< Lista en la que se guardan shared_ptr a los proyectiles creados.
 
@@ -136,6 +146,12 @@
              */
             Game_Scene();
 
+            /**
+             * Texturas que carga la escena y opciones con las que las carga. Las escenas desde las que
+             * se llega a esta las usan para que Asset_Prefetcher las prepare de antemano.
+             */
+            static basics::Asset_Prefetcher::Request_List get_texture_requests ();
+
             /**
              * Este método lo llama Director para conocer la resolución virtual con la que está
              * trabajando la escena.
@@ -183,8 +199,8 @@
         private:
 
             /**
-             * En este método se cargan las texturas (una cada fotograma para facilitar que la
-             * propia carga se pueda pausar cuando la aplicación pasa a segundo plano).
+             * En este método se cargan las texturas. Las imágenes se decodifican en segundo plano y,
+             * cuando están todas, se empaquetan en un atlas que se sube a la GPU.
              */
             void load_textures ();
 
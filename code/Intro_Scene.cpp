@@ -124,6 +124,11 @@ namespace project_template
             {
                 context->add (logo_texture);
 
+                // Mientras se muestra el logo se preparan las imágenes del menú:
+
+                add_successor_assets (Menu_Scene::get_texture_requests ());
+                prefetch_successors  ();
+
                 timer.reset ();
 
                 opacity = 0.f;
@@ -54,6 +54,31 @@ namespace project_template
 
     unsigned Menu_Scene::textures_count = sizeof(textures_data) / sizeof(Texture_Data);
 
+    // ---------------------------------------------------------------------------------------------
+
+    Texture_2D::Options Menu_Scene::get_texture_options ()
+    {
+        // Tras subirlas a la GPU no se conservan sus píxeles. Si se pierde el contexto se vuelven a
+        // leer de los assets:
+
+        Texture_2D::Options options = Texture_2D::Options();
+
+        options.residency = Texture_2D::RELOAD_FROM_ASSET;
+
+        return options;
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    Asset_Prefetcher::Request_List Menu_Scene::get_texture_requests ()
+    {
+        Asset_Prefetcher::Request_List requests;
+
+        Asset_Prefetcher::add_textures (requests, textures_data, textures_count, get_texture_options ());
+
+        return requests;
+    }
+
     Menu_Scene::Menu_Scene()
     {
         state         = LOADING;
@@ -62,12 +87,18 @@ namespace project_template
         canvas_height = 1280;
 
         aspect_ratio_adjusted = false;
+
+        set_render_on_demand (true);            // El menú es estático: solo se redibuja cuando cambia
+
+        add_successor_assets (Game_Scene::get_texture_requests ());     // Desde el menú se pasa al juego
     }
 
     // ---------------------------------------------------------------------------------------------
 
     bool Menu_Scene::initialize ()
     {
+        loading_requested = false;
+
         state     = LOADING;
         suspended = true;
         showing_instructions = false;
@@ -126,7 +157,7 @@ namespace project_template
 
         if (!suspended) switch (state)
             {
-                case LOADING: load_textures  ();     break;
+                case LOADING: load_textures  (); invalidate (); break;
                 case READY: run_simulation (time); break;
                 case ERROR:   break;
             }
@@ -168,8 +199,8 @@ namespace project_template
 
     // ---------------------------------------------------------------------------------------------
 
-    // En este método solo se carga una textura por fotograma para poder pausar la carga si el
-    // juego pasa a segundo plano inesperadamente. Otro aspecto interesante es que la carga no
+    // Las texturas se leen y decodifican en los hilos de texture_loader, por lo que la escena sigue
+    // atendiendo a la aplicación si el juego pasa a segundo plano inesperadamente. Otro aspecto interesante es que la carga no
     // comienza hasta que la escena se inicia para así tener la posibilidad de mostrar al usuario
     // que la carga está en curso en lugar de tener una pantalla en negro que no responde durante
     // un tiempo.
@@ -178,6 +209,25 @@ namespace project_template
     {
         if (textures.size () < textures_count)          // Si quedan texturas por cargar...
         {
+            // La primera vez se encargan todas las texturas a texture_loader, que las lee y decodifica
+            // en segundo plano mientras la escena sigue actualizándose:
+
+            if (!loading_requested)
+            {
+                texture_loader.load_batch
+                (
+                    textures_data,
+                    textures_count,
+                    [this] (Id id, const Texture_Handle & texture)
+                    {
+                        if (texture) textures[id] = texture; else state = ERROR;
+                    },
+                    get_texture_options ()
+                );
+
+                loading_requested = true;
+            }
+
             // Las texturas se cargan y se suben al contexto gráfico, por lo que es necesario disponer
             // de uno:
 
@@ -191,14 +241,10 @@ namespace project_template
                     adjust_aspect_ratio(context);
                 }
 
-                // Se carga la siguiente textura (textures.size() indica cuántas llevamos cargadas):
-
-                Texture_Data   & texture_data = textures_data[textures.size ()];
-                Texture_Handle & texture      = textures[texture_data.id] = Texture_2D::create (texture_data.id, context, texture_data.path);
+                // Solo la subida a la GPU tiene que hacerse en este hilo. En cada fotograma se suben
+                // las texturas ya decodificadas que quepan en el presupuesto del cargador:
 
-                // Se comprueba si la textura se ha podido cargar correctamente:
-
-                if (texture) context->add (texture); else state = ERROR;
+                texture_loader.upload (context);
 
                 // Cuando se han terminado de cargar todas las texturas se pueden crear los gameobjects que
                 // las usarán e iniciar el juego:
@@ -211,6 +257,10 @@ namespace project_template
             state = READY;                              // el mensaje de carga no aparezca y desaparezca
             // demasiado rápido.
 
+            // Mientras el menú espera a que el jugador pulse se preparan las imágenes del juego:
+
+            prefetch_successors ();
+
             //}
         }
     }
@@ -27,10 +27,12 @@
 #include <list>
 #include <memory>
 
+#include <basics/Asset_Prefetcher>
 #include <basics/Canvas>
 #include <basics/Id>
 #include <basics/Scene>
 #include <basics/Texture_2D>
+#include <basics/Texture_Loader>
 #include <basics/Timer>
 
 #include "GameObject.hpp"
@@ -42,6 +44,7 @@
         using basics::Timer;
         using basics::Canvas;
         using basics::Texture_2D;
+        using basics::Texture_Loader;
 
         class Menu_Scene : public basics::Scene
         {
@@ -74,6 +77,11 @@
              */
             static unsigned textures_count;
 
+            /**
+             * Opciones con las que se cargan las texturas de la escena.
+             */
+            static basics::Texture_2D::Options get_texture_options ();
+
 
         private:
 
@@ -87,6 +95,8 @@
             float          real_aspect_ratio;
 
             Texture_Map        textures;                        ///< Mapa  en el que se guardan shared_ptr a las texturas cargadas.
+            Texture_Loader     texture_loader;                  ///< Lee y decodifica las texturas en segundo plano.
+            bool               loading_requested;               ///< True cuando ya se han encargado las texturas al texture_loader.
             GameObject_List    buttons;                         ///< Lista en la que se guardan shared_ptr a los gameobject creados.
 
             Timer          timer;                               ///< Cronómetro usado para medir intervalos de tiempo
@@ -101,6 +111,12 @@
 
             Menu_Scene();
 
+            /**
+             * Texturas que carga la escena y opciones con las que las carga. Las escenas desde las que
+             * se llega a esta las usan para que Asset_Prefetcher las prepare de antemano.
+             */
+            static basics::Asset_Prefetcher::Request_List get_texture_requests ();
+
             /**
              * Este método lo llama Director para conocer la resolución virtual con la que está
              * trabajando la escena.
@@ -154,8 +170,8 @@
         private:
 
             /**
-             * En este método se cargan las texturas (una cada fotograma para facilitar que la
-             * propia carga se pueda pausar cuando la aplicación pasa a segundo plano).
+             * En este método se cargan las texturas. Se leen y decodifican en segundo plano con
+             * texture_loader y en cada fotograma se suben a la GPU las que ya están listas.
              */
             void load_textures ();
 
@@ -19,6 +19,7 @@
   *
   */
 
+#include <basics/Asset_Archive>
 #include <basics/Director>
 #include <basics/enable>
 #include <basics/Graphics_Resource_Cache>
@@ -38,6 +39,14 @@ int main ()
 
     enable< basics::OpenGL_ES2 > ();
 
+    // Si los assets se han empaquetado con tools/asset_packer se leen del archivo. Si no, se
+    // siguen abriendo sueltos:
+
+    if (Asset::exists ("assets.pak"))
+    {
+        Asset_Archive::mount ("assets.pak");
+    }
+
     // Se crea una Game_Scene y se inicia mediante el Director:
 
     director.run_scene (shared_ptr< Scene >(new Intro_Scene));
@@ -16,6 +16,7 @@
 
     #include <android/asset_manager.h>
     #include <basics/Asset>
+    #include <basics/Asset_Archive>
     #include "Android_Asset.hpp"
     #include "Native_Activity.hpp"
 
@@ -24,7 +25,13 @@
 
         std::shared_ptr< Asset > Asset::open (const std::string & path)
         {
-            std::shared_ptr< Asset > asset(new internal::Android_Asset(path));
+            // Los assets empaquetados en un archivo montado se abren sin pasar por AAssetManager:
+
+            std::shared_ptr< Asset > asset = Asset_Archive::open (path);
+
+            if (asset) return asset;
+
+            asset.reset (new internal::Android_Asset(path));
 
             if (!asset->good ())
             {
@@ -36,12 +43,16 @@
 
         bool Asset::exists (const std::string & path)
         {
-            return internal::Android_Asset(path).good ();
+            return Asset_Archive::exists (path) || internal::Android_Asset(path).good ();
         }
 
         size_t Asset::size (const std::string & path)
         {
-            return internal::Android_Asset(path).size ();
+            return Asset_Archive::exists (path) ? Asset_Archive::size (path) : internal::Android_Asset(path).size ();
+        }
+
+        void Asset::set_root (const std::string & )
+        {
         }
 
     }
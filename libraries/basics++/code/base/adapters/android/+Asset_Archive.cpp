@@ -0,0 +1,54 @@
+/*
+ * ASSET ARCHIVE
+ * Copyright © 2018+ Ángel Rodríguez Ballesteros
+ *
+ * Distributed under the Boost Software License, version  1.0
+ * See documents/LICENSE.TXT or www.boost.org/LICENSE_1_0.txt
+ *
+ * angel.rodriguez@esne.edu
+ *
+ * C2610172313
+ */
+
+#include <basics/macros>
+
+#if defined(BASICS_ANDROID_OS)
+
+    #include <android/asset_manager.h>
+    #include <basics/Asset_Archive>
+    #include "Native_Activity.hpp"
+
+    namespace basics
+    {
+
+        bool Asset_Archive::map (const std::string & archive_path, Mapping & mapping)
+        {
+            // Con AASSET_MODE_BUFFER, si el archivo se guardó sin comprimir en el APK (ver noCompress
+            // en build.gradle), AAsset_getBuffer() devuelve una proyección del propio APK en lugar
+            // de descomprimirlo en memoria:
+
+            AAsset * asset = AAssetManager_open
+            (
+                internal::native_activity->get_activity ().assetManager,
+                archive_path.c_str (),
+                AASSET_MODE_BUFFER
+            );
+
+            if (asset == nullptr) return false;
+
+            std::shared_ptr< void > owner(asset, AAsset_close);
+
+            const void * buffer = AAsset_getBuffer (asset);
+
+            if (buffer == nullptr) return false;
+
+            mapping.data  = static_cast< const byte * >(buffer);
+            mapping.size  = size_t(AAsset_getLength (asset));
+            mapping.owner = owner;
+
+            return true;
+        }
+
+    }
+
+#endif
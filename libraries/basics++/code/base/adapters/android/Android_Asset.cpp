@@ -94,10 +94,7 @@
         {
             byte data = 0;
 
-            if (good ())
-            {
-                read (&data, 1);
-            }
+            read (&data, 1);
 
             return data;
         }
@@ -110,7 +107,7 @@
 
                 buffer.resize (s);
 
-                return read (buffer.data (), s);
+                return read (buffer.data (), s) == s;
             }
 
             return false;
@@ -124,36 +121,47 @@
 
                 buffer.resize (s);
 
-                return read ((uint8_t *)buffer.data (), s);
+                return read ((byte *)buffer.data (), s) == s;
             }
 
             return false;
         }
 
-        bool Android_Asset::read (uint8_t * buffer, size_t size)
+        size_t Android_Asset::read (byte * buffer, size_t size)
         {
-            if (size > 0)
+            size_t count = 0;
+
+            // AAsset_read() puede devolver menos bytes de los pedidos sin haber llegado al final:
+
+            while (good () && count < size)
             {
-                int result = AAsset_read (handle, buffer, size);
+                int result = AAsset_read (handle, buffer + count, size - count);
 
-                if (size_t(result) == size)
+                if (result > 0)
                 {
-                    cursor += size;
-
-                    return true;
+                    count += size_t(result);
                 }
                 else
-                if (result == 0)
                 {
-                    at_end = true;
-                }
-                else
-                    failed = true;
+                    if (result == 0) at_end = true; else failed = true;
 
-                return false;
+                    break;
+                }
             }
 
-            return true;
+            cursor += count;
+
+            return count;
+        }
+
+        Asset::Span Android_Asset::map ()
+        {
+            // Si el asset se guardó sin comprimir en el APK el buffer es una proyección del propio
+            // APK. Si no, AAssetManager lo descomprime una vez en un buffer suyo:
+
+            const void * buffer = good () ? AAsset_getBuffer (handle) : nullptr;
+
+            return { static_cast< const byte * >(buffer), buffer ? size () : 0 };
         }
 
     }}
@@ -45,10 +45,8 @@
             byte   read () override;
             bool   read_all (std::vector< byte > & buffer) override;
             bool   read_all (std::string & buffer) override;
-
-        private:
-
-            bool read (uint8_t * buffer, size_t size);
+            size_t read (byte * buffer, size_t size) override;
+            Span   map  () override;
 
         };
 
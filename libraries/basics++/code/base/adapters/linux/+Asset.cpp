@@ -0,0 +1,65 @@
+/*
+ * ASSET
+ * Copyright © 2018+ Ángel Rodríguez Ballesteros
+ *
+ * Distributed under the Boost Software License, version  1.0
+ * See documents/LICENSE.TXT or www.boost.org/LICENSE_1_0.txt
+ *
+ * angel.rodriguez@esne.edu
+ *
+ * C2610172318
+ */
+
+#include <basics/macros>
+
+#if defined(BASICS_LINUX_OS)
+
+    #include <sys/stat.h>
+    #include <basics/Asset>
+    #include <basics/Asset_Archive>
+    #include "Linux_Asset.hpp"
+
+    namespace basics
+    {
+
+        std::shared_ptr< Asset > Asset::open (const std::string & path)
+        {
+            std::shared_ptr< Asset > asset = Asset_Archive::open (path);
+
+            if (asset) return asset;
+
+            asset.reset (new internal::Linux_Asset(path));
+
+            if (!asset->good ())
+            {
+                 asset.reset ();
+            }
+
+            return asset;
+        }
+
+        bool Asset::exists (const std::string & path)
+        {
+            struct stat status;
+
+            return Asset_Archive::exists (path)
+                || (stat (internal::Linux_Asset::resolve (path).c_str (), &status) == 0 && S_ISREG(status.st_mode));
+        }
+
+        size_t Asset::size (const std::string & path)
+        {
+            if (Asset_Archive::exists (path)) return Asset_Archive::size (path);
+
+            struct stat status;
+
+            return stat (internal::Linux_Asset::resolve (path).c_str (), &status) == 0 ? size_t(status.st_size) : 0;
+        }
+
+        void Asset::set_root (const std::string & directory)
+        {
+            internal::Linux_Asset::get_root () = directory;
+        }
+
+    }
+
+#endif
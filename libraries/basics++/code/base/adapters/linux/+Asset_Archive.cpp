@@ -0,0 +1,60 @@
+/*
+ * ASSET ARCHIVE
+ * Copyright © 2018+ Ángel Rodríguez Ballesteros
+ *
+ * Distributed under the Boost Software License, version  1.0
+ * See documents/LICENSE.TXT or www.boost.org/LICENSE_1_0.txt
+ *
+ * angel.rodriguez@esne.edu
+ *
+ * C2610172314
+ */
+
+#include <basics/macros>
+
+#if defined(BASICS_LINUX_OS)
+
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <basics/Asset_Archive>
+    #include "Linux_Asset.hpp"
+
+    namespace basics
+    {
+
+        bool Asset_Archive::map (const std::string & archive_path, Mapping & mapping)
+        {
+            int file = ::open (internal::Linux_Asset::resolve (archive_path).c_str (), O_RDONLY | O_CLOEXEC);
+
+            if (file < 0) return false;
+
+            struct stat status;
+
+            if (fstat (file, &status) != 0 || status.st_size <= 0)
+            {
+                close (file);
+
+                return false;
+            }
+
+            size_t size = size_t(status.st_size);
+            void * data = mmap (nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+
+            // La proyección sigue siendo válida después de cerrar el descriptor:
+
+            close (file);
+
+            if (data == MAP_FAILED) return false;
+
+            mapping.data  = static_cast< const byte * >(data);
+            mapping.size  = size;
+            mapping.owner = std::shared_ptr< void >(data, [size] (void * data) { munmap (data, size); });
+
+            return true;
+        }
+
+    }
+
+#endif
@@ -0,0 +1,216 @@
+/*
+ * LINUX ASSET
+ * Copyright © 2018+ Ángel Rodríguez Ballesteros
+ *
+ * Distributed under the Boost Software License, version  1.0
+ * See documents/LICENSE.TXT or www.boost.org/LICENSE_1_0.txt
+ *
+ * angel.rodriguez@esne.edu
+ *
+ * C2610172317
+ */
+
+#include <basics/macros>
+
+#if defined(BASICS_LINUX_OS)
+
+    #include <cerrno>
+    #include <cstdlib>
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include "Linux_Asset.hpp"
+
+    namespace basics { namespace internal
+    {
+
+        std::string & Linux_Asset::get_root ()
+        {
+            static std::string root = std::getenv ("BASICS_ASSETS_PATH") ? std::getenv ("BASICS_ASSETS_PATH") : "assets";
+
+            return root;
+        }
+
+        std::string Linux_Asset::resolve (const std::string & path)
+        {
+            std::string & root = get_root ();
+
+            if (root.empty () || (!path.empty () && path[0] == '/'))
+            {
+                return path;
+            }
+
+            return root.back () == '/' ? root + path : root + '/' + path;
+        }
+
+        Linux_Asset::Linux_Asset(const std::string & path)
+        :
+            length (0      ),
+            cursor (0      ),
+            at_end (false  ),
+            mapping(nullptr)
+        {
+            file = ::open (resolve (path).c_str (), O_RDONLY | O_CLOEXEC);
+
+            struct stat status;
+
+            if (file >= 0 && fstat (file, &status) == 0 && S_ISREG(status.st_mode))
+            {
+                length = size_t(status.st_size);
+            }
+            else
+            if (file >= 0)
+            {
+                close (file), file = -1;
+            }
+
+            failed = file < 0;
+        }
+
+        Linux_Asset::~Linux_Asset()
+        {
+            if (mapping != nullptr)
+            {
+                munmap (mapping, length), mapping = nullptr;
+            }
+
+            if (file >= 0)
+            {
+                close (file), file = -1;
+            }
+        }
+
+        bool Linux_Asset::good () const
+        {
+            return not failed;
+        }
+
+        bool Linux_Asset::fail () const
+        {
+            return failed;
+        }
+
+        bool Linux_Asset::eof () const
+        {
+            return at_end;
+        }
+
+        size_t Linux_Asset::size () const
+        {
+            return length;
+        }
+
+        bool Linux_Asset::seek (ptrdiff_t offset, Anchor anchor)
+        {
+            if (good ())
+            {
+                ptrdiff_t base       = anchor == BEGINNING ? 0 : anchor == END ? ptrdiff_t(length) : ptrdiff_t(cursor);
+                ptrdiff_t new_cursor = base + offset;
+
+                if (new_cursor >= 0 && size_t(new_cursor) <= length)
+                {
+                    cursor = size_t(new_cursor);
+                    at_end = false;
+
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        size_t Linux_Asset::tell () const
+        {
+            return cursor;
+        }
+
+        byte Linux_Asset::read ()
+        {
+            byte data = 0;
+
+            read (&data, 1);
+
+            return data;
+        }
+
+        bool Linux_Asset::read_all (std::vector< byte > & buffer)
+        {
+            if (good ())
+            {
+                buffer.resize (length);
+
+                cursor = 0;
+
+                return read (buffer.data (), length) == length;
+            }
+
+            return false;
+        }
+
+        bool Linux_Asset::read_all (std::string & buffer)
+        {
+            if (good ())
+            {
+                buffer.resize (length);
+
+                cursor = 0;
+
+                return read ((byte *)&buffer[0], length) == length;
+            }
+
+            return false;
+        }
+
+        size_t Linux_Asset::read (byte * buffer, size_t size)
+        {
+            size_t count = 0;
+
+            // pread() puede devolver menos bytes de los pedidos sin haber llegado al final o ser
+            // interrumpida por una señal antes de leer nada:
+
+            while (good () && count < size)
+            {
+                ssize_t result = pread (file, buffer + count, size - count, off_t(cursor + count));
+
+                if (result > 0)
+                {
+                    count += size_t(result);
+                }
+                else
+                if (result < 0 && errno == EINTR)
+                {
+                    continue;
+                }
+                else
+                {
+                    if (result == 0) at_end = true; else failed = true;
+
+                    break;
+                }
+            }
+
+            cursor += count;
+
+            return count;
+        }
+
+        Asset::Span Linux_Asset::map ()
+        {
+            static const byte empty = 0;
+
+            if (good () && mapping == nullptr && length > 0)
+            {
+                void * data = mmap (nullptr, length, PROT_READ, MAP_PRIVATE, file, 0);
+
+                if (data != MAP_FAILED) mapping = data;
+            }
+
+            if (good () && length == 0) return { &empty, 0 };
+
+            return { static_cast< const byte * >(mapping), mapping ? length : 0 };
+        }
+
+    }}
+
+#endif
@@ -0,0 +1,70 @@
+/*
+ * LINUX ASSET
+ * Copyright © 2018+ Ángel Rodríguez Ballesteros
+ *
+ * Distributed under the Boost Software License, version  1.0
+ * See documents/LICENSE.TXT or www.boost.org/LICENSE_1_0.txt
+ *
+ * angel.rodriguez@esne.edu
+ *
+ * C2610172316
+ */
+
+#ifndef BASICS_LINUX_ASSET_HEADER
+#define BASICS_LINUX_ASSET_HEADER
+
+    #include <string>
+    #include <basics/Asset>
+
+    namespace basics { namespace internal
+    {
+
+        /**
+         * Asset que es un archivo suelto dentro de la carpeta raíz de los assets. Se lee con pread(),
+         * por lo que la posición del asset es solo suya y varios assets se pueden leer a la vez
+         * desde distintos hilos.
+         */
+        class Linux_Asset final : public Asset
+        {
+
+            int      file;
+            size_t   length;
+            size_t   cursor;
+            bool     failed;
+            bool     at_end;
+            void   * mapping;                   ///< Proyección que crea map() la primera vez que se llama.
+
+        public:
+
+            static std::string & get_root ();
+
+            /**
+             * @return La ruta en el sistema de archivos del asset con la ruta indicada.
+             */
+            static std::string resolve (const std::string & path);
+
+        public:
+
+            Linux_Asset(const std::string & path);
+           ~Linux_Asset();
+
+        public:
+
+            bool   good () const override;
+            bool   fail () const override;
+            bool   eof  () const override;
+
+            size_t size () const override;
+            bool   seek (ptrdiff_t offset, Anchor = CURRENT) override;
+            size_t tell () const override;
+            byte   read () override;
+            bool   read_all (std::vector< byte > & buffer) override;
+            bool   read_all (std::string & buffer) override;
+            size_t read (byte * buffer, size_t size) override;
+            Span   map  () override;
+
+        };
+
+    }}
+
+#endif
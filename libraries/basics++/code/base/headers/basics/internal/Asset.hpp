@@ -32,12 +32,32 @@
                 END
             };
 
+            /**
+             * Vista de solo lectura de un bloque de bytes que pertenece a otro (no los libera).
+             */
+            struct Span
+            {
+                const byte * data;
+                size_t       size;
+
+                const byte * begin () const { return data;        }
+                const byte * end   () const { return data + size; }
+            };
+
         public:
 
             static std::shared_ptr< Asset > open (const std::string & path);
             static bool exists (const std::string & path);
             static size_t size (const std::string & path);
 
+            /**
+             * Establece la carpeta de la que se leen los assets en las plataformas en las que son
+             * archivos sueltos (Linux). Por defecto es la que indica la variable de entorno
+             * BASICS_ASSETS_PATH o, si no existe, "assets" en la carpeta actual. En Android los
+             * assets están dentro del APK y se ignora.
+             */
+            static void set_root (const std::string & directory);
+
         protected:
 
             Asset() = default;
@@ -58,6 +78,22 @@
             virtual bool   read_all (std::vector< byte > & buffer) = 0;
             virtual bool   read_all (std::string & buffer) = 0;
 
+            /**
+             * Lee a partir de la posición actual hasta size bytes. Sirve para procesar por trozos los
+             * archivos grandes sin tenerlos enteros en memoria.
+             * @return Número de bytes leídos. Si es menor que size se ha llegado al final o ha habido
+             *     un error (ver eof() y fail()).
+             */
+            virtual size_t read (byte * buffer, size_t size) = 0;
+
+            /**
+             * Da acceso al contenido completo del asset sin copiarlo. Los bytes están en el buffer de
+             * la plataforma (la proyección del Asset_Archive o el buffer de AAsset en Android) y son
+             * válidos mientras el asset exista.
+             * @return Una vista con data a nullptr si no se ha podido obtener.
+             */
+            virtual Span map () = 0;
+
         };
 
     }
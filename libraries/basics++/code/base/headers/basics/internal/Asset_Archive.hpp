@@ -0,0 +1,159 @@
+/*
+ * ASSET ARCHIVE
+ * Copyright © 2018+ Ángel Rodríguez Ballesteros
+ *
+ * Distributed under the Boost Software License, version  1.0
+ * See documents/LICENSE.TXT or www.boost.org/LICENSE_1_0.txt
+ *
+ * angel.rodriguez@esne.edu
+ *
+ * C2610172311
+ */
+
+#ifndef BASICS_ASSET_ARCHIVE_HEADER
+#define BASICS_ASSET_ARCHIVE_HEADER
+
+    #include <memory>
+    #include <string>
+    #include <vector>
+    #include <basics/Asset>
+    #include <basics/Non_Copyable>
+    #include <basics/types>
+
+    namespace basics
+    {
+
+        /**
+         * Archivo que empaqueta muchos assets en uno solo. Se abre una vez y se proyecta entero en
+         * memoria (con AAsset_getBuffer() en Android y con mmap() en Linux), de modo que abrir un
+         * asset empaquetado solo cuesta una búsqueda en el índice y su contenido se lee sin copiarlo.
+         *
+         * Formato (little endian), generado con la herramienta tools/asset_packer:
+         *
+         *     Header                       16 bytes
+         *     Entry[entry_count]           24 bytes cada una, ordenadas por hash y después por ruta
+         *     rutas                        cadenas terminadas en 0 a partir de names_offset
+         *     datos                        cada asset empieza en un offset múltiplo de alignment
+         *
+         * El hash de cada entrada es el fnv32() de su ruta relativa a la carpeta de assets, que usa
+         * '/' como separador (por ejemplo "game-scene/milk.png"). Las rutas se guardan para resolver
+         * las colisiones del hash.
+         *
+         * Las entradas comprimidas se dividen en bloques de block_size bytes (el último puede ser
+         * menor) que se comprimen por separado, de modo que se pueden leer por trozos y descomprimir
+         * directamente en el buffer de destino. Sus datos empiezan con una tabla de un uint32_t por
+         * bloque con el offset en el que acaba cada bloque comprimido, contado desde el final de la
+         * tabla. Un bloque que ocupa lo mismo que sin comprimir está guardado tal cual.
+         *
+         * Los archivos se montan antes de empezar a cargar assets desde otros hilos: mount() y
+         * unmount_all() no se protegen de llamadas simultáneas con open(), exists() o size().
+         */
+        class Asset_Archive : Non_Copyable
+        {
+        public:
+
+            static constexpr uint32_t magic      = 0x4B415042;      ///< "BPAK" leído como little endian.
+            static constexpr uint32_t version    = 2;
+            static constexpr size_t   alignment  = 16;              ///< Alineación de los datos de cada entrada.
+            static constexpr size_t   block_size = 64 * 1024;       ///< Tamaño sin comprimir de los bloques.
+
+            /**
+             * Compresión de una entrada. LZ4 descomprime muy rápido y se usa con los archivos binarios.
+             * DEFLATE comprime más y se usa con el texto (los XML de atlas y de fuentes). Las imágenes
+             * PNG, KTX y PKM ya están comprimidas y se guardan sin comprimir (STORED).
+             */
+            enum Codec
+            {
+                STORED  = 0,
+                LZ4     = 1,
+                DEFLATE = 2,
+            };
+
+            struct Header
+            {
+                uint32_t magic;
+                uint32_t version;
+                uint32_t entry_count;
+                uint32_t names_offset;                              ///< Offset de la primera ruta.
+            };
+
+            struct Entry
+            {
+                uint32_t hash;                                      ///< fnv32() de la ruta.
+                uint32_t name_offset;                               ///< Offset de la ruta terminada en 0.
+                uint32_t offset;                                    ///< Offset de los datos (múltiplo de alignment).
+                uint32_t size;                                      ///< Tamaño de los datos sin comprimir.
+                uint32_t stored_size;                               ///< Bytes que ocupan los datos en el archivo.
+                uint32_t codec;                                     ///< Uno de los valores de Codec.
+            };
+
+        private:
+
+            /**
+             * Región de memoria en la que se ha proyectado un archivo. La crea el adaptador de cada
+             * plataforma y owner se encarga de liberarla cuando nadie la usa.
+             */
+            struct Mapping
+            {
+                const byte             * data;
+                size_t                   size;
+                std::shared_ptr< void >  owner;
+            };
+
+            typedef std::shared_ptr< Asset_Archive > Archive_Handle;
+            typedef std::vector< Archive_Handle >    Archive_List;
+
+        public:
+
+            /**
+             * Abre y proyecta en memoria un archivo que está en la carpeta de assets. Los assets que
+             * contiene se buscan a partir de entonces en él antes que sueltos. Si una ruta está en
+             * varios archivos montados, se usa la del último que se montó.
+             * @return false si no se pudo abrir el archivo o si no tiene un formato válido.
+             */
+            static bool mount (const std::string & archive_path);
+
+            /**
+             * Desmonta todos los archivos. Los assets que se abrieron desde ellos siguen siendo
+             * válidos hasta que se destruyen.
+             */
+            static void unmount_all ();
+
+            /**
+             * Abre un asset desde los archivos montados.
+             * @return nullptr si la ruta no está en ninguno de ellos.
+             */
+            static std::shared_ptr< Asset > open (const std::string & path);
+
+            static bool   exists (const std::string & path);
+            static size_t size   (const std::string & path);
+
+        private:
+
+            static Archive_List & get_mounted ();
+
+            /**
+             * Lo implementa el adaptador de cada plataforma.
+             */
+            static bool map (const std::string & archive_path, Mapping & mapping);
+
+            static const Entry * find_entry (const std::string & path, Archive_Handle * archive = nullptr);
+
+        private:
+
+            Mapping        mapping;
+            const Header * header;
+            const Entry  * entries;
+
+        private:
+
+            Asset_Archive(const Mapping & mapping);
+
+            bool          is_valid () const;
+            const Entry * find     (const std::string & path, uint32_t hash) const;
+
+        };
+
+    }
+
+#endif
@@ -0,0 +1,168 @@
+/*
+ * ASSET PREFETCHER
+ * Copyright © 2018+ Ángel Rodríguez Ballesteros
+ *
+ * Distributed under the Boost Software License, version  1.0
+ * See documents/LICENSE.TXT or www.boost.org/LICENSE_1_0.txt
+ *
+ * angel.rodriguez@esne.edu
+ *
+ * C2610172325
+ */
+
+#ifndef BASICS_ASSET_PREFETCHER_HEADER
+#define BASICS_ASSET_PREFETCHER_HEADER
+
+    #include <condition_variable>
+    #include <deque>
+    #include <map>
+    #include <memory>
+    #include <mutex>
+    #include <string>
+    #include <thread>
+    #include <vector>
+    #include <basics/Color_Buffer>
+    #include <basics/Compressed_Image>
+    #include <basics/Non_Copyable>
+    #include <basics/Texture_2D>
+
+    namespace basics
+    {
+
+        /**
+         * Prepara en segundo plano los assets que probablemente se van a necesitar pronto (por
+         * ejemplo, los de la escena siguiente mientras la actual está ociosa). Un hilo lee y
+         * decodifica las texturas pedidas y se queda con sus píxeles. Cuando después se decodifica
+         * una de ellas con Texture_2D::decode() (y por tanto con Texture_2D::create(), Texture_Loader
+         * o Atlas_Packer) se entregan esos píxeles en lugar de volver a leer y decodificar el asset.
+         * Si una textura se pide mientras el hilo la está decodificando se espera a que termine.
+         *
+         * Las texturas que no caben en el presupuesto de memoria, y los assets que no son texturas,
+         * solo se leen para que el sistema los tenga en su caché de páginas.
+         */
+        class Asset_Prefetcher : Non_Copyable
+        {
+        public:
+
+            struct Request
+            {
+                std::string         path;
+                bool                texture;        ///< Si es false el asset solo se lee.
+                Texture_2D::Options options;        ///< Opciones con las que se decodificará la textura.
+            };
+
+            typedef std::vector< Request > Request_List;
+
+        private:
+
+            enum State
+            {
+                QUEUED,
+                DECODING,
+                READY,
+                FAILED
+            };
+
+            struct Entry
+            {
+                Request                  request;
+                State                    state;
+                Color_Buffer< Rgba8888 > color_buffer;
+                Compressed_Image         image;         ///< Se usa en lugar de color_buffer con los KTX y PKM.
+                size_t                   bytes;         ///< Memoria que ocupan los píxeles decodificados.
+            };
+
+            typedef std::shared_ptr< Entry >              Entry_Handle;
+            typedef std::map< std::string, Entry_Handle > Entry_Map;
+
+        private:
+
+            std::thread             worker;
+            std::mutex              mutex;
+            std::condition_variable condition;          ///< Avisa al hilo de que hay trabajo o de que debe terminar.
+            std::condition_variable decoded_condition;  ///< Avisa a take() de que ha terminado una decodificación.
+            std::deque< std::string > queue;            ///< Rutas pendientes en el orden en el que se pidieron.
+            Entry_Map               entries;
+            size_t                  memory_budget;
+            size_t                  memory_used;
+            bool                    stopping;
+
+        public:
+
+            static Asset_Prefetcher & get_instance ();
+
+        private:
+
+            Asset_Prefetcher();
+           ~Asset_Prefetcher();
+
+        public:
+
+            /**
+             * Sustituye la predicción anterior por una nueva. Las peticiones que ya estaban pedidas
+             * se conservan (con su trabajo hecho) y el resto de lo preparado que no se ha usado se
+             * descarta, porque ya no se espera que haga falta. Se puede llamar desde cualquier hilo.
+             */
+            void prefetch (const Request_List & requests);
+
+            /**
+             * Añade a una lista de peticiones las texturas de una tabla. Sirve cualquier tipo de
+             * entrada que tenga un campo path (como los Texture_Data de las escenas).
+             */
+            template< class ENTRY >
+            static void add_textures (Request_List & requests, const ENTRY * entries, size_t count, const Texture_2D::Options & options = {})
+            {
+                for (size_t index = 0; index < count; ++index)
+                {
+                    requests.push_back ({ entries[index].path, true, options });
+                }
+            }
+
+            /**
+             * Descarta todo lo pendiente y lo ya preparado.
+             */
+            void clear ()
+            {
+                prefetch (Request_List());
+            }
+
+            /**
+             * Descarta todo y espera a que termine el hilo. Lo llama Director al terminar, para que el
+             * hilo no siga vivo hasta que se destruyen los objetos estáticos. Si después se piden más
+             * assets se vuelve a crear.
+             */
+            void stop ();
+
+            /**
+             * @param bytes Memoria máxima que pueden ocupar los píxeles de las texturas preparadas.
+             */
+            void set_memory_budget (size_t bytes)
+            {
+                std::lock_guard< std::mutex > lock(mutex);
+
+                memory_budget = bytes;
+            }
+
+            /**
+             * Entrega los píxeles de una textura si se ha preparado con opciones compatibles (o la
+             * espera si se está decodificando). La textura deja de estar preparada. La llama
+             * Texture_2D::decode().
+             * @param options Recibe el tamaño y la opacidad de la imagen.
+             * @return false si la textura no está preparada y hay que decodificarla.
+             */
+            bool take (const std::string & path, Color_Buffer< Rgba8888 > & color_buffer, Compressed_Image & image, Texture_2D::Options & options);
+
+        private:
+
+            void   run_worker ();
+
+            /**
+             * @return memoria que ocupan los píxeles decodificados (0 si no se han decodificado).
+             */
+            size_t prepare    (Entry & entry, bool decode);
+
+        };
+
+    }
+
+#endif
@@ -18,6 +18,7 @@
     #include <string>
     #include <vector>
     #include <rapidxml.hpp>
+    #include <basics/Asset>
     #include <basics/Id>
     #include <basics/Point>
     #include <basics/Size>
@@ -93,7 +94,7 @@
 
         private:
 
-            void parse     (Buffer           & slices_data, const std::string & path, Graphics_Context::Accessor & context);
+            void parse     (const Asset::Span & slices_file, const std::string & path, Graphics_Context::Accessor & context);
             void parse_img (rapidxml::xml_node<> * img_tag, const std::string & path, Graphics_Context::Accessor & context);
             void parse_dir (rapidxml::xml_node<> * dir_tag, const std::string & prefix = std::string());
             void parse_spr (rapidxml::xml_node<> * spr_tag, const std::string & id);
@@ -0,0 +1,166 @@
+/*
+ * ATLAS PACKER
+ * Copyright © 2018+ Ángel Rodríguez Ballesteros
+ *
+ * Distributed under the Boost Software License, version  1.0
+ * See documents/LICENSE.TXT or www.boost.org/LICENSE_1_0.txt
+ *
+ * angel.rodriguez@esne.edu
+ *
+ * C2610172300
+ */
+
+#ifndef BASICS_ATLAS_PACKER_HEADER
+#define BASICS_ATLAS_PACKER_HEADER
+
+    #include <future>
+    #include <memory>
+    #include <string>
+    #include <vector>
+    #include <basics/Atlas>
+    #include <basics/Color_Buffer>
+    #include <basics/Graphics_Context>
+    #include <basics/Texture_2D>
+    #include <basics/Texture_Loader>
+
+    namespace basics
+    {
+
+        /**
+         * Junta en tiempo de ejecución varias imágenes en una o pocas texturas (páginas) para que los
+         * sprites que las usan se puedan dibujar sin cambiar de textura. Las imágenes se colocan con
+         * un algoritmo skyline (cada una en la posición más baja en la que cabe) y cada página es un
+         * Atlas con un slice por imagen, con el mismo id que se le dio a la imagen.
+         *
+         * Leer y decodificar las imágenes (add() y add_batch()) no toca el contexto gráfico y se puede
+         * hacer en otro hilo, o encargar a los hilos de un Texture_Loader. Solo pack() tiene que
+         * llamarse desde el hilo del contexto. La clase no se protege de llamadas simultáneas desde
+         * varios hilos.
+         *
+         * Con la residencia RELOAD_FROM_ASSET las páginas no conservan sus píxeles: si se pierde el
+         * contexto se vuelven a leer sus imágenes y se vuelven a colocar igual que la primera vez.
+         */
+        class Atlas_Packer
+        {
+        public:
+
+            typedef std::shared_ptr< Atlas >    Atlas_Handle;
+            typedef std::vector< Atlas_Handle > Atlas_List;
+
+        private:
+
+            struct Image
+            {
+                Id                                      id;
+                std::string                             asset_path;     ///< Vacía si la imagen no sale de un asset.
+                Color_Buffer< Rgba8888 >                pixels;
+                std::future< Color_Buffer< Rgba8888 > > decoding;       ///< Válido mientras la decodifica un Texture_Loader.
+            };
+
+            typedef std::vector< Image > Image_List;
+
+        private:
+
+            Texture_2D::Options options;
+            unsigned            max_page_size;
+            unsigned            padding;
+            Image_List          images;
+
+        public:
+
+            /**
+             * @param options Se usan al decodificar las imágenes (por ejemplo, para premultiplicar el
+             *     alfa) y al crear las texturas de las páginas. Con RELOAD_FROM_ASSET o KEEP_ENCODED
+             *     las páginas cuyas imágenes salen todas de assets se regeneran a partir de ellos; el
+             *     resto conservan sus píxeles.
+             * @param max_page_size Lado máximo de las páginas. Debe ser una potencia de 2.
+             * @param padding Píxeles que se dejan alrededor de cada imagen, rellenos con su borde para
+             *     que el filtrado no mezcle imágenes vecinas.
+             */
+            Atlas_Packer(const Texture_2D::Options & options = {}, unsigned max_page_size = 2048, unsigned padding = 2);
+
+        public:
+
+            /**
+             * Lee y decodifica una imagen.
+             * @return false si no se pudo leer o decodificar.
+             */
+            bool add (Id id, const std::string & asset_path);
+
+            /**
+             * Encarga la lectura y decodificación de una imagen a los hilos de un Texture_Loader, que
+             * debe existir hasta que se llame a pack().
+             */
+            void add (Texture_Loader & loader, Id id, const std::string & asset_path);
+
+            /**
+             * Añade una imagen ya decodificada, de la que se queda los píxeles sin copiarlos.
+             */
+            void add (Id id, Color_Buffer< Rgba8888 > && pixels);
+
+            /**
+             * Añade todas las imágenes de una tabla de structs con miembros id y path, como las que
+             * tienen las escenas para su Texture_Loader.
+             * @return false si alguna no se pudo leer o decodificar.
+             */
+            template< class ENTRY >
+            bool add_batch (const ENTRY * entries, size_t count)
+            {
+                bool success = true;
+
+                for (size_t index = 0; index < count; ++index)
+                {
+                    success &= add (entries[index].id, entries[index].path);
+                }
+
+                return success;
+            }
+
+            /**
+             * Encarga todas las imágenes de una tabla a los hilos de un Texture_Loader, que las
+             * decodifican a la vez.
+             */
+            template< class ENTRY >
+            void add_batch (Texture_Loader & loader, const ENTRY * entries, size_t count)
+            {
+                for (size_t index = 0; index < count; ++index)
+                {
+                    add (loader, entries[index].id, entries[index].path);
+                }
+            }
+
+            /**
+             * @return true cuando ya se han decodificado todas las imágenes encargadas a un
+             *     Texture_Loader, de modo que pack() no tendrá que esperar.
+             */
+            bool is_ready () const;
+
+            /**
+             * Coloca las imágenes añadidas en páginas, crea sus texturas en el contexto y se vacía.
+             * Si quedan imágenes decodificándose se espera a que terminen. Las imágenes que no caben
+             * en una página se descartan (y sus slices no existirán).
+             * @return Lista vacía si alguna de las imágenes encargadas a un Texture_Loader no se pudo
+             *     leer o decodificar.
+             */
+            Atlas_List pack (Graphics_Context::Accessor & context);
+
+            /**
+             * Busca en las páginas el slice de la imagen con el id indicado.
+             */
+            static const Atlas::Slice * find_slice (const Atlas_List & atlases, Id id)
+            {
+                for (const Atlas_Handle & atlas : atlases)
+                {
+                    const Atlas::Slice * slice = atlas->get_slice (id);
+
+                    if (slice) return slice;
+                }
+
+                return nullptr;
+            }
+
+        };
+
+    }
+
+#endif
@@ -13,6 +13,7 @@
 #ifndef BASICS_CANVAS_HEADER
 #define BASICS_CANVAS_HEADER
 
+    #include <ostream>
     #include <basics/Atlas>
     #include <basics/Graphics_Context>
     #include <basics/Point>
@@ -52,11 +53,39 @@
                 ADD
             };
 
+            static constexpr Id type_id = ID(canvas);  ///< Etiqueta con la que Graphics_Context reconoce los Canvas.
+
             struct Options
             {
                 Size2u size;
             };
 
+            /**
+             * Datos de cada copia de un quad texturizado para draw_instances().
+             */
+            struct Instance
+            {
+                Point2f position;                   ///< Punto del quad que indica handling.
+                Size2f  size;
+                Point2f uv_bottom_left;             ///< Coordenadas de textura de la esquina inferior izquierda (normalmente { 0, 1 }).
+                Point2f uv_top_right;               ///< Coordenadas de textura de la esquina superior derecha (normalmente { 1, 0 }).
+                float   opacity;                    ///< Se multiplica por la opacidad del canvas.
+            };
+
+            /**
+             * Contadores del trabajo enviado a la GPU. Se reinician en cada llamada a end_frame().
+             */
+            struct Statistics
+            {
+                unsigned draw_calls;                ///< Número de llamadas de dibujado emitidas.
+                unsigned flushes;                   ///< Número de lotes de quads enviados.
+                unsigned quads;                     ///< Número de quads texturizados dibujados.
+                unsigned state_changes;             ///< Cambios de estado enviados a la API gráfica.
+                unsigned redundant_state_changes;   ///< Cambios de estado descartados por no cambiar nada.
+                unsigned filled_pixels;             ///< Área (en unidades del canvas) cubierta por quads texturizados, sumando los solapes.
+                unsigned blended_pixels;            ///< Parte de filled_pixels que se ha dibujado con mezcla.
+            };
+
         public:
 
             typedef Canvas * (* Factory) (Id id, Graphics_Context::Accessor & context, const Options & options);
@@ -82,11 +111,62 @@
 
         protected:
 
+            Statistics statistics;
+            Statistics last_frame_statistics;
+
+        protected:
+
+            Canvas()
+            :
+                Renderer             (type_id),
+                statistics           (),
+                last_frame_statistics()
+            {
+            }
+
             virtual ~Canvas() = default;
 
         public:
 
             virtual void reset_state     () { }
+            virtual void set_batching    (bool enabled) { }
+            virtual void flush           () { }
+
+            /**
+             * Si está activada la ordenación, los quads texturizados se acumulan y se dibujan
+             * ordenados por (capa, shader, textura) al llamar a flush() o cuando algún cambio de
+             * estado lo exige. Dentro de una misma capa solo se reordenan quads con texturas
+             * distintas, así que los que se solapen deben ir en capas distintas. Está desactivada
+             * por defecto: sin ella los quads se dibujan en el orden en el que se piden y solo se
+             * juntan en un lote los consecutivos que comparten textura.
+             */
+            virtual void set_sorting     (bool enabled) { }
+            virtual void set_layer       (int  layer  ) { }
+
+            /**
+             * Vuelca los comandos pendientes de dibujar en el orden en el que se enviarán.
+             */
+            virtual void dump_commands   (std::ostream & output) { }
+
+            /**
+             * Envía lo que quede pendiente de dibujar y cierra los contadores del fotograma actual.
+             * Director lo llama antes de presentar cada fotograma.
+             */
+            void end_frame ()
+            {
+                flush ();
+
+                last_frame_statistics = statistics;
+                statistics            = Statistics();
+            }
+
+            /**
+             * @return Contadores del último fotograma completado.
+             */
+            const Statistics & get_frame_statistics () const
+            {
+                return last_frame_statistics;
+            }
 
         public:
 
@@ -101,6 +181,20 @@
             virtual void set_transform   (const Transformation2f & transform) { }
             virtual void apply_transform (const Transformation2f & transform) { }
 
+            /**
+             * Si está activado, los quads texturizados se transforman en la CPU al añadirlos, por lo
+             * que cambiar la transformación no obliga a enviar el lote pendiente.
+             */
+            virtual void set_transform_baking (bool enabled) { }
+
+            /**
+             * Si está activado (y hay buffer de profundidad), los quads con textura opaca dibujados con
+             * opacidad 1 se envían primero, de delante hacia atrás, sin mezcla y con test de
+             * profundidad, de modo que la GPU descarta lo que queda tapado. Requiere la ordenación.
+             * La diferencia entre filled_pixels y blended_pixels indica el área que no se ha mezclado.
+             */
+            virtual void set_opaque_pass (bool enabled) { }
+
         public:
 
             virtual void clear           () { }
@@ -114,6 +208,21 @@
             virtual void fill_rectangle  (const Point2f & where, const Size2f & size, const Atlas::Slice * slice,   int handling = CENTER) { }
             virtual void draw_text       (const Point2f & where, const Text_Layout & text_layout, int handling = TOP | LEFT);
 
+        protected:
+
+            /**
+             * @return Posición de la esquina superior izquierda del texto según el anclaje.
+             */
+            static Point2f get_text_top_left (const Point2f & where, const Text_Layout & text_layout, int handling);
+
+        public:
+
+            /**
+             * Dibuja muchas copias de un mismo quad texturizado con la menor cantidad posible de
+             * llamadas. Se dibujan en el momento, después de todo lo que estuviese pendiente.
+             */
+            virtual void draw_instances  (const Texture_2D * texture, const Instance * instances, size_t count, int handling = CENTER) { }
+
         };
 
     }
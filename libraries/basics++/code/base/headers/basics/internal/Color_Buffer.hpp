@@ -13,6 +13,7 @@
 #ifndef BASICS_COLOR_BUFFER_HEADER
 #define BASICS_COLOR_BUFFER_HEADER
 
+    #include <utility>
     #include <vector>
     #include <basics/Color>
 
@@ -51,6 +52,39 @@
             {
             }
 
+            Color_Buffer(const Color_Buffer & ) = default;
+
+            /**
+             * Se queda con los píxeles de other sin copiarlos. other queda vacío.
+             */
+            Color_Buffer(Color_Buffer && other)
+            :
+                width (other.width ),
+                height(other.height),
+                buffer(std::move (other.buffer))
+            {
+                other.width  = 0;
+                other.height = 0;
+            }
+
+        public:
+
+            Color_Buffer & operator = (const Color_Buffer & ) = default;
+
+            Color_Buffer & operator = (Color_Buffer && other)
+            {
+                if (this != &other)
+                {
+                    width        = other.width;
+                    height       = other.height;
+                    buffer       = std::move (other.buffer);
+                    other.width  = 0;
+                    other.height = 0;
+                }
+
+                return *this;
+            }
+
         public:
 
             unsigned size () const
@@ -77,6 +111,24 @@
                 buffer.shrink_to_fit ();
             }
 
+            /**
+             * Como resize(), pero deja al final spare colores más que no forman parte de la imagen y
+             * que se pueden usar como espacio de trabajo (por ejemplo, para decodificarla sobre el
+             * propio buffer). trim_spare() los quita sin volver a reservar memoria.
+             */
+            void resize_with_spare (unsigned new_width, unsigned new_height, size_t spare)
+            {
+                width  = new_width;
+                height = new_height;
+
+                buffer.resize (size_t(width) * height + spare);
+            }
+
+            void trim_spare ()
+            {
+                buffer.resize (size_t(width) * height);
+            }
+
         public:
 
             Color & operator [] (unsigned index)
@@ -0,0 +1,143 @@
+/*
+ * COMPRESSED IMAGE
+ * Copyright © 2018+ Ángel Rodríguez Ballesteros
+ *
+ * Distributed under the Boost Software License, version  1.0
+ * See documents/LICENSE.TXT or www.boost.org/LICENSE_1_0.txt
+ *
+ * angel.rodriguez@esne.edu
+ *
+ * C2610172000
+ */
+
+#ifndef BASICS_COMPRESSED_IMAGE_HEADER
+#define BASICS_COMPRESSED_IMAGE_HEADER
+
+    #include <vector>
+    #include <basics/Color_Buffer>
+    #include <basics/types>
+
+    namespace basics
+    {
+
+        /**
+         * Imagen en un formato de compresión de GPU leída de un contenedor KTX (versión 1) o PKM. Se
+         * conserva tal cual para subirla a la GPU sin descomprimir. Si el contexto no admite el
+         * formato se puede decodificar por software con decode().
+         * Una imagen ETC1 puede llevar un plano de alfa: una segunda imagen ETC1 del mismo tamaño cuyo
+         * canal verde es el alfa. En un KTX se guarda como un array de dos elementos y en un PKM como
+         * un segundo PKM a continuación del primero.
+         */
+        class Compressed_Image
+        {
+        public:
+
+            enum Format
+            {
+                NONE,
+                ETC1_RGB,
+                ETC2_RGB,
+                ETC2_RGB_A1,                    ///< ETC2 con alfa de un bit (punch-through).
+                ETC2_RGBA,                      ///< ETC2 con alfa EAC de 8 bits.
+                ASTC_RGBA,                      ///< ASTC LDR con el tamaño de bloque de get_block_width/height().
+            };
+
+        private:
+
+            Format              format;
+            unsigned            width;
+            unsigned            height;
+            unsigned            block_width;
+            unsigned            block_height;
+            std::vector< byte > data;           ///< Bloques del nivel 0.
+            std::vector< byte > alpha_data;     ///< Bloques del plano de alfa de ETC1 (vacío si no hay).
+
+        public:
+
+            /**
+             * @return true si los datos empiezan con la firma de un contenedor KTX o PKM.
+             */
+            static bool is_compressed (const byte * file_data, size_t size);
+
+        public:
+
+            Compressed_Image()
+            :
+                format      (NONE),
+                width       (0),
+                height      (0),
+                block_width (0),
+                block_height(0)
+            {
+            }
+
+        public:
+
+            /**
+             * Lee el nivel 0 del contenedor (se ignoran los demás niveles y los metadatos).
+             * @return false si el contenedor no es válido o el formato no está soportado.
+             */
+            bool load (const byte * file_data, size_t size);
+
+            /**
+             * Decodifica la imagen por software (incluido el plano de alfa si lo hay). Solo está
+             * disponible para ETC1 y ETC2.
+             */
+            bool decode (Color_Buffer< Rgba8888 > & color_buffer) const;
+
+            void clear ()
+            {
+                *this = Compressed_Image();
+            }
+
+        public:
+
+            bool empty () const
+            {
+                return format == NONE;
+            }
+
+            Format   get_format       () const { return format;       }
+            unsigned get_width        () const { return width;        }
+            unsigned get_height       () const { return height;       }
+            unsigned get_block_width  () const { return block_width;  }
+            unsigned get_block_height () const { return block_height; }
+
+            const std::vector< byte > & get_data       () const { return data;       }
+            const std::vector< byte > & get_alpha_data () const { return alpha_data; }
+
+            bool has_alpha_plane () const
+            {
+                return !alpha_data.empty ();
+            }
+
+            /**
+             * @return true si el formato no tiene canal alfa y tampoco hay plano de alfa.
+             */
+            bool is_opaque () const
+            {
+                return (format == ETC1_RGB || format == ETC2_RGB) && alpha_data.empty ();
+            }
+
+            /**
+             * @return tamaño en bytes de una imagen en este formato con las dimensiones dadas.
+             */
+            size_t get_image_size (unsigned image_width, unsigned image_height) const
+            {
+                size_t block_bytes = format == ETC1_RGB || format == ETC2_RGB || format == ETC2_RGB_A1 ? 8 : 16;
+
+                return size_t((image_width  + block_width  - 1) / block_width )
+                     * size_t((image_height + block_height - 1) / block_height)
+                     * block_bytes;
+            }
+
+        private:
+
+            bool load_ktx (const byte * file_data, size_t size);
+            bool load_pkm (const byte * file_data, size_t size);
+
+        };
+
+    }
+
+#endif
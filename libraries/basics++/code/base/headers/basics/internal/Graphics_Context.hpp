@@ -24,6 +24,7 @@
     #include <basics/Graphics_Resource_Cache>
     #include <basics/Id>
     #include <basics/Point>
+    #include <basics/Renderer>
     #include <basics/Size>
     #include <basics/types>
 
@@ -136,12 +137,19 @@
             Resource_List             resources;
             Graphics_Resource_Cache * graphics_resource_cache;
 
+            Renderer                * cached_renderer;          ///< Último renderer que devolvió get_renderer().
+            Id                        cached_renderer_id;
+            bool                      renderer_cached;
+
         protected:
 
             Graphics_Context(Window & window, Graphics_Resource_Cache * cache = nullptr)
             :
                 window(window),
-                graphics_resource_cache(cache)
+                graphics_resource_cache(cache),
+                cached_renderer   (nullptr),
+                cached_renderer_id(0),
+                renderer_cached   (false)
             {
             }
 
@@ -149,16 +157,33 @@
 
         public:
 
+            /**
+             * Las escenas lo llaman en cada fotograma, así que se recuerda el último renderer
+             * encontrado para no buscar en el mapa y el tipo se comprueba con la etiqueta que cada
+             * interfaz pasa a Renderer en lugar de con dynamic_cast. RENDERER debe ser una interfaz
+             * con type_id (como Canvas), no una especialización concreta.
+             */
             template< class RENDERER >
             RENDERER * get_renderer (Id id)
             {
-                Renderer_List::iterator renderer = renderers.find (id);
+                if (!renderer_cached || cached_renderer_id != id)
+                {
+                    Renderer_List::iterator renderer = renderers.find (id);
 
-                return dynamic_cast< RENDERER * >(renderer != renderers.end () ? renderer->second.get () : nullptr);
+                    cached_renderer    = renderer != renderers.end () ? renderer->second.get () : nullptr;
+                    cached_renderer_id = id;
+                    renderer_cached    = true;
+                }
+
+                return cached_renderer && cached_renderer->get_renderer_type () == RENDERER::type_id
+                    ? static_cast< RENDERER * >(cached_renderer)
+                    : nullptr;
             }
 
             bool add (Id id, const std::shared_ptr< Renderer > & renderer)
             {
+                renderer_cached = false;
+
                 return renderers.find (id) == renderers.end () ? renderers[id] = renderer, true : false;
             }
 
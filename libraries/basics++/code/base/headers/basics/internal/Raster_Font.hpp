@@ -52,9 +52,15 @@
             Atlas_Handle  atlas;
             Metrics       metrics;
 
+            Texture_2D::Options texture_options;    ///< Con los que se crean las texturas de las páginas.
+
         public:
 
-            Raster_Font(const std::string & path, Graphics_Context::Accessor & context);
+            /**
+             * @param texture_options Las fuentes de un solo color pueden usar ALPHA_8 para ocupar la
+             *     cuarta parte en la GPU.
+             */
+            Raster_Font(const std::string & path, Graphics_Context::Accessor & context, const Texture_2D::Options & texture_options = {});
 
         public:
 
@@ -72,7 +78,7 @@
 
         private:
 
-            bool parse        (Buffer & font_data, const std::string & path, Graphics_Context::Accessor & context);
+            bool parse        (const Asset::Span & font_file, const std::string & path, Graphics_Context::Accessor & context);
             bool parse_font   (rapidxml::xml_node<> *   font_tag, const std::string & path, Graphics_Context::Accessor & context);
             bool parse_pages  (rapidxml::xml_node<> *  pages_tag, const std::string & path, Graphics_Context::Accessor & context);
             bool parse_info   (rapidxml::xml_node<> *   info_tag);
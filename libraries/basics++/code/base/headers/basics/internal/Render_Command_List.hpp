@@ -0,0 +1,156 @@
+/*
+ * RENDER COMMAND LIST
+ * Copyright © 2018+ Ángel Rodríguez Ballesteros
+ *
+ * Distributed under the Boost Software License, version  1.0
+ * See documents/LICENSE.TXT or www.boost.org/LICENSE_1_0.txt
+ *
+ * angel.rodriguez@esne.edu
+ *
+ * C2610171600
+ */
+
+#ifndef BASICS_RENDER_COMMAND_LIST_HEADER
+#define BASICS_RENDER_COMMAND_LIST_HEADER
+
+    #include <ostream>
+    #include <vector>
+    #include <basics/Point>
+    #include <basics/Size>
+    #include <basics/Text_Layout>
+    #include <basics/Transformation>
+
+    namespace basics
+    {
+
+        struct Texture_2D;
+
+        /**
+         * Lista de quads texturizados pendientes de dibujar. El canvas los acumula aquí en lugar de
+         * dibujarlos al momento y los ordena por (capa, shader, textura) antes de enviarlos, de modo
+         * que los que comparten textura acaban en el mismo lote. Dentro de cada clave se respeta el
+         * orden en el que se añadieron. No depende de la API gráfica, por lo que se puede volcar y
+         * comparar sin GPU.
+         * Un comando también puede representar un bloque de vértices de texto entero. Sus vértices se
+         * copian en la propia lista al añadirlo, por lo que el texto que los generó no tiene que
+         * seguir existiendo cuando se envían.
+         */
+        class Render_Command_List
+        {
+        public:
+
+            struct Command
+            {
+                int                layer;               ///< Capa de dibujado. Las menores se dibujan antes.
+                unsigned           shader;              ///< Clave del programa con el que se dibuja.
+                unsigned           texture_key;         ///< Clave de la textura (su id en la API gráfica).
+                unsigned           sequence;            ///< Orden en el que se añadió el comando.
+                bool               opaque;              ///< Se puede dibujar sin mezcla porque tapa lo que tiene detrás.
+                float              blend;               ///< Factor de mezcla (1 transparencia normal, 0 aditiva).
+                const Texture_2D * texture;
+                Point2f            positions  [4];      ///< Esquinas (inferior izquierda, superior izquierda, inferior derecha, superior derecha).
+                Point2f            texture_uvs[4];
+                unsigned           first_vertex;        ///< Primer vértice del bloque dentro de la lista.
+                unsigned           vertex_count;        ///< Vértices del bloque (0 si el comando es un quad).
+                float              area;                ///< Área en píxeles del bloque.
+            };
+
+            typedef std::vector< Command >              Command_List;
+            typedef Command_List::const_iterator        const_iterator;
+            typedef Text_Layout::Vertex                 Vertex;
+
+        private:
+
+            Command_List             commands;
+            Text_Layout::Vertex_List vertices;      ///< Vértices de los bloques de todos los comandos.
+            bool                     sorted;
+
+        public:
+
+            Render_Command_List()
+            :
+                sorted(true)
+            {
+            }
+
+        public:
+
+            void add
+            (
+                int                layer,
+                unsigned           shader,
+                unsigned           texture_key,
+                const Texture_2D * texture,
+                const float      * positions,
+                const Point2f    * texture_uvs,
+                bool               opaque = false,
+                float              blend  = 1.f
+            );
+
+            /**
+             * Añade un bloque de vértices de texto (cuatro por glifo). Los vértices se copian tras
+             * aplicarles la transformación dada, que debe incluir el desplazamiento del texto.
+             */
+            void add_block
+            (
+                int                      layer,
+                unsigned                 shader,
+                unsigned                 texture_key,
+                const Texture_2D       * texture,
+                const Vertex           * block,
+                size_t                   count,
+                const Transformation2f & transform,
+                float                    area,
+                float                    blend = 1.f
+            );
+
+            /**
+             * Ordena los comandos por (capa, shader, textura). Los comandos con la misma clave
+             * conservan el orden en el que se añadieron.
+             */
+            void sort ();
+
+            /**
+             * Escribe una línea de texto por comando, en el orden actual.
+             */
+            void dump (std::ostream & output) const;
+
+            void clear ()
+            {
+                commands.clear ();
+                vertices.clear ();
+                sorted = true;
+            }
+
+            void reserve (size_t count)
+            {
+                commands.reserve (count);
+            }
+
+        public:
+
+            bool   empty () const { return commands.empty (); }
+            size_t size  () const { return commands.size  (); }
+
+            const_iterator begin () const { return commands.begin (); }
+            const_iterator end   () const { return commands.end   (); }
+
+            const Command & operator [] (size_t index) const
+            {
+                return commands[index];
+            }
+
+            const Vertex * get_vertices (const Command & command) const
+            {
+                return vertices.data () + command.first_vertex;
+            }
+
+        private:
+
+            void push (Command & command);
+
+        };
+
+    }
+
+#endif
@@ -13,17 +13,31 @@
 #ifndef BASICS_RENDERER_HEADER
 #define BASICS_RENDERER_HEADER
 
+    #include <basics/Id>
+
     namespace basics
     {
 
         class Renderer
         {
 
+            const Id renderer_type;         ///< Etiqueta de la interfaz (Canvas...) que implementa el renderer.
+
         protected:
 
-            Renderer() = default;
+            Renderer(Id type) : renderer_type(type)
+            {
+            }
+
             virtual ~Renderer() = default;
 
+        public:
+
+            Id get_renderer_type () const
+            {
+                return renderer_type;
+            }
+
         };
 
     }
@@ -41,11 +41,30 @@
 
             typedef std::vector< Glyph > Glyph_List;
 
+            /**
+             * Vértice de un glifo listo para dibujar: posición relativa a la esquina superior izquierda
+             * del texto y coordenadas de textura ya normalizadas. Cada glifo ocupa cuatro vértices
+             * seguidos (inferior izquierda, superior izquierda, inferior derecha, superior derecha),
+             * por lo que el bloque entero se puede enviar tal cual a la GPU.
+             */
+            struct Vertex
+            {
+                float x, y;
+                float u, v;
+            };
+
+            typedef std::vector< Vertex > Vertex_List;
+
         private:
 
-            Glyph_List glyphs;
-            float      width;
-            float      height;
+            Glyph_List          glyphs;
+            float               width;
+            float               height;
+
+            bool                caching;            ///< Si es true el bloque de vértices se calcula una sola vez.
+            mutable bool        vertices_baked;
+            mutable Vertex_List vertices;
+            float               glyph_area;         ///< Suma de las áreas de los glifos.
 
         public:
 
@@ -68,6 +87,56 @@
                 return height;
             }
 
+            /**
+             * Todos los glifos salen del atlas de la fuente, por lo que comparten textura.
+             */
+            const Texture_2D * get_texture () const
+            {
+                return glyphs.empty () ? nullptr : glyphs.front ().slice->atlas->get_texture ().get ();
+            }
+
+        public:
+
+            /**
+             * Activa o desactiva que el bloque de vértices de los glifos se guarde tras calcularlo la
+             * primera vez. Está activada por defecto, ya que el texto de un layout no cambia y así no
+             * cuesta nada en la CPU dibujarlo en cada fotograma. Desactivarla solo ahorra memoria en
+             * textos que se dibujan una vez.
+             */
+            void set_caching (bool enabled)
+            {
+                caching = enabled;
+
+                if (!caching)
+                {
+                    vertices.clear ();
+                    vertices_baked = false;
+                }
+            }
+
+            /**
+             * @return Vértices de todos los glifos. Si la caché está desactivada se vuelven a calcular
+             *         en cada llamada.
+             */
+            const Vertex_List & get_vertices () const
+            {
+                if (!caching || !vertices_baked) bake_vertices ();
+
+                return vertices;
+            }
+
+            /**
+             * @return Suma de las áreas de los glifos (para las estadísticas de los canvas).
+             */
+            float get_glyph_area () const
+            {
+                return glyph_area;
+            }
+
+        private:
+
+            void bake_vertices () const;
+
         };
 
     }
@@ -13,70 +13,189 @@
 #ifndef BASICS_TEXTURE_2D_HEADER
 #define BASICS_TEXTURE_2D_HEADER
 
+    #include <functional>
     #include <memory>
     #include <string>
+    #include <vector>
     #include <basics/Asset>
     #include <basics/Color_Buffer>
+    #include <basics/Compressed_Image>
     #include <basics/Graphics_Context>
     #include <basics/Graphics_Resource>
+    #include <basics/pixel_convert>
 
     namespace basics
     {
 
+        class Asset_Prefetcher;
+
         struct Texture_2D : public Graphics_Resource
         {
+
+            friend class Asset_Prefetcher;
+
         public:
 
+            /**
+             * Qué se conserva en la RAM después de subir la textura a la GPU, que es lo que se usa para
+             * volver a subirla si se pierde el contexto gráfico.
+             */
+            enum Residency
+            {
+                KEEP_PIXELS,                    ///< Se conservan los píxeles decodificados (por defecto).
+                RELOAD_FROM_ASSET,              ///< No se conserva nada: se vuelve a leer y decodificar el asset (o los de su Pixel_Source).
+                KEEP_ENCODED,                   ///< Se conserva solo el archivo (el PNG o el KTX/PKM) y se vuelve a decodificar.
+            };
+
+            /**
+             * De dónde salen los niveles reducidos de la textura, que evitan que los sprites dibujados
+             * más pequeños que su imagen lean la textura entera.
+             */
+            enum Mipmaps
+            {
+                NO_MIPMAPS,                     ///< Solo se sube la imagen (por defecto).
+                GPU_MIPMAPS,                    ///< Los niveles se generan con glGenerateMipmap().
+                CPU_MIPMAPS,                    ///< Los niveles se calculan en la CPU promediando bloques de 2x2.
+            };
+
             struct Options
             {
-                unsigned width;
-                unsigned height;
+                unsigned     width;
+                unsigned     height;
+                bool         opaque;            ///< Todos los píxeles tienen alfa 1. Se calcula al decodificar.
+                Residency    residency;
+                Pixel_Format format;            ///< Formato en el que se guardan los píxeles en la GPU.
+                bool         dither;            ///< Trama los degradados al reducir los canales a 16 bits.
+                Mipmaps      mipmaps;
+                bool         trilinear;         ///< Con mipmaps, mezcla los dos niveles más cercanos (si no, usa el más cercano).
+                bool         premultiplied;     ///< Multiplica el color por el alfa al decodificar.
             };
 
         public:
 
-            typedef std::shared_ptr< Texture_2D > (* Factory) (Id id, Color_Buffer< Rgba8888 > & color_buffer, const Options & options);
+            typedef std::shared_ptr< Texture_2D > (* Factory           ) (Id id, Color_Buffer< Rgba8888 > & color_buffer, const Options & options);
+            typedef std::shared_ptr< Texture_2D > (* Compressed_Factory) (Id id, Compressed_Image         & image,        const Options & options);
+
+            /**
+             * Vuelve a generar los píxeles de una textura que no sale de un único asset (como las
+             * páginas de Atlas_Packer).
+             */
+            typedef std::function< bool (Color_Buffer< Rgba8888 > & color_buffer) > Pixel_Source;
 
         private:
 
-            static Id      texture_2d_specialization_ids      [10];
-            static Factory texture_2d_specialization_factories[10];
-            static size_t  texture_2d_specialization_count;
+            static Id                 texture_2d_specialization_ids                 [10];
+            static Factory            texture_2d_specialization_factories           [10];
+            static Compressed_Factory texture_2d_specialization_compressed_factories[10];
+            static size_t             texture_2d_specialization_count;
+            static unsigned           dropped_mip_levels;
 
         public:
 
-            static void register_factory (Id id, Factory factory)
+            /**
+             * @param compressed_factory Crea texturas a partir de imágenes comprimidas para la GPU. Si
+             *     no se indica, esas imágenes se decodifican por software y se usa factory.
+             */
+            static void register_factory (Id id, Factory factory, Compressed_Factory compressed_factory = nullptr)
             {
-                texture_2d_specialization_ids      [texture_2d_specialization_count] = id;
-                texture_2d_specialization_factories[texture_2d_specialization_count] = factory;
+                texture_2d_specialization_ids                 [texture_2d_specialization_count] = id;
+                texture_2d_specialization_factories           [texture_2d_specialization_count] = factory;
+                texture_2d_specialization_compressed_factories[texture_2d_specialization_count] = compressed_factory;
                 texture_2d_specialization_count++;
             }
 
+            /**
+             * Ajuste de memoria para dispositivos con poca RAM: las texturas con mipmaps que se suban a
+             * partir de ahora descartan tantos niveles superiores como indique levels (el primero ya
+             * ocupa tres cuartas partes de la cadena). El tamaño lógico de la textura no cambia.
+             */
+            static void set_dropped_mip_levels (unsigned levels)
+            {
+                dropped_mip_levels = levels;
+            }
+
+            static unsigned get_dropped_mip_levels ()
+            {
+                return dropped_mip_levels;
+            }
+
         public:
 
+            /**
+             * La textura puede quedarse con los píxeles de color_buffer en lugar de copiarlos, por lo
+             * que este puede quedar vacío.
+             */
             static std::shared_ptr< Texture_2D > create (Id id, Graphics_Context::Accessor & context, Color_Buffer< Rgba8888 > & color_buffer, const Options & options = {});
             static std::shared_ptr< Texture_2D > create (Id id, Graphics_Context::Accessor & context, const std::string & asset_path, const Options & options = {});
 
+            /**
+             * Crea una textura con los bloques de una imagen comprimida para la GPU (que se mueven a
+             * la textura). Si el contexto no admite el formato la textura lo decodifica por software.
+             */
+            static std::shared_ptr< Texture_2D > create (Id id, Graphics_Context::Accessor & context, Compressed_Image & image, const Options & options = {});
+
+            /**
+             * Lee y decodifica la imagen de un asset sin tocar el contexto gráfico, por lo que se puede
+             * llamar desde cualquier hilo. Rellena el tamaño y la opacidad de options. Los KTX y PKM
+             * se decodifican por software.
+             */
+            static bool decode (const std::string & asset_path, Color_Buffer< Rgba8888 > & color_buffer, Options & options, std::vector< byte > * encoded_data = nullptr);
+
+            /**
+             * Como la anterior, pero los KTX y PKM se dejan comprimidos en image (y color_buffer queda
+             * vacío) para subirlos tal cual a la GPU. Si Asset_Prefetcher ya ha preparado la imagen
+             * se toma de ahí en lugar de leer el asset.
+             */
+            static bool decode (const std::string & asset_path, Color_Buffer< Rgba8888 > & color_buffer, Compressed_Image & image, Options & options, std::vector< byte > * encoded_data = nullptr);
+
         protected:
 
-            float width;
-            float height;
+            Id                  backend;        ///< Id con el que la especialización registró su factoría.
+            float               width;
+            float               height;
+            bool                opaque;
+            bool                premultiplied;  ///< El color de los píxeles ya está multiplicado por su alfa.
+            Residency           residency;
+            std::string         asset_path;     ///< Asset del que se vuelve a leer con RELOAD_FROM_ASSET.
+            std::vector< byte > encoded_data;   ///< Imagen comprimida que se conserva con KEEP_ENCODED.
+            Pixel_Source        pixel_source;   ///< Genera los píxeles con RELOAD_FROM_ASSET cuando no hay asset_path.
 
         protected:
 
-            Texture_2D(unsigned width, unsigned height)
+            Texture_2D(Id backend, unsigned width, unsigned height, bool opaque = false, Residency residency = KEEP_PIXELS, bool premultiplied = false)
             :
-                width (float(width )),
-                height(float(height))
+                backend      (backend),
+                width        (float(width )),
+                height       (float(height)),
+                opaque       (opaque),
+                premultiplied(premultiplied),
+                residency    (residency)
             {
             }
 
+            /**
+             * Los píxeles solo se premultiplican si se pide y el formato de la textura conserva tanto
+             * el color como el alfa.
+             */
+            static bool premultiplies (const Options & options)
+            {
+                return options.premultiplied && (options.format == RGBA_8888 || options.format == RGBA_4444 || options.format == RGBA_5551);
+            }
+
         public:
 
             virtual ~Texture_2D() = default;
 
         public:
 
+            /**
+             * Permite a los renderers reconocer sus propias texturas sin usar dynamic_cast.
+             */
+            Id get_backend () const
+            {
+                return backend;
+            }
+
             float get_width () const
             {
                 return width;
@@ -87,6 +206,71 @@
                 return height;
             }
 
+            /**
+             * Una textura opaca se puede dibujar sin mezcla (si la opacidad también es 1) y tapa por
+             * completo lo que quede detrás de ella.
+             */
+            bool is_opaque () const
+            {
+                return opaque;
+            }
+
+            /**
+             * Los renderers mezclan las texturas premultiplicadas sin volver a multiplicar su color
+             * por el alfa.
+             */
+            bool is_premultiplied () const
+            {
+                return premultiplied;
+            }
+
+            Residency get_residency () const
+            {
+                return residency;
+            }
+
+            /**
+             * Indica de dónde salieron los píxeles. Se guarda solo lo que necesita la política de
+             * residencia de la textura (la ruta o la imagen comprimida, que se mueve).
+             */
+            void set_source (const std::string & path, std::vector< byte > && data)
+            {
+                if (residency == RELOAD_FROM_ASSET) asset_path   = path;
+                if (residency == KEEP_ENCODED     ) encoded_data = std::move (data);
+            }
+
+            /**
+             * Con RELOAD_FROM_ASSET, indica cómo volver a generar los píxeles si se pierde el contexto
+             * gráfico cuando la textura no sale de un asset. Se debe indicar antes de añadir la
+             * textura al contexto.
+             */
+            void set_pixel_source (const Pixel_Source & source)
+            {
+                if (residency == RELOAD_FROM_ASSET) pixel_source = source;
+            }
+
+        protected:
+
+            /**
+             * @return true si la textura puede volver a obtener sus píxeles sin conservarlos.
+             */
+            bool can_reload_pixels () const
+            {
+                return (residency == RELOAD_FROM_ASSET && (!asset_path.empty () || pixel_source))
+                    || (residency == KEEP_ENCODED      && !encoded_data.empty ());
+            }
+
+            /**
+             * Vuelve a leer la imagen desde el asset o desde el archivo conservado. Según su formato
+             * se rellena color_buffer o image.
+             */
+            bool reload_pixels (Color_Buffer< Rgba8888 > & color_buffer, Compressed_Image & image) const;
+
+        private:
+
+            static bool decode_asset (const std::string & asset_path, Color_Buffer< Rgba8888 > & color_buffer, Compressed_Image & image, Options & options, std::vector< byte > * encoded_data);
+            static bool decode_file  (const byte * file_data, size_t file_size, Color_Buffer< Rgba8888 > & color_buffer, Compressed_Image * image, Options & options);
+
         };
 
     }
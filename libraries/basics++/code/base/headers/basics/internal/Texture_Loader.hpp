@@ -0,0 +1,223 @@
+/*
+ * TEXTURE LOADER
+ * Copyright © 2018+ Ángel Rodríguez Ballesteros
+ *
+ * Distributed under the Boost Software License, version  1.0
+ * See documents/LICENSE.TXT or www.boost.org/LICENSE_1_0.txt
+ *
+ * angel.rodriguez@esne.edu
+ *
+ * C2610171800
+ */
+
+#ifndef BASICS_TEXTURE_LOADER_HEADER
+#define BASICS_TEXTURE_LOADER_HEADER
+
+    #include <condition_variable>
+    #include <deque>
+    #include <functional>
+    #include <future>
+    #include <memory>
+    #include <mutex>
+    #include <string>
+    #include <thread>
+    #include <vector>
+    #include <basics/Color_Buffer>
+    #include <basics/Compressed_Image>
+    #include <basics/Graphics_Context>
+    #include <basics/Id>
+    #include <basics/Non_Copyable>
+    #include <basics/Texture_2D>
+
+    namespace basics
+    {
+
+        /**
+         * Carga texturas en segundo plano. Un grupo de hilos lee los assets y decodifica las imágenes
+         * mientras el hilo que dibuja solo sube a la GPU las que ya están listas llamando a upload()
+         * en cada fotograma, con un límite de bytes y de tiempo por llamada. Cada carga se puede
+         * esperar con el std::future que devuelve load() o recibir con un callback que se llama
+         * desde upload(), en el hilo del contexto gráfico.
+         * Las tablas de texturas de las escenas se pueden encargar de una vez con load_batch() y
+         * esperar con wait_all(), de modo que la carga dura lo que la decodificación más lenta y no
+         * la suma de todas. Con decode() los hilos también sirven para decodificar imágenes que no
+         * se van a subir tal cual (por ejemplo, las que se juntan en un atlas).
+         * Los hilos solo existen mientras hay algo que decodificar: terminan cuando se vacía la cola y
+         * se vuelven a crear con la siguiente carga, así que las escenas que ya han cargado sus
+         * texturas no mantienen hilos parados.
+         */
+        class Texture_Loader : Non_Copyable
+        {
+        public:
+
+            typedef std::shared_ptr< Texture_2D > Texture_Handle;
+
+            /**
+             * Recibe el id de la textura y la textura ya subida al contexto (vacía si no se pudo cargar).
+             */
+            typedef std::function< void (Id id, const Texture_Handle & texture) > Callback;
+
+            /**
+             * Recibe la fracción (entre 0 y 1) de las texturas encargadas que ya se han entregado.
+             */
+            typedef std::function< void (float progress) > Progress_Callback;
+
+        private:
+
+            struct Job
+            {
+                Id                              id;
+                std::string                     path;
+                Callback                        callback;
+                std::promise< Texture_Handle >  promise;
+                Color_Buffer< Rgba8888 >        color_buffer;
+                Compressed_Image                compressed_image;   ///< Se usa en lugar de color_buffer con los KTX y PKM.
+                Texture_2D::Options             options;
+                std::vector< byte >             encoded_data;
+                bool                            decoded;
+                bool                            pixels_only;        ///< Encargada con decode(): no se sube.
+                std::promise< Color_Buffer< Rgba8888 > > pixels_promise;
+            };
+
+            typedef std::shared_ptr< Job >      Job_Handle;
+            typedef std::deque < Job_Handle >   Job_Queue;
+            typedef std::vector< std::thread >  Worker_List;
+            typedef std::vector< std::thread::id > Worker_Id_List;
+
+        private:
+
+            unsigned                worker_count;
+            Worker_List             workers;
+            unsigned                running_workers;        ///< Hilos que todavía no han terminado.
+            Worker_Id_List          finished_workers;       ///< Hilos terminados pendientes de join().
+
+            std::mutex              mutex;
+            Job_Queue               decode_queue;           ///< Cargas pendientes de leer y decodificar.
+            Job_Queue               upload_queue;           ///< Imágenes decodificadas pendientes de subir.
+            std::condition_variable decoded_condition;      ///< Avisa a wait_all() de que hay imágenes para subir.
+            unsigned                pending;                ///< Cargas que todavía no se han entregado.
+            unsigned                requested;              ///< Cargas encargadas desde que el cargador estaba libre.
+            unsigned                delivered;              ///< Cargas entregadas desde que el cargador estaba libre.
+            bool                    stopping;
+
+            size_t                  upload_byte_budget;
+            float                   upload_time_budget;
+
+        public:
+
+            /**
+             * @param worker_count Número máximo de hilos que decodifican. Con 0 se usa uno menos que
+             *     el número de núcleos (al menos uno). Los hilos se crean al encargar las cargas.
+             */
+            Texture_Loader(unsigned worker_count = 0);
+
+            /**
+             * Espera a que terminen las decodificaciones en curso y cancela las demás. Los future de
+             * las cargas canceladas reciben una textura vacía (y los de decode() una imagen vacía),
+             * pero sus callbacks no se llaman.
+             */
+           ~Texture_Loader();
+
+        public:
+
+            /**
+             * Encola la carga de una textura desde un asset. Se puede llamar desde cualquier hilo.
+             * @param options Solo se tiene en cuenta lo que no sale de la imagen (como la residencia).
+             * @return Future que recibe la textura cuando upload() la sube al contexto.
+             */
+            std::future< Texture_Handle > load (Id id, const std::string & path, Callback callback = nullptr, const Texture_2D::Options & options = {});
+
+            /**
+             * Encola de una vez la carga de todas las texturas de una tabla. Sirve cualquier tipo de
+             * entrada que tenga los campos id y path (como los Texture_Data de las escenas). Todas se
+             * decodifican a la vez repartidas entre los hilos del cargador.
+             */
+            template< class ENTRY >
+            void load_batch (const ENTRY * entries, size_t count, Callback callback = nullptr, const Texture_2D::Options & options = {})
+            {
+                for (size_t index = 0; index < count; ++index)
+                {
+                    load (entries[index].id, entries[index].path, callback, options);
+                }
+            }
+
+            /**
+             * Encola la decodificación de una imagen sin crear ninguna textura. Los KTX y PKM se
+             * decodifican por software. No hace falta llamar a upload() para recibirla ni cuenta como
+             * carga pendiente. Se puede llamar desde cualquier hilo.
+             * @param options Se usan al decodificar (por ejemplo, para premultiplicar el alfa).
+             * @return Future que recibe los píxeles (vacíos si no se pudo leer o decodificar).
+             */
+            std::future< Color_Buffer< Rgba8888 > > decode (const std::string & path, const Texture_2D::Options & options = {});
+
+            /**
+             * Crea y sube al contexto las texturas ya decodificadas hasta agotar el presupuesto.
+             * Siempre se sube al menos una aunque supere el presupuesto por sí sola. Se debe llamar
+             * desde el hilo del contexto gráfico y con el contexto bloqueado.
+             * @return Número de texturas entregadas.
+             */
+            unsigned upload (Graphics_Context::Accessor & context)
+            {
+                return deliver (context, upload_byte_budget, upload_time_budget);
+            }
+
+            /**
+             * Bloquea el hilo hasta que todas las cargas encargadas se han subido al contexto. Las
+             * texturas se suben sin presupuesto conforme se van decodificando, así que la espera
+             * solo dura lo que tarde la decodificación más lenta. Se debe llamar desde el hilo del
+             * contexto gráfico y con el contexto bloqueado.
+             * @param progress Se llama cada vez que se entregan texturas (por ejemplo para una barra de carga).
+             * @return Número de texturas entregadas.
+             */
+            unsigned wait_all (Graphics_Context::Accessor & context, const Progress_Callback & progress = nullptr);
+
+            /**
+             * @param bytes Bytes de píxeles que se pueden subir en cada llamada a upload().
+             * @param seconds Tiempo a partir del cual upload() deja de subir texturas (0 sin límite).
+             */
+            void set_upload_budget (size_t bytes, float seconds)
+            {
+                upload_byte_budget = bytes;
+                upload_time_budget = seconds;
+            }
+
+            /**
+             * @return Número de cargas que todavía no se han entregado.
+             */
+            unsigned get_pending_count ()
+            {
+                std::lock_guard< std::mutex > lock(mutex);
+
+                return pending;
+            }
+
+            bool is_done ()
+            {
+                return get_pending_count () == 0;
+            }
+
+            /**
+             * @return Fracción de las cargas encargadas que ya se han entregado. Se cuenta desde la
+             *     primera carga encargada con el cargador libre, así que vale para una barra de carga
+             *     por escena. Es 1 si no hay nada pendiente.
+             */
+            float get_progress ()
+            {
+                std::lock_guard< std::mutex > lock(mutex);
+
+                return requested ? float(delivered) / float(requested) : 1.f;
+            }
+
+        private:
+
+            unsigned deliver       (Graphics_Context::Accessor & context, size_t byte_budget, float time_budget);
+            void     start_workers ();
+            void     run_worker    ();
+
+            static void cancel (Job & job);
+
+        };
+
+    }
+
+#endif
@@ -0,0 +1,40 @@
+/*
+ * ETC DECODE
+ * Copyright © 2018+ Ángel Rodríguez Ballesteros
+ *
+ * Distributed under the Boost Software License, version  1.0
+ * See documents/LICENSE.TXT or www.boost.org/LICENSE_1_0.txt
+ *
+ * angel.rodriguez@esne.edu
+ *
+ * C2610172001
+ */
+
+#ifndef BASICS_ETC_DECODE_HEADER
+#define BASICS_ETC_DECODE_HEADER
+
+    #include <basics/Color_Buffer>
+    #include <basics/Compressed_Image>
+
+    namespace basics
+    {
+
+        /**
+         * Decodifica por software una imagen ETC1 o ETC2 de width x height píxeles. Los bloques están
+         * en orden de filas de bloques, como los espera glCompressedTexImage2D().
+         * @param alpha_data Plano de alfa de ETC1 (su canal verde es el alfa) o nullptr.
+         * @return false si el formato no es ETC1 ni ETC2.
+         */
+        bool etc_decode
+        (
+            Compressed_Image::Format   format,
+            const byte               * data,
+            const byte               * alpha_data,
+            unsigned                   width,
+            unsigned                   height,
+            Color_Buffer< Rgba8888 > & color_buffer
+        );
+
+    }
+
+#endif
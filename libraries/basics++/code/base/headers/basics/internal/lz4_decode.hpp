@@ -0,0 +1,32 @@
+/*
+ * LZ4 DECODE
+ * Copyright © 2018+ Ángel Rodríguez Ballesteros
+ *
+ * Distributed under the Boost Software License, version  1.0
+ * See documents/LICENSE.TXT or www.boost.org/LICENSE_1_0.txt
+ *
+ * angel.rodriguez@esne.edu
+ *
+ * C2610172323
+ */
+
+#ifndef BASICS_LZ4_DECODE_HEADER
+#define BASICS_LZ4_DECODE_HEADER
+
+    #include <cstddef>
+    #include <basics/types>
+
+    namespace basics
+    {
+
+        /**
+         * Descomprime un bloque en el formato de bloque de LZ4 directamente en target, que debe tener
+         * el tamaño exacto de los datos descomprimidos. Comprueba todos los límites, por lo que unos
+         * datos corruptos no leen ni escriben fuera de los buffers.
+         * @return true si los datos son válidos y ocupan justo target_size bytes.
+         */
+        bool lz4_decode (const byte * source, size_t source_size, byte * target, size_t target_size);
+
+    }
+
+#endif
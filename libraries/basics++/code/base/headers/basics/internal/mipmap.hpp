@@ -0,0 +1,31 @@
+/*
+ * MIPMAP
+ * Copyright © 2018+ Ángel Rodríguez Ballesteros
+ *
+ * Distributed under the Boost Software License, version  1.0
+ * See documents/LICENSE.TXT or www.boost.org/LICENSE_1_0.txt
+ *
+ * angel.rodriguez@esne.edu
+ *
+ * C2610172200
+ */
+
+#ifndef BASICS_MIPMAP_HEADER
+#define BASICS_MIPMAP_HEADER
+
+    #include <basics/Color_Buffer>
+
+    namespace basics
+    {
+
+        /**
+         * Calcula el siguiente nivel de una cadena de mipmaps: cada píxel de target es la media de un
+         * bloque de 2x2 píxeles de source (con SSE2 o NEON si están disponibles). En los lados impares
+         * se descarta la última fila o columna, como hace OpenGL, y ningún lado baja de 1.
+         * @param target Se redimensiona. No puede ser el mismo buffer que source.
+         */
+        void build_mip_level (const Color_Buffer< Rgba8888 > & source, Color_Buffer< Rgba8888 > & target);
+
+    }
+
+#endif
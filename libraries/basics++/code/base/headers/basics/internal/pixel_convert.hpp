@@ -0,0 +1,58 @@
+/*
+ * PIXEL CONVERT
+ * Copyright © 2018+ Ángel Rodríguez Ballesteros
+ *
+ * Distributed under the Boost Software License, version  1.0
+ * See documents/LICENSE.TXT or www.boost.org/LICENSE_1_0.txt
+ *
+ * angel.rodriguez@esne.edu
+ *
+ * C2610172100
+ */
+
+#ifndef BASICS_PIXEL_CONVERT_HEADER
+#define BASICS_PIXEL_CONVERT_HEADER
+
+    #include <basics/Color_Buffer>
+
+    namespace basics
+    {
+
+        /**
+         * Formatos en los que se pueden guardar los píxeles de una textura en la GPU.
+         */
+        enum Pixel_Format
+        {
+            RGBA_8888,                          ///< 4 bytes por píxel (por defecto).
+            RGB_565,                            ///< 2 bytes por píxel, sin alfa.
+            RGBA_4444,                          ///< 2 bytes por píxel.
+            RGBA_5551,                          ///< 2 bytes por píxel, alfa de un bit.
+            ALPHA_8,                            ///< 1 byte por píxel: solo el alfa (el color se toma blanco).
+            LUMINANCE_8,                        ///< 1 byte por píxel: el brillo, opaco.
+        };
+
+        inline unsigned get_bytes_per_pixel (Pixel_Format format)
+        {
+            return format == RGBA_8888 ? 4 : format == ALPHA_8 || format == LUMINANCE_8 ? 1 : 2;
+        }
+
+        /**
+         * Convierte los píxeles RGBA8 de color_buffer al formato indicado (con SSE2 o NEON si están
+         * disponibles). Los formatos de 16 bits se escriben como uint16_t en el orden de bytes de la
+         * plataforma, que es como los espera glTexImage2D().
+         * @param dither Aplica un tramado ordenado de 4x4 al reducir los canales a 4, 5 o 6 bits,
+         *     lo que evita las bandas en los degradados.
+         * @param target Debe tener espacio para width * height * get_bytes_per_pixel(format) bytes.
+         */
+        void convert_pixels (const Color_Buffer< Rgba8888 > & color_buffer, Pixel_Format format, bool dither, byte * target);
+
+        /**
+         * Multiplica el color de cada píxel por su alfa, redondeando al más cercano (con SSE2 o NEON
+         * si están disponibles). El filtrado y la mezcla de píxeles premultiplicados no oscurecen
+         * los bordes de las zonas transparentes.
+         */
+        void premultiply_alpha (Color_Buffer< Rgba8888 > & color_buffer);
+
+    }
+
+#endif
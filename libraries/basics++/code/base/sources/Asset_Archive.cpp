@@ -0,0 +1,472 @@
+/*
+ * ASSET ARCHIVE
+ * Copyright © 2018+ Ángel Rodríguez Ballesteros
+ *
+ * Distributed under the Boost Software License, version  1.0
+ * See documents/LICENSE.TXT or www.boost.org/LICENSE_1_0.txt
+ *
+ * angel.rodriguez@esne.edu
+ *
+ * C2610172312
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <basics/Asset_Archive>
+#include <basics/fnv>
+#include <basics/inflate>
+#include <basics/Log>
+#include <basics/lz4_decode>
+
+namespace basics
+{
+
+    constexpr uint32_t Asset_Archive::magic;
+    constexpr uint32_t Asset_Archive::version;
+    constexpr size_t   Asset_Archive::alignment;
+    constexpr size_t   Asset_Archive::block_size;
+
+    namespace
+    {
+
+        /**
+         * Asset cuyo contenido es un trozo de un archivo proyectado en memoria. Se queda con una
+         * referencia a la proyección para que siga siendo válida aunque se desmonte el archivo.
+         * Si la entrada está comprimida, sus bloques se descomprimen al leerlos.
+         */
+        class Archive_Asset final : public Asset
+        {
+
+            typedef Asset_Archive::Codec Codec;
+
+            const byte             * data;          ///< Datos tal cual están en el archivo.
+            const uint32_t         * block_ends;    ///< Tabla de bloques si la entrada está comprimida.
+            const byte             * blocks;        ///< Primer bloque comprimido.
+            Codec                    codec;
+            size_t                   length;        ///< Tamaño sin comprimir.
+            size_t                   cursor;
+            bool                     failed;
+            bool                     at_end;
+            std::shared_ptr< void >  owner;
+
+            std::vector< byte >      contents;      ///< Contenido descomprimido que devuelve map().
+            std::vector< byte >      block;         ///< Último bloque descomprimido para lecturas parciales.
+            size_t                   block_index;   ///< Índice del bloque que hay en block.
+
+        public:
+
+            Archive_Asset(const byte * data, const Asset_Archive::Entry & entry, const std::shared_ptr< void > & owner)
+            :
+                data       (data                    ),
+                block_ends (nullptr                 ),
+                blocks     (nullptr                 ),
+                codec      (Codec(entry.codec)      ),
+                length     (entry.size              ),
+                cursor     (0                       ),
+                failed     (false                   ),
+                at_end     (false                   ),
+                owner      (owner                   ),
+                block_index(size_t(-1)              )
+            {
+                if (codec != Asset_Archive::STORED)
+                {
+                    block_ends = reinterpret_cast< const uint32_t * >(data);
+                    blocks     = data + get_block_count (length) * sizeof(uint32_t);
+                }
+            }
+
+            static size_t get_block_count (size_t length)
+            {
+                return (length + Asset_Archive::block_size - 1) / Asset_Archive::block_size;
+            }
+
+        public:
+
+            bool   good () const override { return !failed; }
+            bool   fail () const override { return  failed; }
+            bool   eof  () const override { return  at_end; }
+
+            size_t size () const override { return length; }
+            size_t tell () const override { return cursor; }
+
+            bool seek (ptrdiff_t offset, Anchor anchor) override
+            {
+                ptrdiff_t base       = anchor == BEGINNING ? 0 : anchor == END ? ptrdiff_t(length) : ptrdiff_t(cursor);
+                ptrdiff_t new_cursor = base + offset;
+
+                if (new_cursor >= 0 && size_t(new_cursor) <= length)
+                {
+                    cursor = size_t(new_cursor);
+                    at_end = false;
+
+                    return true;
+                }
+
+                return false;
+            }
+
+            byte read () override
+            {
+                byte value = 0;
+
+                read (&value, 1);
+
+                return value;
+            }
+
+            bool read_all (std::vector< byte > & buffer) override
+            {
+                buffer.resize (length);
+
+                return decode_all (buffer.data ());
+            }
+
+            bool read_all (std::string & buffer) override
+            {
+                buffer.resize (length);
+
+                return decode_all (reinterpret_cast< byte * >(&buffer[0]));
+            }
+
+            size_t read (byte * buffer, size_t size) override
+            {
+                size_t count = failed ? 0 : std::min (size, length - cursor);
+
+                if (codec == Asset_Archive::STORED)
+                {
+                    if (count > 0) std::memcpy (buffer, data + cursor, count);
+                }
+                else
+                {
+                    count = read_blocks (buffer, count);
+                }
+
+                cursor += count;
+
+                if (count < size) at_end = true;
+
+                return count;
+            }
+
+            Span map () override
+            {
+                if (codec == Asset_Archive::STORED)
+                {
+                    return { data, length };
+                }
+
+                // El contenido descomprimido se guarda para que la vista siga siendo válida:
+
+                if (contents.size () != length)
+                {
+                    contents.resize (length);
+
+                    if (!decode_all (contents.data ()))
+                    {
+                        contents.clear ();
+
+                        return { nullptr, 0 };
+                    }
+                }
+
+                return { contents.data (), length };
+            }
+
+        private:
+
+            bool decode_all (byte * target)
+            {
+                if (failed) return false;
+
+                if (codec == Asset_Archive::STORED)
+                {
+                    if (length > 0) std::memcpy (target, data, length);
+
+                    return true;
+                }
+
+                for (size_t index = 0, count = get_block_count (length); index < count; ++index)
+                {
+                    if (!decode_block (index, target + index * Asset_Archive::block_size))
+                    {
+                        failed = true;
+
+                        return false;
+                    }
+                }
+
+                return true;
+            }
+
+            /**
+             * Lee count bytes a partir del cursor. Los bloques que se leen enteros se descomprimen
+             * directamente en el destino y el resto pasa por el buffer de un bloque.
+             */
+            size_t read_blocks (byte * target, size_t count)
+            {
+                size_t done = 0;
+
+                while (done < count)
+                {
+                    size_t position     = cursor + done;
+                    size_t index        = position / Asset_Archive::block_size;
+                    size_t block_offset = position % Asset_Archive::block_size;
+                    size_t block_length = get_block_length (index);
+                    size_t chunk        = std::min (block_length - block_offset, count - done);
+
+                    if (block_offset == 0 && chunk == block_length)
+                    {
+                        if (!decode_block (index, target + done)) break;
+                    }
+                    else
+                    {
+                        if (block_index != index)
+                        {
+                            block.resize (Asset_Archive::block_size);
+
+                            if (!decode_block (index, block.data ())) break;
+
+                            block_index = index;
+                        }
+
+                        std::memcpy (target + done, block.data () + block_offset, chunk);
+                    }
+
+                    done += chunk;
+                }
+
+                if (done < count) failed = true;
+
+                return done;
+            }
+
+            size_t get_block_length (size_t index) const
+            {
+                return std::min (Asset_Archive::block_size, length - index * Asset_Archive::block_size);
+            }
+
+            bool decode_block (size_t index, byte * target)
+            {
+                size_t       begin        = index > 0 ? block_ends[index - 1] : 0;
+                size_t       stored_size  = block_ends[index] - begin;
+                size_t       block_length = get_block_length (index);
+                const byte * source       = blocks + begin;
+
+                if (stored_size == block_length)
+                {
+                    std::memcpy (target, source, block_length);
+
+                    return true;
+                }
+
+                return codec == Asset_Archive::LZ4
+                     ? lz4_decode (source, stored_size, target, block_length)
+                     : inflate    (source, stored_size, target, block_length);
+            }
+
+        };
+
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    Asset_Archive::Asset_Archive(const Mapping & mapping)
+    :
+        mapping(mapping),
+        header (reinterpret_cast< const Header * >(mapping.data)),
+        entries(reinterpret_cast< const Entry  * >(mapping.data + sizeof(Header)))
+    {
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    bool Asset_Archive::mount (const std::string & archive_path)
+    {
+        Mapping mapping;
+
+        if (!map (archive_path, mapping))
+        {
+            log.e (std::string("ERROR: failed to map the asset archive ") + archive_path);
+
+            return false;
+        }
+
+        Archive_Handle archive(new Asset_Archive(mapping));
+
+        if (!archive->is_valid ())
+        {
+            log.e (std::string("ERROR: invalid asset archive ") + archive_path);
+
+            return false;
+        }
+
+        get_mounted ().push_back (archive);
+
+        return true;
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    void Asset_Archive::unmount_all ()
+    {
+        get_mounted ().clear ();
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    std::shared_ptr< Asset > Asset_Archive::open (const std::string & path)
+    {
+        Archive_Handle archive;
+        const Entry  * entry = find_entry (path, &archive);
+
+        if (entry)
+        {
+            return std::shared_ptr< Asset >
+            (
+                new Archive_Asset(archive->mapping.data + entry->offset, *entry, archive->mapping.owner)
+            );
+        }
+
+        return nullptr;
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    bool Asset_Archive::exists (const std::string & path)
+    {
+        return find_entry (path) != nullptr;
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    size_t Asset_Archive::size (const std::string & path)
+    {
+        const Entry * entry = find_entry (path);
+
+        return entry ? entry->size : 0;
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    Asset_Archive::Archive_List & Asset_Archive::get_mounted ()
+    {
+        static Archive_List mounted;
+
+        return mounted;
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    const Asset_Archive::Entry * Asset_Archive::find_entry (const std::string & path, Archive_Handle * archive)
+    {
+        Archive_List & mounted = get_mounted ();
+
+        if (mounted.empty ()) return nullptr;
+
+        uint32_t hash = fnv32 (path);
+
+        // Se busca desde el último archivo montado para que sus entradas tengan prioridad:
+
+        for (auto i = mounted.rbegin (); i != mounted.rend (); ++i)
+        {
+            const Entry * entry = (*i)->find (path, hash);
+
+            if (entry)
+            {
+                if (archive) *archive = *i;
+
+                return entry;
+            }
+        }
+
+        return nullptr;
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    bool Asset_Archive::is_valid () const
+    {
+        // Se comprueba todo lo que luego se usa sin comprobar, de modo que un archivo truncado o
+        // corrupto se rechaza al montarlo en lugar de provocar lecturas fuera de la proyección:
+
+        if (mapping.size < sizeof(Header)) return false;
+
+        if (header->magic != magic || header->version != version) return false;
+
+        size_t index_end = sizeof(Header) + size_t(header->entry_count) * sizeof(Entry);
+
+        if (index_end > mapping.size || header->names_offset < index_end || header->names_offset > mapping.size)
+        {
+            return false;
+        }
+
+        const char * names = reinterpret_cast< const char * >(mapping.data);
+
+        for (uint32_t index = 0; index < header->entry_count; ++index)
+        {
+            const Entry & entry = entries[index];
+
+            if (entry.name_offset < header->names_offset || entry.name_offset >= mapping.size) return false;
+            if (entry.offset % alignment != 0 || entry.stored_size > mapping.size) return false;
+            if (entry.offset > mapping.size - entry.stored_size) return false;
+
+            if (entry.codec == STORED)
+            {
+                if (entry.stored_size != entry.size) return false;
+            }
+            else
+            if (entry.codec == LZ4 || entry.codec == DEFLATE)
+            {
+                // Los bloques tienen que acabar en orden dentro de los datos de la entrada y ninguno
+                // puede ocupar más que sin comprimir:
+
+                size_t           block_count = (size_t(entry.size) + block_size - 1) / block_size;
+                size_t           table_size  = block_count * sizeof(uint32_t);
+                const uint32_t * block_ends  = reinterpret_cast< const uint32_t * >(mapping.data + entry.offset);
+
+                if (table_size > entry.stored_size) return false;
+
+                for (size_t block = 0, begin = 0; block < block_count; begin = block_ends[block++])
+                {
+                    size_t block_length = std::min (block_size, size_t(entry.size) - block * block_size);
+
+                    if (block_ends[block] < begin || block_ends[block] - begin > block_length) return false;
+
+                    if (block_ends[block] > entry.stored_size - table_size) return false;
+                }
+            }
+            else
+                return false;
+
+            if (!std::memchr (names + entry.name_offset, 0, mapping.size - entry.name_offset)) return false;
+
+            if (index > 0 && entries[index - 1].hash > entry.hash) return false;
+        }
+
+        return true;
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    const Asset_Archive::Entry * Asset_Archive::find (const std::string & path, uint32_t hash) const
+    {
+        const Entry * end   = entries + header->entry_count;
+        const Entry * entry = std::lower_bound
+        (
+            entries, end, hash, [] (const Entry & entry, uint32_t hash) { return entry.hash < hash; }
+        );
+
+        // Las entradas con el mismo hash están seguidas y se distinguen por su ruta:
+
+        for ( ; entry != end && entry->hash == hash; ++entry)
+        {
+            if (path == reinterpret_cast< const char * >(mapping.data + entry->name_offset))
+            {
+                return entry;
+            }
+        }
+
+        return nullptr;
+    }
+
+}
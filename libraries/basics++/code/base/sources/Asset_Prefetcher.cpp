@@ -0,0 +1,278 @@
+/*
+ * ASSET PREFETCHER
+ * Copyright © 2018+ Ángel Rodríguez Ballesteros
+ *
+ * Distributed under the Boost Software License, version  1.0
+ * See documents/LICENSE.TXT or www.boost.org/LICENSE_1_0.txt
+ *
+ * angel.rodriguez@esne.edu
+ *
+ * C2610172326
+ */
+
+#include <algorithm>
+#include <basics/Asset>
+#include <basics/Asset_Prefetcher>
+
+namespace basics
+{
+
+    Asset_Prefetcher & Asset_Prefetcher::get_instance ()
+    {
+        static Asset_Prefetcher instance;
+
+        return instance;
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    Asset_Prefetcher::Asset_Prefetcher()
+    :
+        memory_budget(32 * 1024 * 1024),
+        memory_used  (0),
+        stopping     (false)
+    {
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    Asset_Prefetcher::~Asset_Prefetcher()
+    {
+        stop ();
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    void Asset_Prefetcher::stop ()
+    {
+        std::thread stopped_worker;
+
+        {
+            std::lock_guard< std::mutex > lock(mutex);
+
+            stopping = true;
+
+            stopped_worker.swap (worker);
+        }
+
+        condition.notify_all ();
+
+        // El hilo termina lo que está preparando antes de salir. Mientras tanto prefetch() no crea
+        // otro (stopping sigue activo):
+
+        if (stopped_worker.joinable ()) stopped_worker.join ();
+
+        std::lock_guard< std::mutex > lock(mutex);
+
+        entries.clear ();
+        queue.clear   ();
+
+        memory_used = 0;
+        stopping    = false;
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    void Asset_Prefetcher::prefetch (const Request_List & requests)
+    {
+        {
+            std::lock_guard< std::mutex > lock(mutex);
+
+            // Se descartan las entradas que ya no se esperan. Las que se están decodificando las
+            // termina el hilo y después las descarta al no encontrarlas en el mapa:
+
+            Entry_Map previous;
+
+            previous.swap (entries);
+            queue.clear   ();
+
+            memory_used = 0;
+
+            for (auto & request : requests)
+            {
+                if (entries.count (request.path)) continue;
+
+                auto found = previous.find (request.path);
+
+                if (found != previous.end () && found->second->request.texture == request.texture)
+                {
+                    Entry_Handle & entry = entries[request.path] = found->second;
+
+                    memory_used += entry->bytes;
+
+                    if (entry->state == QUEUED) queue.push_back (request.path);
+                }
+                else
+                {
+                    Entry_Handle & entry = entries[request.path] = std::make_shared< Entry > ();
+
+                    entry->request = request;
+                    entry->state   = QUEUED;
+                    entry->bytes   = 0;
+
+                    queue.push_back (request.path);
+                }
+            }
+
+            if (!queue.empty () && !worker.joinable () && !stopping)
+            {
+                worker = std::thread(&Asset_Prefetcher::run_worker, this);
+            }
+        }
+
+        condition.notify_all ();
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    bool Asset_Prefetcher::take (const std::string & path, Color_Buffer< Rgba8888 > & color_buffer, Compressed_Image & image, Texture_2D::Options & options)
+    {
+        std::unique_lock< std::mutex > lock(mutex);
+
+        auto found = entries.find (path);
+
+        if (found == entries.end ()) return false;
+
+        Entry_Handle entry = found->second;
+
+        if (!entry->request.texture) return false;
+
+        // Si el hilo ni siquiera ha empezado con ella es mejor decodificarla en el hilo que la pide:
+
+        if (entry->state == QUEUED)
+        {
+            entries.erase (found);
+            queue.erase   (std::remove (queue.begin (), queue.end (), path), queue.end ());
+
+            return false;
+        }
+
+        decoded_condition.wait (lock, [&entry] () { return entry->state != DECODING; });
+
+        // Puede que mientras se esperaba se haya sustituido la predicción y la entrada se haya
+        // descartado (sin contar en memory_used):
+
+        found = entries.find (path);
+
+        if (found == entries.end () || found->second != entry) return false;
+
+        entries.erase (found);
+
+        memory_used -= std::min (memory_used, entry->bytes);
+
+        if (entry->state != READY || entry->bytes == 0) return false;
+
+        // Los píxeles solo sirven si se premultiplicaron igual que se pide ahora (las imágenes
+        // comprimidas nunca se premultiplican al leerlas):
+
+        if (entry->image.empty () && Texture_2D::premultiplies (entry->request.options) != Texture_2D::premultiplies (options))
+        {
+            return false;
+        }
+
+        color_buffer = std::move (entry->color_buffer);
+        image        = std::move (entry->image);
+
+        options.width  = entry->request.options.width;
+        options.height = entry->request.options.height;
+        options.opaque = entry->request.options.opaque;
+
+        return true;
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    void Asset_Prefetcher::run_worker ()
+    {
+        for (;;)
+        {
+            Entry_Handle entry;
+            bool         decode;
+
+            {
+                std::unique_lock< std::mutex > lock(mutex);
+
+                condition.wait (lock, [this] () { return stopping || !queue.empty (); });
+
+                if (stopping) return;
+
+                entry = entries[queue.front ()];
+
+                queue.pop_front ();
+
+                entry->state = DECODING;
+
+                // Mientras quede presupuesto las texturas se decodifican. Después solo se leen:
+
+                decode = entry->request.texture && memory_used < memory_budget;
+            }
+
+            // Mientras la entrada está en DECODING sus píxeles solo los toca este hilo:
+
+            size_t bytes = prepare (*entry, decode);
+
+            {
+                std::lock_guard< std::mutex > lock(mutex);
+
+                entry->bytes = bytes;
+                entry->state = bytes > 0 || !decode ? READY : FAILED;
+
+                // Si la entrada se ha descartado mientras se preparaba no cuenta para el presupuesto:
+
+                auto found = entries.find (entry->request.path);
+
+                if (found != entries.end () && found->second == entry)
+                {
+                    memory_used += entry->bytes;
+                }
+                else
+                {
+                    entry->color_buffer = Color_Buffer< Rgba8888 >();
+                    entry->image.clear ();
+
+                    entry->bytes = 0;
+                    entry->state = FAILED;
+                }
+            }
+
+            decoded_condition.notify_all ();
+        }
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    size_t Asset_Prefetcher::prepare (Entry & entry, bool decode)
+    {
+        if (decode)
+        {
+            if (Texture_2D::decode_asset (entry.request.path, entry.color_buffer, entry.image, entry.request.options, nullptr))
+            {
+                return entry.image.empty ()
+                     ? size_t(entry.color_buffer.get_width ()) * entry.color_buffer.get_height () * sizeof(Rgba8888)
+                     : entry.image.get_data ().size () + entry.image.get_alpha_data ().size ();
+            }
+
+            return 0;
+        }
+
+        // Para que el sistema cargue el archivo en su caché basta con tocar un byte de cada página
+        // (con AAsset_getBuffer() y con mmap() el contenido no se lee hasta que se accede a él):
+
+        std::shared_ptr< Asset > asset = Asset::open (entry.request.path);
+
+        if (asset)
+        {
+            Asset::Span data = asset->map ();
+
+            volatile byte sum = 0;
+
+            for (size_t offset = 0; data.data && offset < data.size; offset += 4096)
+            {
+                sum ^= data.data[offset];
+            }
+        }
+
+        return 0;
+    }
+
+}
@@ -27,11 +27,11 @@ namespace basics
     {
         shared_ptr< Asset > slices_file = Asset::open (path);
 
-        if (slices_file->good ())
+        if (slices_file)
         {
-            Buffer slices_data;
+            Asset::Span slices_data = slices_file->map ();
 
-            if (slices_file->read_all (slices_data))
+            if (slices_data.data)
             {
                 parse (slices_data, path, context);
             }
@@ -69,11 +69,16 @@ namespace basics
 
     // ---------------------------------------------------------------------------------------------
 
-    void Atlas::parse (Buffer & slices_data, const std::string & path, Graphics_Context::Accessor & context)
+    void Atlas::parse (const Asset::Span & slices_file, const std::string & path, Graphics_Context::Accessor & context)
     {
-        // Se pone un caracter nulo al final para que el parseador de rapidxml sepa dónde está el
-        // final de los datos:
+        // rapidxml parsea el texto modificándolo y necesita un caracter nulo al final para saber
+        // dónde acaban los datos, así que se copia una sola vez a un buffer que ya tiene sitio
+        // para él:
 
+        Buffer slices_data;
+
+        slices_data.reserve   (slices_file.size + 1);
+        slices_data.assign    (slices_file.begin (), slices_file.end ());
         slices_data.push_back (0);
 
         // Se parsea el xml de datos de slices:
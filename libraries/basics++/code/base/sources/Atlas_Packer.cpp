@@ -0,0 +1,484 @@
+/*
+ * ATLAS PACKER
+ * Copyright © 2018+ Ángel Rodríguez Ballesteros
+ *
+ * Distributed under the Boost Software License, version  1.0
+ * See documents/LICENSE.TXT or www.boost.org/LICENSE_1_0.txt
+ *
+ * angel.rodriguez@esne.edu
+ *
+ * C2610172310
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <basics/Atlas_Packer>
+#include <basics/Log>
+
+namespace basics
+{
+
+    namespace
+    {
+
+        unsigned next_power_of_two (unsigned value)
+        {
+            unsigned result = 1;
+
+            while (result < value) result <<= 1;
+
+            return result;
+        }
+
+        /**
+         * Perfil superior de lo que ya se ha colocado en una página: una lista de tramos horizontales
+         * contiguos que cubren todo el ancho, cada uno con la altura hasta la que está ocupado.
+         */
+        class Skyline
+        {
+            struct Node
+            {
+                unsigned x;
+                unsigned y;
+                unsigned width;
+            };
+
+            std::vector< Node > nodes;
+            unsigned            width;
+            unsigned            max_height;
+            unsigned            used_height;
+
+        public:
+
+            Skyline(unsigned width, unsigned max_height)
+            :
+                nodes      (1, Node{ 0, 0, width }),
+                width      (width),
+                max_height (max_height),
+                used_height(0)
+            {
+            }
+
+            unsigned get_used_height () const
+            {
+                return used_height;
+            }
+
+            /**
+             * Busca la posición más baja en la que cabe un rectángulo y lo coloca en ella. Con varias
+             * igual de bajas se elige la que está sobre el tramo más estrecho, que desperdicia menos.
+             */
+            bool insert (unsigned rectangle_width, unsigned rectangle_height, unsigned & x, unsigned & y)
+            {
+                size_t   best_node  = nodes.size ();
+                unsigned best_top   = UINT_MAX;
+                unsigned best_width = UINT_MAX;
+
+                for (size_t index = 0; index < nodes.size (); ++index)
+                {
+                    unsigned top;
+
+                    if (fits (index, rectangle_width, rectangle_height, top))
+                    {
+                        if (top < best_top || (top == best_top && nodes[index].width < best_width))
+                        {
+                            best_node  = index;
+                            best_top   = top;
+                            best_width = nodes[index].width;
+                        }
+                    }
+                }
+
+                if (best_node == nodes.size ()) return false;
+
+                x = nodes[best_node].x;
+                y = best_top - rectangle_height;
+
+                // El rectángulo pasa a ser un tramo nuevo y recorta o elimina los que quedan debajo:
+
+                Node added = { x, best_top, rectangle_width };
+
+                nodes.insert (nodes.begin () + best_node, added);
+
+                for (size_t index = best_node + 1; index < nodes.size (); )
+                {
+                    Node   & node    = nodes[index];
+                    unsigned covered = added.x + added.width;
+
+                    if (node.x >= covered) break;
+
+                    if (node.x + node.width <= covered)
+                    {
+                        nodes.erase (nodes.begin () + index);
+                    }
+                    else
+                    {
+                        node.width -= covered - node.x;
+                        node.x      = covered;
+                        break;
+                    }
+                }
+
+                // Los tramos vecinos a la misma altura se unen:
+
+                for (size_t index = 0; index + 1 < nodes.size (); )
+                {
+                    if (nodes[index].y == nodes[index + 1].y)
+                    {
+                        nodes[index].width += nodes[index + 1].width;
+                        nodes.erase (nodes.begin () + index + 1);
+                    }
+                    else
+                        ++index;
+                }
+
+                used_height = std::max (used_height, best_top);
+
+                return true;
+            }
+
+        private:
+
+            /**
+             * Comprueba si el rectángulo cabe empezando en el tramo indicado. Se apoya sobre el más alto
+             * de los tramos que cubre.
+             */
+            bool fits (size_t first_node, unsigned rectangle_width, unsigned rectangle_height, unsigned & top) const
+            {
+                if (nodes[first_node].x + rectangle_width > width) return false;
+
+                unsigned bottom    = 0;
+                unsigned remaining = rectangle_width;
+
+                for (size_t index = first_node; remaining > 0; ++index)
+                {
+                    bottom     = std::max (bottom, nodes[index].y);
+                    remaining -= std::min (remaining, nodes[index].width);
+                }
+
+                if (bottom + rectangle_height > max_height) return false;
+
+                top = bottom + rectangle_height;
+
+                return true;
+            }
+
+        };
+
+        /**
+         * Copia una imagen en la página y rellena el margen que la rodea repitiendo sus bordes.
+         * @param x, y Esquina superior izquierda del margen.
+         */
+        void blit (const Color_Buffer< Rgba8888 > & image, Color_Buffer< Rgba8888 > & page, unsigned x, unsigned y, unsigned padding)
+        {
+            int width  = int(image.get_width  ());
+            int height = int(image.get_height ());
+
+            for (int row = -int(padding); row < height + int(padding); ++row)
+            {
+                const Rgba8888 * source = &image[unsigned(std::min (std::max (row, 0), height - 1) * width)];
+                Rgba8888       * target = &page [(y + padding + row) * page.get_width () + x];
+
+                std::fill_n (target,                   padding, source[0]        );
+                std::memcpy (target + padding, source, width * sizeof(Rgba8888)  );
+                std::fill_n (target + padding + width, padding, source[width - 1]);
+            }
+        }
+
+        /**
+         * Lo necesario para volver a componer una página a partir de los assets de sus imágenes.
+         */
+        struct Page_Layout
+        {
+            struct Placed_Image
+            {
+                std::string asset_path;
+                unsigned    x, y;
+                unsigned    width, height;      ///< Tamaño de la imagen cuando se colocó.
+            };
+
+            unsigned                    width;
+            unsigned                    height;
+            unsigned                    padding;
+            Texture_2D::Options         options;        ///< Opciones con las que se decodificaron las imágenes.
+            std::vector< Placed_Image > images;
+        };
+
+        bool compose_page (const Page_Layout & layout, Color_Buffer< Rgba8888 > & page)
+        {
+            page = Color_Buffer< Rgba8888 >(layout.width, layout.height);
+
+            for (const auto & placed : layout.images)
+            {
+                Color_Buffer< Rgba8888 > pixels;
+                Texture_2D::Options      options = layout.options;
+
+                // Si el asset ha cambiado de tamaño ya no cabe en su hueco:
+
+                if (!Texture_2D::decode (placed.asset_path, pixels, options) || pixels.get_width () != placed.width || pixels.get_height () != placed.height)
+                {
+                    log.e (std::string("ERROR: the atlas packer could not decode ") + placed.asset_path);
+
+                    return false;
+                }
+
+                blit (pixels, page, placed.x, placed.y, layout.padding);
+            }
+
+            return true;
+        }
+
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    Atlas_Packer::Atlas_Packer(const Texture_2D::Options & options, unsigned max_page_size, unsigned padding)
+    :
+        options      (options),
+        max_page_size(max_page_size),
+        padding      (padding)
+    {
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    bool Atlas_Packer::add (Id id, const std::string & asset_path)
+    {
+        Color_Buffer< Rgba8888 > pixels;
+        Texture_2D::Options      decoded_options = options;
+
+        if (Texture_2D::decode (asset_path, pixels, decoded_options) && pixels.size () > 0)
+        {
+            images.push_back (Image{ id, asset_path, std::move (pixels), {} });
+
+            return true;
+        }
+
+        log.e (std::string("ERROR: the atlas packer could not decode ") + asset_path);
+
+        return false;
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    void Atlas_Packer::add (Texture_Loader & loader, Id id, const std::string & asset_path)
+    {
+        images.push_back (Image{ id, asset_path, {}, loader.decode (asset_path, options) });
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    void Atlas_Packer::add (Id id, Color_Buffer< Rgba8888 > && pixels)
+    {
+        images.push_back (Image{ id, std::string(), std::move (pixels), {} });
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    bool Atlas_Packer::is_ready () const
+    {
+        for (const Image & image : images)
+        {
+            if (image.decoding.valid () && image.decoding.wait_for (std::chrono::seconds(0)) != std::future_status::ready)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    Atlas_Packer::Atlas_List Atlas_Packer::pack (Graphics_Context::Accessor & context)
+    {
+        Atlas_List atlases;
+
+        // Se recogen las imágenes que se encargaron a un Texture_Loader:
+
+        bool decoded = true;
+
+        for (Image & image : images)
+        {
+            if (image.decoding.valid ())
+            {
+                image.pixels = image.decoding.get ();
+
+                if (image.pixels.size () == 0)
+                {
+                    log.e (std::string("ERROR: the atlas packer could not decode ") + image.asset_path);
+
+                    decoded = false;
+                }
+            }
+        }
+
+        if (!decoded) images.clear ();
+
+        if (images.empty ()) return atlases;
+
+        // Las imágenes se colocan de más alta a más baja, que es el orden en el que el perfil de
+        // cada página queda más regular:
+
+        std::vector< size_t > order(images.size ());
+
+        for (size_t index = 0; index < order.size (); ++index) order[index] = index;
+
+        std::sort
+        (
+            order.begin (),
+            order.end   (),
+            [this] (size_t a, size_t b)
+            {
+                const Color_Buffer< Rgba8888 > & pixels_a = images[a].pixels;
+                const Color_Buffer< Rgba8888 > & pixels_b = images[b].pixels;
+
+                if (pixels_a.get_height () != pixels_b.get_height ()) return pixels_a.get_height () > pixels_b.get_height ();
+
+                return pixels_a.get_width () > pixels_b.get_width ();
+            }
+        );
+
+        // El ancho de las páginas es la potencia de 2 con la que todo cabría en un cuadrado, sin
+        // bajar del ancho de la imagen más ancha ni pasar del máximo:
+
+        double   total_area = 0.0;
+        unsigned max_width  = 0;
+
+        for (const Image & image : images)
+        {
+            total_area += double(image.pixels.get_width () + padding * 2) * double(image.pixels.get_height () + padding * 2);
+            max_width   = std::max (max_width, image.pixels.get_width () + padding * 2);
+        }
+
+        unsigned page_width = next_power_of_two (unsigned(std::ceil (std::sqrt (total_area))));
+
+        page_width = std::min (std::max (page_width, next_power_of_two (max_width)), max_page_size);
+
+        // Cada imagen va en la primera página en la que cabe. Si no cabe en ninguna se abre otra:
+
+        struct Placement
+        {
+            size_t   page;
+            unsigned x, y;
+        };
+
+        std::vector< Skyline   > pages;
+        std::vector< Placement > placements(images.size (), Placement{ size_t(-1), 0, 0 });
+
+        for (size_t index : order)
+        {
+            const Color_Buffer< Rgba8888 > & pixels = images[index].pixels;
+            unsigned width  = pixels.get_width  () + padding * 2;
+            unsigned height = pixels.get_height () + padding * 2;
+
+            if (width > page_width || height > max_page_size)
+            {
+                log.e ("ERROR: an image does not fit in an atlas page.");
+                continue;
+            }
+
+            Placement & placement = placements[index];
+
+            for (size_t page = 0; page < pages.size () && placement.page == size_t(-1); ++page)
+            {
+                if (pages[page].insert (width, height, placement.x, placement.y)) placement.page = page;
+            }
+
+            if (placement.page == size_t(-1))
+            {
+                pages.emplace_back (page_width, max_page_size);
+                pages.back ().insert (width, height, placement.x, placement.y);
+
+                placement.page = pages.size () - 1;
+            }
+        }
+
+        // Se copian las imágenes en las páginas, que solo miden de alto lo que ocupan (redondeado
+        // a una potencia de 2 para que admitan mipmaps), y se crean sus texturas:
+
+        Texture_2D::Options page_options = options;
+
+        page_options.opaque = false;
+
+        for (size_t page = 0; page < pages.size (); ++page)
+        {
+            Color_Buffer< Rgba8888 > page_pixels(page_width, std::min (next_power_of_two (pages[page].get_used_height ()), max_page_size));
+
+            for (size_t index = 0; index < images.size (); ++index)
+            {
+                if (placements[index].page == page)
+                {
+                    blit (images[index].pixels, page_pixels, placements[index].x, placements[index].y, padding);
+                }
+            }
+
+            page_options.width  = page_pixels.get_width  ();
+            page_options.height = page_pixels.get_height ();
+
+            // Una página solo puede regenerarse si todas sus imágenes salen de assets. Se guarda
+            // dónde va cada una para volver a componerla igual:
+
+            Page_Layout layout{ page_pixels.get_width (), page_pixels.get_height (), padding, options, {} };
+            bool        reloadable = options.residency != Texture_2D::KEEP_PIXELS;
+
+            for (size_t index = 0; index < images.size () && reloadable; ++index)
+            {
+                if (placements[index].page == page)
+                {
+                    reloadable = !images[index].asset_path.empty ();
+
+                    const Color_Buffer< Rgba8888 > & pixels = images[index].pixels;
+
+                    layout.images.push_back ({ images[index].asset_path, placements[index].x, placements[index].y, pixels.get_width (), pixels.get_height () });
+                }
+            }
+
+            page_options.residency = reloadable ? Texture_2D::RELOAD_FROM_ASSET : Texture_2D::KEEP_PIXELS;
+
+            std::shared_ptr< Texture_2D > texture = Texture_2D::create (0, context, page_pixels, page_options);
+
+            if (!texture) continue;
+
+            if (reloadable)
+            {
+                texture->set_pixel_source
+                (
+                    [layout] (Color_Buffer< Rgba8888 > & pixels)
+                    {
+                        return compose_page (layout, pixels);
+                    }
+                );
+            }
+
+            context->add (texture);
+
+            Atlas_Handle atlas(new Atlas(texture));
+
+            for (size_t index = 0; index < images.size (); ++index)
+            {
+                if (placements[index].page == page)
+                {
+                    const Color_Buffer< Rgba8888 > & pixels = images[index].pixels;
+
+                    atlas->add_slice
+                    (
+                        images[index].id,
+                        { float(placements[index].x + padding), float(placements[index].y + padding) },
+                        { float(pixels.get_width ()),           float(pixels.get_height ())          }
+                    );
+                }
+            }
+
+            atlases.push_back (atlas);
+        }
+
+        images.clear ();
+
+        return atlases;
+    }
+
+}
@@ -15,6 +15,8 @@
 namespace basics
 {
 
+    constexpr Id    Canvas::type_id;
+
     Id              Canvas::canvas_specialization_ids      [10];
     Canvas::Factory Canvas::canvas_specialization_factories[10];
     size_t          Canvas::canvas_specialization_count = 0;
@@ -34,10 +36,8 @@ namespace basics
         return nullptr;
     }
 
-    void Canvas::draw_text (const Point2f & where, const Text_Layout & text_layout, int handling)
+    Point2f Canvas::get_text_top_left (const Point2f & where, const Text_Layout & text_layout, int handling)
     {
-        const Text_Layout::Glyph_List & glyphs = text_layout.get_glyphs ();
-
         float width  = text_layout.get_width  ();
         float height = text_layout.get_height ();
         float left   = where[0];
@@ -57,7 +57,16 @@ namespace basics
             default:     break;
         }
 
-        for (auto & glyph : glyphs)
+        return { left, top };
+    }
+
+    void Canvas::draw_text (const Point2f & where, const Text_Layout & text_layout, int handling)
+    {
+        Point2f top_left = get_text_top_left (where, text_layout, handling);
+        float   left     = top_left[0];
+        float   top      = top_left[1];
+
+        for (auto & glyph : text_layout.get_glyphs ())
         {
             fill_rectangle
             (
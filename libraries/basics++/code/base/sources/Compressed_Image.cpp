@@ -0,0 +1,226 @@
+/*
+ * COMPRESSED IMAGE
+ * Copyright © 2018+ Ángel Rodríguez Ballesteros
+ *
+ * Distributed under the Boost Software License, version  1.0
+ * See documents/LICENSE.TXT or www.boost.org/LICENSE_1_0.txt
+ *
+ * angel.rodriguez@esne.edu
+ *
+ * C2610172010
+ */
+
+#include <cstdint>
+#include <cstring>
+#include <basics/Compressed_Image>
+#include <basics/etc_decode>
+
+namespace basics
+{
+
+    namespace
+    {
+
+        const byte ktx_identifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n' };
+        const byte pkm_identifier[ 4] = { 'P', 'K', 'M', ' ' };
+
+        const size_t ktx_header_size = 64;
+        const size_t pkm_header_size = 16;
+
+        // Valores de glInternalFormat de los formatos soportados (los mismos enums de OpenGL ES):
+
+        const uint32_t ktx_etc1_rgb8       = 0x8D64;
+        const uint32_t ktx_etc2_rgb8       = 0x9274;
+        const uint32_t ktx_etc2_rgb8_a1    = 0x9276;
+        const uint32_t ktx_etc2_rgba8      = 0x9278;
+        const uint32_t ktx_astc_first      = 0x93B0;
+        const uint32_t ktx_astc_last       = 0x93BD;
+
+        // Tamaños de bloque de ASTC en el orden de sus enums (de 4x4 a 12x12):
+
+        const unsigned astc_block_sizes[14][2] =
+        {
+            {  4, 4 }, {  5, 4 }, {  5,  5 }, {  6,  5 }, {  6, 6 }, { 8, 5 }, { 8, 6 },
+            {  8, 8 }, { 10, 5 }, { 10,  6 }, { 10,  8 }, { 10, 10 }, { 12, 10 }, { 12, 12 },
+        };
+
+        // Tipos de imagen de la cabecera de PKM:
+
+        enum Pkm_Type
+        {
+            PKM_ETC1_RGB    = 0,
+            PKM_ETC2_RGB    = 1,
+            PKM_ETC2_RGBA   = 3,
+            PKM_ETC2_RGB_A1 = 4,
+        };
+
+        inline uint32_t read_32 (const byte * data, bool swap)
+        {
+            uint32_t value;
+
+            std::memcpy (&value, data, sizeof(value));
+
+            if (swap)
+            {
+                value = (value >> 24) | ((value >> 8) & 0xFF00) | ((value << 8) & 0xFF0000) | (value << 24);
+            }
+
+            return value;
+        }
+
+        inline unsigned read_16_big_endian (const byte * data)
+        {
+            return (unsigned(data[0]) << 8) | data[1];
+        }
+
+    }
+
+    bool Compressed_Image::is_compressed (const byte * file_data, size_t size)
+    {
+        return (size >= ktx_header_size && std::memcmp (file_data, ktx_identifier, sizeof(ktx_identifier)) == 0)
+            || (size >= pkm_header_size && std::memcmp (file_data, pkm_identifier, sizeof(pkm_identifier)) == 0);
+    }
+
+    bool Compressed_Image::load (const byte * file_data, size_t size)
+    {
+        clear ();
+
+        bool loaded = size >= ktx_header_size && std::memcmp (file_data, ktx_identifier, sizeof(ktx_identifier)) == 0
+                    ? load_ktx (file_data, size)
+                    : load_pkm (file_data, size);
+
+        if (!loaded) clear ();
+
+        return loaded;
+    }
+
+    bool Compressed_Image::decode (Color_Buffer< Rgba8888 > & color_buffer) const
+    {
+        return etc_decode
+        (
+            format,
+            data.data (),
+            alpha_data.empty () ? nullptr : alpha_data.data (),
+            width,
+            height,
+            color_buffer
+        );
+    }
+
+    bool Compressed_Image::load_ktx (const byte * file_data, size_t size)
+    {
+        // La cabecera son 13 enteros de 32 bits tras el identificador. El campo de endianness indica
+        // si el archivo se escribió con el orden de bytes contrario:
+
+        const byte * header = file_data + sizeof(ktx_identifier);
+        bool         swap   = read_32 (header, false) != 0x04030201;
+
+        if (swap && read_32 (header, true) != 0x04030201) return false;
+
+        uint32_t gl_type         = read_32 (header +  4, swap);
+        uint32_t internal_format = read_32 (header + 16, swap);
+        uint32_t pixel_width     = read_32 (header + 24, swap);
+        uint32_t pixel_height    = read_32 (header + 28, swap);
+        uint32_t pixel_depth     = read_32 (header + 32, swap);
+        uint32_t array_elements  = read_32 (header + 36, swap);
+        uint32_t faces           = read_32 (header + 40, swap);
+        uint32_t key_value_bytes = read_32 (header + 48, swap);
+
+        if (gl_type != 0 || pixel_depth > 1 || faces != 1 || pixel_width == 0 || pixel_height == 0) return false;
+
+        block_width = block_height = 4;
+
+        switch (internal_format)
+        {
+            case ktx_etc1_rgb8:    format = ETC1_RGB;    break;
+            case ktx_etc2_rgb8:    format = ETC2_RGB;    break;
+            case ktx_etc2_rgb8_a1: format = ETC2_RGB_A1; break;
+            case ktx_etc2_rgba8:   format = ETC2_RGBA;   break;
+
+            default:
+            {
+                if (internal_format < ktx_astc_first || internal_format > ktx_astc_last) return false;
+
+                format       = ASTC_RGBA;
+                block_width  = astc_block_sizes[internal_format - ktx_astc_first][0];
+                block_height = astc_block_sizes[internal_format - ktx_astc_first][1];
+            }
+        }
+
+        // Solo se admite un array de dos elementos con ETC1: el segundo es el plano de alfa:
+
+        unsigned layers = array_elements == 0 ? 1 : array_elements;
+
+        if (layers > 2 || (layers == 2 && format != ETC1_RGB)) return false;
+
+        width  = pixel_width;
+        height = pixel_height;
+
+        size_t offset = ktx_header_size + size_t(key_value_bytes);
+
+        if (offset + 4 > size) return false;
+
+        size_t image_size = read_32 (file_data + offset, swap);
+        size_t layer_size = get_image_size (width, height);
+
+        offset += 4;
+
+        if (image_size != layer_size * layers || offset + image_size > size) return false;
+
+        data.assign (file_data + offset, file_data + offset + layer_size);
+
+        if (layers == 2)
+        {
+            alpha_data.assign (file_data + offset + layer_size, file_data + offset + image_size);
+        }
+
+        return true;
+    }
+
+    bool Compressed_Image::load_pkm (const byte * file_data, size_t size)
+    {
+        if (size < pkm_header_size || std::memcmp (file_data, pkm_identifier, sizeof(pkm_identifier)) != 0) return false;
+
+        block_width = block_height = 4;
+
+        switch (read_16_big_endian (file_data + 6))
+        {
+            case PKM_ETC1_RGB:    format = ETC1_RGB;    break;
+            case PKM_ETC2_RGB:    format = ETC2_RGB;    break;
+            case PKM_ETC2_RGBA:   format = ETC2_RGBA;   break;
+            case PKM_ETC2_RGB_A1: format = ETC2_RGB_A1; break;
+            default:              return false;
+        }
+
+        // La cabecera guarda el tamaño real de la imagen y el redondeado a bloques completos:
+
+        width  = read_16_big_endian (file_data + 12);
+        height = read_16_big_endian (file_data + 14);
+
+        size_t image_size = get_image_size (width, height);
+
+        if (width == 0 || height == 0 || pkm_header_size + image_size > size) return false;
+
+        data.assign (file_data + pkm_header_size, file_data + pkm_header_size + image_size);
+
+        // Un segundo PKM de ETC1 con el mismo tamaño a continuación es el plano de alfa:
+
+        const byte * alpha = file_data + pkm_header_size + image_size;
+        size_t       left  = size - pkm_header_size - image_size;
+
+        if (format == ETC1_RGB && left >= pkm_header_size + image_size && std::memcmp (alpha, pkm_identifier, sizeof(pkm_identifier)) == 0)
+        {
+            if (read_16_big_endian (alpha +  6) != PKM_ETC1_RGB
+            ||  read_16_big_endian (alpha + 12) != width
+            ||  read_16_big_endian (alpha + 14) != height)
+            {
+                return false;
+            }
+
+            alpha_data.assign (alpha + pkm_header_size, alpha + pkm_header_size + image_size);
+        }
+
+        return true;
+    }
+
+}
@@ -20,15 +20,17 @@ using namespace rapidxml;
 namespace basics
 {
 
-    Raster_Font::Raster_Font(const string & path, Graphics_Context::Accessor & context)
+    Raster_Font::Raster_Font(const string & path, Graphics_Context::Accessor & context, const Texture_2D::Options & texture_options)
+    :
+        texture_options(texture_options)
     {
         shared_ptr< Asset > font_file = Asset::open (path);
 
-        if (font_file->good ())
+        if (font_file)
         {
-            Buffer font_data;
+            Asset::Span font_data = font_file->map ();
 
-            if (font_file->read_all (font_data))
+            if (font_data.data)
             {
                 ready = parse (font_data, path, context);
             }
@@ -39,14 +41,19 @@ namespace basics
 
     bool Raster_Font::parse
     (
-        Buffer                     & font_data,
+        const Asset::Span          & font_file,
         const std::string          & path,
         Graphics_Context::Accessor & context
     )
     {
-        // Se pone un caracter nulo al final para que el parseador de rapidxml sepa dónde está el
-        // final de los datos:
+        // rapidxml parsea el texto modificándolo y necesita un caracter nulo al final para saber
+        // dónde acaban los datos, así que se copia una sola vez a un buffer que ya tiene sitio
+        // para él:
 
+        Buffer font_data;
+
+        font_data.reserve   (font_file.size + 1);
+        font_data.assign    (font_file.begin (), font_file.end ());
         font_data.push_back (0);
 
         // Se parsea el xml de datos de la fuente:
@@ -132,7 +139,7 @@ namespace basics
 
                 // Se intenta cargar la textura:
 
-                auto texture = Texture_2D::create (0, context, texture_path + file_attritube->value ());
+                auto texture = Texture_2D::create (0, context, texture_path + file_attritube->value (), texture_options);
 
                 assert(texture);
 
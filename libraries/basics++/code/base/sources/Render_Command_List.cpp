@@ -0,0 +1,177 @@
+/*
+ * RENDER COMMAND LIST
+ * Copyright © 2018+ Ángel Rodríguez Ballesteros
+ *
+ * Distributed under the Boost Software License, version  1.0
+ * See documents/LICENSE.TXT or www.boost.org/LICENSE_1_0.txt
+ *
+ * angel.rodriguez@esne.edu
+ *
+ * C2610171610
+ */
+
+#include <algorithm>
+#include <basics/Render_Command_List>
+
+using namespace std;
+
+namespace basics
+{
+
+    void Render_Command_List::add
+    (
+        int                layer,
+        unsigned           shader,
+        unsigned           texture_key,
+        const Texture_2D * texture,
+        const float      * positions,
+        const Point2f    * texture_uvs,
+        bool               opaque,
+        float              blend
+    )
+    {
+        Command command;
+
+        command.layer          = layer;
+        command.shader         = shader;
+        command.texture_key    = texture_key;
+        command.texture        = texture;
+        command.opaque         = opaque;
+        command.blend          = blend;
+        command.first_vertex   = 0;
+        command.vertex_count   = 0;
+        command.area           = 0.f;
+
+        for (unsigned corner = 0; corner < 4; ++corner)
+        {
+            command.positions  [corner] = { positions[corner * 2], positions[corner * 2 + 1] };
+            command.texture_uvs[corner] = texture_uvs[corner];
+        }
+
+        push (command);
+    }
+
+    void Render_Command_List::add_block
+    (
+        int                      layer,
+        unsigned                 shader,
+        unsigned                 texture_key,
+        const Texture_2D       * texture,
+        const Vertex           * block,
+        size_t                   count,
+        const Transformation2f & transform,
+        float                    area,
+        float                    blend
+    )
+    {
+        if (count == 0) return;
+
+        Command command = Command();
+
+        command.layer          = layer;
+        command.shader         = shader;
+        command.texture_key    = texture_key;
+        command.texture        = texture;
+        command.opaque         = false;
+        command.blend          = blend;
+        command.first_vertex   = unsigned(vertices.size ());
+        command.vertex_count   = unsigned(count);
+        command.area           = area;
+
+        const float * m = transform.matrix.values;
+
+        for (const Vertex * vertex = block, * end = block + count; vertex < end; ++vertex)
+        {
+            vertices.push_back
+            ({
+                m[0] * vertex->x + m[1] * vertex->y + m[2],
+                m[3] * vertex->x + m[4] * vertex->y + m[5],
+                vertex->u,
+                vertex->v
+            });
+        }
+
+        push (command);
+    }
+
+    void Render_Command_List::push (Command & command)
+    {
+        command.sequence = unsigned(commands.size ());
+
+        // Si el nuevo comando ya va detrás del último no hace falta ordenar nada:
+
+        if (sorted && !commands.empty ())
+        {
+            const Command & last = commands.back ();
+
+            sorted =
+                last.layer  <  command.layer || (last.layer  == command.layer &&
+               (last.shader <  command.shader || (last.shader == command.shader &&
+                last.texture_key <= command.texture_key)));
+        }
+
+        commands.push_back (command);
+    }
+
+    void Render_Command_List::sort ()
+    {
+        if (!sorted)
+        {
+            // La secuencia forma parte de la clave, por lo que no hace falta std::stable_sort():
+
+            std::sort
+            (
+                commands.begin (),
+                commands.end   (),
+                [] (const Command & a, const Command & b)
+                {
+                    if (a.layer       != b.layer      ) return a.layer       < b.layer;
+                    if (a.shader      != b.shader     ) return a.shader      < b.shader;
+                    if (a.texture_key != b.texture_key) return a.texture_key < b.texture_key;
+
+                    return a.sequence < b.sequence;
+                }
+            );
+
+            sorted = true;
+        }
+    }
+
+    void Render_Command_List::dump (std::ostream & output) const
+    {
+        for (const Command & command : commands)
+        {
+            output
+                << "layer "    << command.layer
+                << " shader "  << command.shader
+                << " texture " << command.texture_key
+                << " seq "     << command.sequence
+                << " opaque "  << command.opaque
+                << " blend "   << command.blend;
+
+            if (command.vertex_count > 0)
+            {
+                output << " block " << command.vertex_count << " area " << command.area << '\n';
+
+                continue;
+            }
+
+            output << " xy";
+
+            for (const Point2f & position : command.positions)
+            {
+                output << ' ' << position[0] << ' ' << position[1];
+            }
+
+            output << " uv";
+
+            for (const Point2f & uv : command.texture_uvs)
+            {
+                output << ' ' << uv[0] << ' ' << uv[1];
+            }
+
+            output << '\n';
+        }
+    }
+
+}
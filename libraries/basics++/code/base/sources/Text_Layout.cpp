@@ -17,8 +17,11 @@ namespace basics
 
     Text_Layout::Text_Layout(const Raster_Font & font, const std::wstring & text)
     :
-        width (0.f),
-        height(0.f)
+        width         (0.f  ),
+        height        (0.f  ),
+        caching       (true ),
+        vertices_baked(false),
+        glyph_area    (0.f  )
     {
         Raster_Font::Metrics metrics = font.get_metrics ();
 
@@ -52,6 +55,8 @@ namespace basics
 
                     if (current_x == 0.f) height += metrics.line_height;
 
+                    glyph_area += character->slice->width * character->slice->height;
+
                     current_x += character->advance;
                 }
             }
@@ -60,4 +65,36 @@ namespace basics
         if (current_x > width) width = current_x;
     }
 
+    void Text_Layout::bake_vertices () const
+    {
+        vertices.clear   ();
+        vertices.reserve (glyphs.size () * 4);
+
+        for (auto & glyph : glyphs)
+        {
+            const Texture_2D * texture = glyph.slice->atlas->get_texture ().get ();
+
+            float horizontal_ratio = 1.f / texture->get_width  ();
+            float   vertical_ratio = 1.f / texture->get_height ();
+            float uv_left          = glyph.slice->left   * horizontal_ratio;
+            float uv_right         = glyph.slice->right  * horizontal_ratio;
+            float uv_top           = glyph.slice->top    *   vertical_ratio;
+            float uv_bottom        = glyph.slice->bottom *   vertical_ratio;
+
+            // La posición del glifo es la de su esquina superior izquierda:
+
+            float left   = glyph.position[0];
+            float top    = glyph.position[1];
+            float right  = left + glyph.size.width;
+            float bottom = top  - glyph.size.height;
+
+            vertices.push_back ({ left,  bottom, uv_left,  uv_top    });
+            vertices.push_back ({ left,  top,    uv_left,  uv_bottom });
+            vertices.push_back ({ right, bottom, uv_right, uv_top    });
+            vertices.push_back ({ right, top,    uv_right, uv_bottom });
+        }
+
+        vertices_baked = true;
+    }
+
 }
@@ -10,15 +10,18 @@
  * C1801161300
  */
 
+#include <basics/Asset_Prefetcher>
 #include <basics/png_decode>
 #include <basics/Texture_2D>
 
 namespace basics
 {
 
-    Id                  Texture_2D::texture_2d_specialization_ids      [10];
-    Texture_2D::Factory Texture_2D::texture_2d_specialization_factories[10];
-    size_t              Texture_2D::texture_2d_specialization_count;
+    Id                             Texture_2D::texture_2d_specialization_ids                 [10];
+    Texture_2D::Factory            Texture_2D::texture_2d_specialization_factories           [10];
+    Texture_2D::Compressed_Factory Texture_2D::texture_2d_specialization_compressed_factories[10];
+    size_t                         Texture_2D::texture_2d_specialization_count;
+    unsigned                       Texture_2D::dropped_mip_levels = 0;
 
     std::shared_ptr< Texture_2D > Texture_2D::create (Id id, Graphics_Context::Accessor & context, Color_Buffer< Rgba8888 > & color_buffer, const Options & options)
     {
@@ -35,27 +38,169 @@ namespace basics
         return std::shared_ptr< Texture_2D >();
     }
 
-    std::shared_ptr< Texture_2D > Texture_2D::create (Id id, Graphics_Context::Accessor & context, const std::string & asset_path, const Options & options)
+    std::shared_ptr< Texture_2D > Texture_2D::create (Id id, Graphics_Context::Accessor & context, Compressed_Image & image, const Options & options)
     {
-        std::shared_ptr< Asset > asset = Asset::open (asset_path);
+        Id context_id = context->get_id ();
 
-        if (asset)
+        for (unsigned index = 0; index < texture_2d_specialization_count; ++index)
         {
-            std::vector< byte >  data;
-
-            if (asset->read_all (data))
+            if (texture_2d_specialization_ids[index] == context_id)
             {
+                if (texture_2d_specialization_compressed_factories[index])
+                {
+                    return texture_2d_specialization_compressed_factories[index] (id, image, options);
+                }
+
+                // La especialización no sabe usar imágenes comprimidas. Se le dan los píxeles:
+
                 Color_Buffer< Rgba8888 > color_buffer;
-                Texture_2D::Options      options;
 
-                if (png_decode (data, color_buffer, options.width, options.height))
+                if (image.decode (color_buffer))
                 {
-                    return Texture_2D::create (id, context, color_buffer, options);
+                    image.clear ();
+
+                    return texture_2d_specialization_factories[index] (id, color_buffer, options);
                 }
+
+                break;
             }
         }
 
         return std::shared_ptr< Texture_2D >();
     }
 
+    std::shared_ptr< Texture_2D > Texture_2D::create (Id id, Graphics_Context::Accessor & context, const std::string & asset_path, const Options & options)
+    {
+        Color_Buffer< Rgba8888 > color_buffer;
+        Compressed_Image         image;
+        Texture_2D::Options      decoded_options = options;
+        std::vector< byte >      encoded_data;
+
+        // El archivo solo se copia si la textura lo va a conservar:
+
+        if (decode (asset_path, color_buffer, image, decoded_options, options.residency == KEEP_ENCODED ? &encoded_data : nullptr))
+        {
+            std::shared_ptr< Texture_2D > texture = image.empty ()
+                                                  ? Texture_2D::create (id, context, color_buffer, decoded_options)
+                                                  : Texture_2D::create (id, context, image,        decoded_options);
+
+            if (texture) texture->set_source (asset_path, std::move (encoded_data));
+
+            return texture;
+        }
+
+        return std::shared_ptr< Texture_2D >();
+    }
+
+    bool Texture_2D::decode (const std::string & asset_path, Color_Buffer< Rgba8888 > & color_buffer, Options & options, std::vector< byte > * encoded_data)
+    {
+        Compressed_Image image;
+
+        if (decode (asset_path, color_buffer, image, options, encoded_data))
+        {
+            if (image.empty ()) return true;
+
+            if (!image.decode (color_buffer)) return false;
+
+            // decode_file() solo premultiplica lo que decodifica él. Las imágenes comprimidas que se
+            // decodifican aquí también deben salir premultiplicadas si se pide:
+
+            if (premultiplies (options) && !options.opaque)
+            {
+                premultiply_alpha (color_buffer);
+            }
+
+            return true;
+        }
+
+        return false;
+    }
+
+    bool Texture_2D::decode (const std::string & asset_path, Color_Buffer< Rgba8888 > & color_buffer, Compressed_Image & image, Options & options, std::vector< byte > * encoded_data)
+    {
+        // El prefetcher no conserva el archivo, así que con KEEP_ENCODED hay que leerlo igualmente:
+
+        if (!encoded_data && Asset_Prefetcher::get_instance ().take (asset_path, color_buffer, image, options))
+        {
+            return true;
+        }
+
+        return decode_asset (asset_path, color_buffer, image, options, encoded_data);
+    }
+
+    bool Texture_2D::decode_asset (const std::string & asset_path, Color_Buffer< Rgba8888 > & color_buffer, Compressed_Image & image, Options & options, std::vector< byte > * encoded_data)
+    {
+        std::shared_ptr< Asset > asset = Asset::open (asset_path);
+
+        if (asset)
+        {
+            // Se decodifica directamente desde el buffer del asset, sin copiar antes el archivo:
+
+            Asset::Span data = asset->map ();
+
+            if (data.data && decode_file (data.data, data.size, color_buffer, &image, options))
+            {
+                if (encoded_data) encoded_data->assign (data.begin (), data.end ());
+
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    bool Texture_2D::decode_file (const byte * file_data, size_t file_size, Color_Buffer< Rgba8888 > & color_buffer, Compressed_Image * image, Options & options)
+    {
+        // Los contenedores de texturas comprimidas se reconocen por su firma. Todo lo demás se trata
+        // como PNG:
+
+        if (Compressed_Image::is_compressed (file_data, file_size))
+        {
+            Compressed_Image loaded_image;
+
+            if (!loaded_image.load (file_data, file_size)) return false;
+
+            options.width  = loaded_image.get_width  ();
+            options.height = loaded_image.get_height ();
+            options.opaque = loaded_image.is_opaque  ();
+
+            if (image)
+            {
+                *image = std::move (loaded_image);
+
+                return true;
+            }
+
+            if (!loaded_image.decode (color_buffer)) return false;
+        }
+        else
+        if (!png_decode (file_data, file_size, color_buffer, options.width, options.height, options.opaque))
+        {
+            return false;
+        }
+
+        // En las imágenes opacas premultiplicar no cambia nada:
+
+        if (premultiplies (options) && !options.opaque)
+        {
+            premultiply_alpha (color_buffer);
+        }
+
+        return true;
+    }
+
+    bool Texture_2D::reload_pixels (Color_Buffer< Rgba8888 > & color_buffer, Compressed_Image & image) const
+    {
+        Options options = Options();
+
+        options.premultiplied = premultiplied;
+
+        switch (residency)
+        {
+            case RELOAD_FROM_ASSET: return pixel_source ? pixel_source (color_buffer) : decode (asset_path, color_buffer, image, options);
+            case KEEP_ENCODED:      return decode_file (encoded_data.data (), encoded_data.size (), color_buffer, &image, options);
+            default:                return false;
+        }
+    }
+
 }
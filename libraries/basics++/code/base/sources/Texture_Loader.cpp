@@ -0,0 +1,311 @@
+/*
+ * TEXTURE LOADER
+ * Copyright © 2018+ Ángel Rodríguez Ballesteros
+ *
+ * Distributed under the Boost Software License, version  1.0
+ * See documents/LICENSE.TXT or www.boost.org/LICENSE_1_0.txt
+ *
+ * angel.rodriguez@esne.edu
+ *
+ * C2610171810
+ */
+
+#include <basics/Texture_Loader>
+#include <basics/Timer>
+
+namespace basics
+{
+
+    Texture_Loader::Texture_Loader(unsigned worker_count)
+    :
+        worker_count      (worker_count),
+        running_workers   (0),
+        pending           (0),
+        requested         (0),
+        delivered         (0),
+        stopping          (false),
+        upload_byte_budget(4 * 1024 * 1024),
+        upload_time_budget(.004f)
+    {
+        if (this->worker_count == 0)
+        {
+            // hardware_concurrency() puede devolver 0 si no lo sabe. Se deja un núcleo libre para el
+            // hilo que dibuja:
+
+            unsigned cores = std::thread::hardware_concurrency ();
+
+            this->worker_count = cores > 2 ? cores - 1 : 1;
+        }
+    }
+
+    Texture_Loader::~Texture_Loader()
+    {
+        {
+            std::lock_guard< std::mutex > lock(mutex);
+
+            stopping = true;
+        }
+
+        for (auto & worker : workers)
+        {
+            worker.join ();
+        }
+
+        // Quien espera una carga que ya no se va a entregar recibe una textura o una imagen vacía en
+        // lugar de la excepción std::broken_promise que daría destruir la promesa sin valor:
+
+        for (auto & job : decode_queue) cancel (*job);
+        for (auto & job : upload_queue) cancel (*job);
+    }
+
+    void Texture_Loader::cancel (Job & job)
+    {
+        if (job.pixels_only)
+        {
+            job.pixels_promise.set_value (Color_Buffer< Rgba8888 >());
+        }
+        else
+        {
+            job.promise.set_value (Texture_Handle());
+        }
+    }
+
+    std::future< Texture_Loader::Texture_Handle > Texture_Loader::load (Id id, const std::string & path, Callback callback, const Texture_2D::Options & options)
+    {
+        Job_Handle job(new Job);
+
+        job->id       = id;
+        job->path     = path;
+        job->callback = callback;
+        job->options     = options;
+        job->decoded     = false;
+        job->pixels_only = false;
+
+        std::future< Texture_Handle > future = job->promise.get_future ();
+
+        {
+            std::lock_guard< std::mutex > lock(mutex);
+
+            decode_queue.push_back (job);
+
+            start_workers ();
+
+            // El progreso se empieza a contar de nuevo con la primera carga tras quedarse libre:
+
+            if (pending == 0) requested = delivered = 0;
+
+            pending++;
+            requested++;
+        }
+
+        return future;
+    }
+
+    std::future< Color_Buffer< Rgba8888 > > Texture_Loader::decode (const std::string & path, const Texture_2D::Options & options)
+    {
+        Job_Handle job(new Job);
+
+        job->path        = path;
+        job->options     = options;
+        job->decoded     = false;
+        job->pixels_only = true;
+
+        std::future< Color_Buffer< Rgba8888 > > future = job->pixels_promise.get_future ();
+
+        {
+            std::lock_guard< std::mutex > lock(mutex);
+
+            decode_queue.push_back (job);
+
+            start_workers ();
+        }
+
+        return future;
+    }
+
+    unsigned Texture_Loader::wait_all (Graphics_Context::Accessor & context, const Progress_Callback & progress)
+    {
+        unsigned delivered_count = 0;
+
+        for (;;)
+        {
+            {
+                std::unique_lock< std::mutex > lock(mutex);
+
+                if (pending == 0) break;
+
+                decoded_condition.wait (lock, [this] () { return !upload_queue.empty () || pending == 0; });
+            }
+
+            unsigned count = deliver (context, size_t(-1), 0.f);
+
+            delivered_count += count;
+
+            if (progress && count) progress (get_progress ());
+        }
+
+        return delivered_count;
+    }
+
+    unsigned Texture_Loader::deliver (Graphics_Context::Accessor & context, size_t byte_budget, float time_budget)
+    {
+        Timer    timer;
+        size_t   uploaded_bytes = 0;
+        unsigned uploaded_count = 0;
+
+        for (;;)
+        {
+            Job_Handle job;
+
+            {
+                std::lock_guard< std::mutex > lock(mutex);
+
+                if (upload_queue.empty ()) break;
+
+                const Job & next  = *upload_queue.front ();
+                size_t      bytes = next.compressed_image.empty ()
+                                  ? next.color_buffer.size () * sizeof(Rgba8888)
+                                  : next.compressed_image.get_data ().size () + next.compressed_image.get_alpha_data ().size ();
+
+                if (uploaded_count > 0)
+                {
+                    if (uploaded_bytes + bytes > byte_budget) break;
+                    if (time_budget > 0.f && timer.get_elapsed_seconds () >= time_budget) break;
+                }
+
+                job = upload_queue.front ();
+
+                upload_queue.pop_front ();
+
+                uploaded_bytes += bytes;
+            }
+
+            Texture_Handle texture;
+
+            if (job->decoded)
+            {
+                texture = job->compressed_image.empty ()
+                        ? Texture_2D::create (job->id, context, job->color_buffer,     job->options)
+                        : Texture_2D::create (job->id, context, job->compressed_image, job->options);
+
+                if (texture)
+                {
+                    texture->set_source (job->path, std::move (job->encoded_data));
+
+                    context->add (texture);
+                }
+            }
+
+            // Normalmente la textura ya se ha quedado con los píxeles. Si no, se liberan aquí:
+
+            job->color_buffer = Color_Buffer< Rgba8888 >();
+
+            job->compressed_image.clear ();
+
+            if (job->callback) job->callback (job->id, texture);
+
+            job->promise.set_value (texture);
+
+            {
+                std::lock_guard< std::mutex > lock(mutex);
+
+                pending--;
+                delivered++;
+            }
+
+            uploaded_count++;
+        }
+
+        return uploaded_count;
+    }
+
+    void Texture_Loader::start_workers ()
+    {
+        // Se llama con el mutex bloqueado. Los hilos que ya han terminado lo soltaron antes de salir,
+        // por lo que se puede esperar por ellos aquí sin riesgo de bloqueo:
+
+        for (auto & id : finished_workers)
+        {
+            for (auto worker = workers.begin (); worker != workers.end (); ++worker)
+            {
+                if (worker->get_id () == id)
+                {
+                    worker->join ();
+                    workers.erase (worker);
+                    break;
+                }
+            }
+        }
+
+        finished_workers.clear ();
+
+        // Se crean hilos hasta el máximo, pero no más que trabajos haya en la cola:
+
+        while (running_workers < worker_count && running_workers < decode_queue.size ())
+        {
+            workers.emplace_back (&Texture_Loader::run_worker, this);
+
+            running_workers++;
+        }
+    }
+
+    void Texture_Loader::run_worker ()
+    {
+        for (;;)
+        {
+            Job_Handle job;
+
+            {
+                std::lock_guard< std::mutex > lock(mutex);
+
+                // Con la cola vacía el hilo termina. La siguiente carga creará otro si hace falta:
+
+                if (stopping || decode_queue.empty ())
+                {
+                    finished_workers.push_back (std::this_thread::get_id ());
+
+                    running_workers--;
+
+                    return;
+                }
+
+                job = decode_queue.front ();
+
+                decode_queue.pop_front ();
+            }
+
+            // La lectura y la decodificación no tocan el contexto gráfico, por lo que se hacen sin
+            // tener el mutex. Lo encargado con decode() se entrega directamente desde aquí:
+
+            if (job->pixels_only)
+            {
+                if (!Texture_2D::decode (job->path, job->color_buffer, job->options))
+                {
+                    job->color_buffer = Color_Buffer< Rgba8888 >();
+                }
+
+                job->pixels_promise.set_value (std::move (job->color_buffer));
+
+                continue;
+            }
+
+            job->decoded = Texture_2D::decode
+            (
+                job->path,
+                job->color_buffer,
+                job->compressed_image,
+                job->options,
+                job->options.residency == Texture_2D::KEEP_ENCODED ? &job->encoded_data : nullptr
+            );
+
+            {
+                std::lock_guard< std::mutex > lock(mutex);
+
+                upload_queue.push_back (job);
+            }
+
+            decoded_condition.notify_all ();
+        }
+    }
+
+}
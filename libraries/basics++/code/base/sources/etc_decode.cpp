@@ -0,0 +1,403 @@
+/*
+ * ETC DECODE
+ * Copyright © 2018+ Ángel Rodríguez Ballesteros
+ *
+ * Distributed under the Boost Software License, version  1.0
+ * See documents/LICENSE.TXT or www.boost.org/LICENSE_1_0.txt
+ *
+ * angel.rodriguez@esne.edu
+ *
+ * C2610172011
+ */
+
+#include <cstdint>
+#include <basics/etc_decode>
+
+// Decodificador de referencia de ETC1 y ETC2 (RGB, RGB con alfa de un bit y RGBA con alfa EAC)
+// según la especificación de Khronos. Solo se usa cuando el contexto gráfico no admite el formato,
+// así que prima la claridad sobre la velocidad.
+
+namespace basics
+{
+
+    namespace
+    {
+
+        const int modifier_table[8][2] =
+        {
+            {  2,   8 }, {  5,  17 }, {  9,  29 }, { 13,  42 },
+            { 18,  60 }, { 24,  80 }, { 33, 106 }, { 47, 183 },
+        };
+
+        const int distance_table[8] = { 3, 6, 11, 16, 23, 32, 41, 64 };
+
+        const int alpha_modifier_table[16][8] =
+        {
+            { -3, -6,  -9, -15, 2, 5, 8, 14 },
+            { -3, -7, -10, -13, 2, 6, 9, 12 },
+            { -2, -5,  -8, -13, 1, 4, 7, 12 },
+            { -2, -4,  -6, -13, 1, 3, 5, 12 },
+            { -3, -6,  -8, -12, 2, 5, 7, 11 },
+            { -3, -7,  -9, -11, 2, 6, 8, 10 },
+            { -4, -7,  -8, -11, 3, 6, 7, 10 },
+            { -3, -5,  -8, -11, 2, 4, 7, 10 },
+            { -2, -6,  -8, -10, 1, 5, 7,  9 },
+            { -2, -5,  -8, -10, 1, 4, 7,  9 },
+            { -2, -4,  -8, -10, 1, 3, 7,  9 },
+            { -2, -5,  -7, -10, 1, 4, 6,  9 },
+            { -3, -4,  -7, -10, 2, 3, 6,  9 },
+            { -1, -2,  -3, -10, 0, 1, 2,  9 },
+            { -4, -6,  -8,  -9, 3, 5, 7,  8 },
+            { -3, -5,  -7,  -9, 2, 4, 6,  8 },
+        };
+
+        /**
+         * Píxeles de un bloque de 4x4 en RGBA8. Se indexan como [y][x].
+         */
+        typedef byte Block_Pixels[4][4][4];
+
+        inline int clamp (int value)
+        {
+            return value < 0 ? 0 : value > 255 ? 255 : value;
+        }
+
+        inline int extend_4 (int value) { return (value << 4) | value;        }
+        inline int extend_5 (int value) { return (value << 3) | (value >> 2); }
+        inline int extend_6 (int value) { return (value << 2) | (value >> 4); }
+        inline int extend_7 (int value) { return (value << 1) | (value >> 6); }
+
+        inline uint64_t read_block (const byte * block)
+        {
+            uint64_t value = 0;
+
+            for (unsigned i = 0; i < 8; ++i) value = (value << 8) | block[i];
+
+            return value;
+        }
+
+        inline unsigned bits (uint64_t block, unsigned first, unsigned count)
+        {
+            return unsigned(block >> first) & ((1u << count) - 1);
+        }
+
+        /**
+         * Índice de 2 bits del píxel (x, y). Los píxeles se numeran por columnas.
+         */
+        inline unsigned pixel_index (uint64_t block, unsigned x, unsigned y)
+        {
+            unsigned bit = x * 4 + y;
+
+            return (bits (block, 16 + bit, 1) << 1) | bits (block, bit, 1);
+        }
+
+        inline void set_pixel (Block_Pixels & pixels, unsigned x, unsigned y, int r, int g, int b, int a = 255)
+        {
+            byte * pixel = pixels[y][x];
+
+            pixel[0] = byte(clamp (r));
+            pixel[1] = byte(clamp (g));
+            pixel[2] = byte(clamp (b));
+            pixel[3] = byte(a);
+        }
+
+        /**
+         * Modos T y H: cuatro colores de pintura elegidos directamente por el índice de cada píxel.
+         */
+        void decode_paint_colors (uint64_t block, const int (& paint)[4][3], bool punch_through, Block_Pixels & pixels)
+        {
+            for (unsigned y = 0; y < 4; ++y)
+            {
+                for (unsigned x = 0; x < 4; ++x)
+                {
+                    unsigned index = pixel_index (block, x, y);
+
+                    if (punch_through && index == 2)
+                    {
+                        set_pixel (pixels, x, y, 0, 0, 0, 0);
+                    }
+                    else
+                    {
+                        set_pixel (pixels, x, y, paint[index][0], paint[index][1], paint[index][2]);
+                    }
+                }
+            }
+        }
+
+        void decode_t_mode (uint64_t block, bool punch_through, Block_Pixels & pixels)
+        {
+            int r1 = extend_4 ((bits (block, 59, 2) << 2) | bits (block, 56, 2));
+            int g1 = extend_4 (bits (block, 52, 4));
+            int b1 = extend_4 (bits (block, 48, 4));
+            int r2 = extend_4 (bits (block, 44, 4));
+            int g2 = extend_4 (bits (block, 40, 4));
+            int b2 = extend_4 (bits (block, 36, 4));
+            int d  = distance_table[(bits (block, 34, 2) << 1) | bits (block, 32, 1)];
+
+            const int paint[4][3] =
+            {
+                { r1,     g1,     b1     },
+                { r2 + d, g2 + d, b2 + d },
+                { r2,     g2,     b2     },
+                { r2 - d, g2 - d, b2 - d },
+            };
+
+            decode_paint_colors (block, paint, punch_through, pixels);
+        }
+
+        void decode_h_mode (uint64_t block, bool punch_through, Block_Pixels & pixels)
+        {
+            int r1 = bits (block, 59, 4);
+            int g1 = (bits (block, 56, 3) << 1) | bits (block, 52, 1);
+            int b1 = (bits (block, 51, 1) << 3) | bits (block, 47, 3);
+            int r2 = bits (block, 43, 4);
+            int g2 = bits (block, 39, 4);
+            int b2 = bits (block, 35, 4);
+
+            // El bit menos significativo de la distancia no se guarda: sale del orden de los colores.
+
+            unsigned distance_index = (bits (block, 34, 1) << 2) | (bits (block, 32, 1) << 1);
+
+            if (((r1 << 8) | (g1 << 4) | b1) >= ((r2 << 8) | (g2 << 4) | b2)) distance_index |= 1;
+
+            int d = distance_table[distance_index];
+
+            r1 = extend_4 (r1); g1 = extend_4 (g1); b1 = extend_4 (b1);
+            r2 = extend_4 (r2); g2 = extend_4 (g2); b2 = extend_4 (b2);
+
+            const int paint[4][3] =
+            {
+                { r1 + d, g1 + d, b1 + d },
+                { r1 - d, g1 - d, b1 - d },
+                { r2 + d, g2 + d, b2 + d },
+                { r2 - d, g2 - d, b2 - d },
+            };
+
+            decode_paint_colors (block, paint, punch_through, pixels);
+        }
+
+        void decode_planar_mode (uint64_t block, Block_Pixels & pixels)
+        {
+            int ro = extend_6 (bits (block, 57, 6));
+            int go = extend_7 ((bits (block, 56, 1) << 6) | bits (block, 49, 6));
+            int bo = extend_6 ((bits (block, 48, 1) << 5) | (bits (block, 43, 2) << 3) | bits (block, 39, 3));
+            int rh = extend_6 ((bits (block, 34, 5) << 1) | bits (block, 32, 1));
+            int gh = extend_7 (bits (block, 25, 7));
+            int bh = extend_6 (bits (block, 19, 6));
+            int rv = extend_6 (bits (block, 13, 6));
+            int gv = extend_7 (bits (block,  6, 7));
+            int bv = extend_6 (bits (block,  0, 6));
+
+            for (int y = 0; y < 4; ++y)
+            {
+                for (int x = 0; x < 4; ++x)
+                {
+                    set_pixel
+                    (
+                        pixels, x, y,
+                        (x * (rh - ro) + y * (rv - ro) + 4 * ro + 2) >> 2,
+                        (x * (gh - go) + y * (gv - go) + 4 * go + 2) >> 2,
+                        (x * (bh - bo) + y * (bv - bo) + 4 * bo + 2) >> 2
+                    );
+                }
+            }
+        }
+
+        /**
+         * Modos individual y diferencial (los de ETC1): dos subbloques con un color base y una tabla
+         * de modificadores cada uno.
+         */
+        void decode_subblocks (uint64_t block, const int (& base)[2][3], bool punch_through, Block_Pixels & pixels)
+        {
+            bool     flip     = bits (block, 32, 1) != 0;
+            unsigned table[2] = { bits (block, 37, 3), bits (block, 34, 3) };
+
+            for (unsigned y = 0; y < 4; ++y)
+            {
+                for (unsigned x = 0; x < 4; ++x)
+                {
+                    unsigned subblock = flip ? y >> 1 : x >> 1;
+                    unsigned index    = pixel_index (block, x, y);
+
+                    if (punch_through && index == 2)
+                    {
+                        set_pixel (pixels, x, y, 0, 0, 0, 0);
+                        continue;
+                    }
+
+                    // Los índices 0 y 1 suman el modificador pequeño y el grande, y 2 y 3 los restan.
+                    // Con alfa de un bit el modificador pequeño no existe:
+
+                    int modifier = punch_through && index == 0 ? 0 : modifier_table[table[subblock]][index & 1];
+
+                    if (index & 2) modifier = -modifier;
+
+                    const int * color = base[subblock];
+
+                    set_pixel (pixels, x, y, color[0] + modifier, color[1] + modifier, color[2] + modifier);
+                }
+            }
+        }
+
+        /**
+         * @param etc2 false para ETC1, donde no existen los modos T, H y planar.
+         * @param punch_through true para ETC2 con alfa de un bit (el bit diferencial indica si el
+         *     bloque es opaco).
+         */
+        void decode_color_block (const byte * data, bool etc2, bool punch_through, Block_Pixels & pixels)
+        {
+            uint64_t block        = read_block (data);
+            bool     differential = punch_through || bits (block, 33, 1) != 0;
+            bool     transparent  = punch_through && bits (block, 33, 1) == 0;
+            int      base[2][3];
+
+            if (!differential)
+            {
+                for (unsigned channel = 0; channel < 3; ++channel)
+                {
+                    base[0][channel] = extend_4 (bits (block, 60 - channel * 8, 4));
+                    base[1][channel] = extend_4 (bits (block, 56 - channel * 8, 4));
+                }
+            }
+            else
+            {
+                for (unsigned channel = 0; channel < 3; ++channel)
+                {
+                    int value = bits (block, 59 - channel * 8, 5);
+                    int delta = bits (block, 56 - channel * 8, 3);
+
+                    if (delta >= 4) delta -= 8;
+
+                    // En ETC2 un color fuera de rango indica otro modo: T si es el rojo, H si es el
+                    // verde y planar si es el azul:
+
+                    if (etc2 && (value + delta < 0 || value + delta > 31))
+                    {
+                        switch (channel)
+                        {
+                            case 0:  decode_t_mode      (block, transparent, pixels); break;
+                            case 1:  decode_h_mode      (block, transparent, pixels); break;
+                            default: decode_planar_mode (block,              pixels); break;
+                        }
+
+                        return;
+                    }
+
+                    base[0][channel] = extend_5 (value        );
+                    base[1][channel] = extend_5 (value + delta);
+                }
+            }
+
+            decode_subblocks (block, base, transparent, pixels);
+        }
+
+        void decode_alpha_block (const byte * data, Block_Pixels & pixels)
+        {
+            uint64_t block      = read_block (data);
+            int      base       = int(bits (block, 56, 8));
+            int      multiplier = int(bits (block, 52, 4));
+            unsigned table      = bits (block, 48, 4);
+
+            for (unsigned x = 0; x < 4; ++x)
+            {
+                for (unsigned y = 0; y < 4; ++y)
+                {
+                    unsigned index = bits (block, 45 - (x * 4 + y) * 3, 3);
+
+                    pixels[y][x][3] = byte(clamp (base + alpha_modifier_table[table][index] * multiplier));
+                }
+            }
+        }
+
+        /**
+         * Copia un bloque decodificado a su posición, recortándolo si sobresale de la imagen.
+         */
+        void store_block (const Block_Pixels & pixels, unsigned block_x, unsigned block_y, Color_Buffer< Rgba8888 > & color_buffer, bool alpha_only)
+        {
+            unsigned width  = color_buffer.get_width  ();
+            unsigned height = color_buffer.get_height ();
+
+            for (unsigned y = 0; y < 4 && block_y + y < height; ++y)
+            {
+                for (unsigned x = 0; x < 4 && block_x + x < width; ++x)
+                {
+                    byte * target = reinterpret_cast< byte * >(&color_buffer[(block_y + y) * width + block_x + x]);
+
+                    if (alpha_only)
+                    {
+                        target[3] = pixels[y][x][1];
+                    }
+                    else
+                    {
+                        target[0] = pixels[y][x][0];
+                        target[1] = pixels[y][x][1];
+                        target[2] = pixels[y][x][2];
+                        target[3] = pixels[y][x][3];
+                    }
+                }
+            }
+        }
+
+    }
+
+    bool etc_decode
+    (
+        Compressed_Image::Format   format,
+        const byte               * data,
+        const byte               * alpha_data,
+        unsigned                   width,
+        unsigned                   height,
+        Color_Buffer< Rgba8888 > & color_buffer
+    )
+    {
+        bool etc2          = format != Compressed_Image::ETC1_RGB;
+        bool punch_through = format == Compressed_Image::ETC2_RGB_A1;
+        bool eac_alpha     = format == Compressed_Image::ETC2_RGBA;
+
+        switch (format)
+        {
+            case Compressed_Image::ETC1_RGB:
+            case Compressed_Image::ETC2_RGB:
+            case Compressed_Image::ETC2_RGB_A1:
+            case Compressed_Image::ETC2_RGBA:   break;
+            default:                            return false;
+        }
+
+        color_buffer.resize (width, height);
+
+        Block_Pixels pixels;
+
+        for (unsigned block_y = 0; block_y < height; block_y += 4)
+        {
+            for (unsigned block_x = 0; block_x < width; block_x += 4)
+            {
+                if (eac_alpha)
+                {
+                    decode_color_block (data + 8, true, false, pixels);
+                    decode_alpha_block (data, pixels);
+
+                    data += 16;
+                }
+                else
+                {
+                    decode_color_block (data, etc2, punch_through, pixels);
+
+                    data += 8;
+                }
+
+                store_block (pixels, block_x, block_y, color_buffer, false);
+
+                if (alpha_data)
+                {
+                    decode_color_block (alpha_data, false, false, pixels);
+
+                    store_block (pixels, block_x, block_y, color_buffer, true);
+
+                    alpha_data += 8;
+                }
+            }
+        }
+
+        return true;
+    }
+
+}
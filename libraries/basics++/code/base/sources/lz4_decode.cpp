@@ -0,0 +1,103 @@
+/*
+ * LZ4 DECODE
+ * Copyright © 2018+ Ángel Rodríguez Ballesteros
+ *
+ * Distributed under the Boost Software License, version  1.0
+ * See documents/LICENSE.TXT or www.boost.org/LICENSE_1_0.txt
+ *
+ * angel.rodriguez@esne.edu
+ *
+ * C2610172324
+ */
+
+#include <cstring>
+#include <basics/lz4_decode>
+
+// Cada secuencia de un bloque LZ4 empieza con un token cuyos 4 bits altos son el número de literales
+// y los 4 bajos la longitud de la copia menos 4. El valor 15 indica que la longitud continúa en los
+// bytes siguientes (que se suman mientras valgan 255). Tras los literales van 2 bytes con la
+// distancia hacia atrás de la copia. La última secuencia solo tiene literales.
+
+namespace basics
+{
+
+    namespace
+    {
+
+        inline bool read_length (const byte *& in, const byte * end, size_t & length)
+        {
+            byte value;
+
+            do
+            {
+                if (in == end) return false;
+
+                value   = *in++;
+                length += value;
+            }
+            while (value == 255);
+
+            return true;
+        }
+
+    }
+
+    bool lz4_decode (const byte * source, size_t source_size, byte * target, size_t target_size)
+    {
+        const byte * in      = source;
+        const byte * in_end  = source + source_size;
+        byte       * out     = target;
+        byte       * out_end = target + target_size;
+
+        while (in < in_end)
+        {
+            unsigned token   = *in++;
+            size_t   literal = token >> 4;
+
+            if (literal == 15 && !read_length (in, in_end, literal)) return false;
+
+            if (size_t(in_end - in) < literal || size_t(out_end - out) < literal) return false;
+
+            std::memcpy (out, in, literal);
+
+            in  += literal;
+            out += literal;
+
+            if (in == in_end) break;
+
+            if (in_end - in < 2) return false;
+
+            size_t distance = size_t(in[0]) | (size_t(in[1]) << 8);
+            size_t length   = (token & 15) + 4;
+
+            in += 2;
+
+            if ((token & 15) == 15 && !read_length (in, in_end, length)) return false;
+
+            if (distance == 0 || distance > size_t(out - target) || size_t(out_end - out) < length) return false;
+
+            const byte * match = out - distance;
+
+            // La copia puede solaparse con lo que se está escribiendo (repeticiones de un patrón
+            // corto). Solo se puede usar memcpy() si no se solapa:
+
+            if (distance >= length)
+            {
+                std::memcpy (out, match, length);
+            }
+            else if (distance == 1)
+            {
+                std::memset (out, *match, length);
+            }
+            else
+            {
+                for (size_t i = 0; i < length; ++i) out[i] = match[i];
+            }
+
+            out += length;
+        }
+
+        return out == out_end;
+    }
+
+}
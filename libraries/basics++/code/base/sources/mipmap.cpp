@@ -0,0 +1,110 @@
+/*
+ * MIPMAP
+ * Copyright © 2018+ Ángel Rodríguez Ballesteros
+ *
+ * Distributed under the Boost Software License, version  1.0
+ * See documents/LICENSE.TXT or www.boost.org/LICENSE_1_0.txt
+ *
+ * angel.rodriguez@esne.edu
+ *
+ * C2610172210
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <basics/assert>
+#include <basics/mipmap>
+
+#if defined(__SSE2__)
+    #include <emmintrin.h>
+#elif defined(__ARM_NEON)
+    #include <arm_neon.h>
+#endif
+
+namespace basics
+{
+
+    void build_mip_level (const Color_Buffer< Rgba8888 > & source, Color_Buffer< Rgba8888 > & target)
+    {
+        assert(&source != &target);
+
+        unsigned source_width  = source.get_width  ();
+        unsigned source_height = source.get_height ();
+        unsigned target_width  = source_width  > 1 ? source_width  / 2 : 1;
+        unsigned target_height = source_height > 1 ? source_height / 2 : 1;
+
+        target.resize (target_width, target_height);
+
+        for (unsigned y = 0; y < target_height; ++y)
+        {
+            // Con un solo píxel de alto (o de ancho) se promedia el mismo píxel dos veces:
+
+            const byte * row_0  = reinterpret_cast< const byte * >(&source[std::min (y * 2,     source_height - 1) * source_width]);
+            const byte * row_1  = reinterpret_cast< const byte * >(&source[std::min (y * 2 + 1, source_height - 1) * source_width]);
+            byte       * output = reinterpret_cast<       byte * >(&target[y * target_width]);
+            unsigned     x      = 0;
+
+            if (source_width > 1)
+            {
+                #if defined(__SSE2__)
+
+                    // Se suman los canales en 16 bits: primero las dos filas y después cada píxel con
+                    // su vecino, que está en la otra mitad del registro. Así se obtiene el mismo
+                    // redondeo que en el bucle escalar:
+
+                    const __m128i zero     = _mm_setzero_si128 ();
+                    const __m128i rounding = _mm_set1_epi16 (2);
+
+                    for ( ; x + 2 <= target_width; x += 2)
+                    {
+                        __m128i top    = _mm_loadu_si128 (reinterpret_cast< const __m128i * >(row_0 + x * 8));
+                        __m128i bottom = _mm_loadu_si128 (reinterpret_cast< const __m128i * >(row_1 + x * 8));
+                        __m128i low    = _mm_add_epi16 (_mm_unpacklo_epi8 (top, zero), _mm_unpacklo_epi8 (bottom, zero));
+                        __m128i high   = _mm_add_epi16 (_mm_unpackhi_epi8 (top, zero), _mm_unpackhi_epi8 (bottom, zero));
+
+                        low  = _mm_add_epi16 (low,  _mm_srli_si128 (low,  8));
+                        high = _mm_add_epi16 (high, _mm_srli_si128 (high, 8));
+
+                        __m128i sum = _mm_srli_epi16 (_mm_add_epi16 (_mm_unpacklo_epi64 (low, high), rounding), 2);
+
+                        _mm_storel_epi64 (reinterpret_cast< __m128i * >(output + x * 4), _mm_packus_epi16 (sum, sum));
+                    }
+
+                #elif defined(__ARM_NEON)
+
+                    // vld2 separa los píxeles pares de los impares:
+
+                    for ( ; x + 4 <= target_width; x += 4)
+                    {
+                        uint32x4x2_t top    = vld2q_u32 (reinterpret_cast< const uint32_t * >(row_0 + x * 8));
+                        uint32x4x2_t bottom = vld2q_u32 (reinterpret_cast< const uint32_t * >(row_1 + x * 8));
+                        uint8x16_t   top_0  = vreinterpretq_u8_u32 (top   .val[0]);
+                        uint8x16_t   top_1  = vreinterpretq_u8_u32 (top   .val[1]);
+                        uint8x16_t   bot_0  = vreinterpretq_u8_u32 (bottom.val[0]);
+                        uint8x16_t   bot_1  = vreinterpretq_u8_u32 (bottom.val[1]);
+
+                        uint16x8_t   low    = vaddq_u16 (vaddl_u8 (vget_low_u8  (top_0), vget_low_u8  (top_1)), vaddl_u8 (vget_low_u8  (bot_0), vget_low_u8  (bot_1)));
+                        uint16x8_t   high   = vaddq_u16 (vaddl_u8 (vget_high_u8 (top_0), vget_high_u8 (top_1)), vaddl_u8 (vget_high_u8 (bot_0), vget_high_u8 (bot_1)));
+
+                        vst1q_u8 (output + x * 4, vcombine_u8 (vrshrn_n_u16 (low, 2), vrshrn_n_u16 (high, 2)));
+                    }
+
+                #endif
+            }
+
+            for ( ; x < target_width; ++x)
+            {
+                unsigned left  = std::min (x * 2,     source_width - 1) * 4;
+                unsigned right = std::min (x * 2 + 1, source_width - 1) * 4;
+
+                for (unsigned channel = 0; channel < 4; ++channel)
+                {
+                    unsigned sum = row_0[left + channel] + row_0[right + channel] + row_1[left + channel] + row_1[right + channel];
+
+                    output[x * 4 + channel] = byte((sum + 2) >> 2);
+                }
+            }
+        }
+    }
+
+}
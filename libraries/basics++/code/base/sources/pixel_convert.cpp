@@ -0,0 +1,419 @@
+/*
+ * PIXEL CONVERT
+ * Copyright © 2018+ Ángel Rodríguez Ballesteros
+ *
+ * Distributed under the Boost Software License, version  1.0
+ * See documents/LICENSE.TXT or www.boost.org/LICENSE_1_0.txt
+ *
+ * angel.rodriguez@esne.edu
+ *
+ * C2610172110
+ */
+
+#include <cstdint>
+#include <cstring>
+#include <basics/pixel_convert>
+
+#if defined(__SSE2__)
+    #include <emmintrin.h>
+#elif defined(__ARM_NEON)
+    #include <arm_neon.h>
+#endif
+
+// Todas las conversiones se hacen igual por SIMD y por el camino escalar que procesa los píxeles
+// sobrantes, de modo que el resultado no depende de la plataforma:
+//
+//  - Formatos de 16 bits: a cada canal se le suma (con saturación) un desplazamiento y se quedan
+//    sus bits altos. Sin tramado el desplazamiento es medio escalón, con lo que se redondea al más
+//    cercano. Con tramado es el umbral de la matriz de Bayer de 4x4 para la posición del píxel.
+//  - Luminancia: (77 r + 150 g + 29 b + 128) >> 8.
+//  - Premultiplicación: c * a / 255 redondeado, que sin dividir es (t + (t >> 8)) >> 8 con
+//    t = c * a + 128.
+
+namespace basics
+{
+
+    namespace
+    {
+
+        const unsigned bayer_matrix[4][4] =
+        {
+            {  0,  8,  2, 10 },
+            { 12,  4, 14,  6 },
+            {  3, 11,  1,  9 },
+            { 15,  7, 13,  5 },
+        };
+
+        /**
+         * Bits de cada canal (r, g, b, a) en un formato de 16 bits y posición de su bit más bajo.
+         */
+        struct Layout
+        {
+            unsigned bits    [4];
+            unsigned position[4];
+        };
+
+        const Layout layout_565  = { { 5, 6, 5, 0 }, { 11, 5, 0, 0 } };
+        const Layout layout_4444 = { { 4, 4, 4, 4 }, { 12, 8, 4, 0 } };
+        const Layout layout_5551 = { { 5, 5, 5, 1 }, { 11, 6, 1, 0 } };
+
+        /**
+         * Desplazamientos que se suman a los bytes de 4 píxeles seguidos (16 bytes) en cada una de
+         * las 4 filas del patrón de tramado.
+         */
+        typedef byte Offsets[4][16];
+
+        void make_offsets (const Layout & layout, bool dither, Offsets & offsets)
+        {
+            for (unsigned row = 0; row < 4; ++row)
+            {
+                for (unsigned pixel = 0; pixel < 4; ++pixel)
+                {
+                    for (unsigned channel = 0; channel < 4; ++channel)
+                    {
+                        unsigned bits   = layout.bits[channel];
+                        unsigned step   = bits ? 1u << (8 - bits) : 0;
+                        unsigned offset = dither ? bayer_matrix[row][pixel] * step / 16 : step / 2;
+
+                        // El alfa de un bit no se trama ni se redondea: se corta en la mitad.
+
+                        if (bits == 1) offset = 0;
+
+                        offsets[row][pixel * 4 + channel] = byte(offset);
+                    }
+                }
+            }
+        }
+
+        inline uint16_t pack_pixel (const byte * pixel, const byte * offsets, const Layout & layout)
+        {
+            unsigned result = 0;
+
+            for (unsigned channel = 0; channel < 4; ++channel)
+            {
+                unsigned bits = layout.bits[channel];
+
+                if (bits)
+                {
+                    unsigned value = pixel[channel] + offsets[channel];
+
+                    if (value > 255) value = 255;
+
+                    result |= (value >> (8 - bits)) << layout.position[channel];
+                }
+            }
+
+            return uint16_t(result);
+        }
+
+        inline byte premultiply (unsigned channel, unsigned alpha)
+        {
+            unsigned t = channel * alpha + 128;
+
+            return byte((t + (t >> 8)) >> 8);
+        }
+
+        inline byte luminance (const byte * pixel)
+        {
+            return byte((77 * pixel[0] + 150 * pixel[1] + 29 * pixel[2] + 128) >> 8);
+        }
+
+        void convert_to_16_bits (const Color_Buffer< Rgba8888 > & color_buffer, const Layout & layout, bool dither, uint16_t * target)
+        {
+            Offsets offsets;
+
+            make_offsets (layout, dither, offsets);
+
+            unsigned     width  = color_buffer.get_width  ();
+            unsigned     height = color_buffer.get_height ();
+            const byte * source = reinterpret_cast< const byte * >(color_buffer.buffer.data ());
+
+            #if defined(__SSE2__)
+
+                // Cada canal se aísla en los píxeles como uint32 y se lleva a su posición con un
+                // desplazamiento (a la izquierda el rojo, a la derecha el resto):
+
+                __m128i masks [4];
+                __m128i shifts[4];
+
+                for (unsigned channel = 0; channel < 4; ++channel)
+                {
+                    unsigned bits     = layout.bits[channel];
+                    uint32_t mask     = bits ? ((0xFFu << (8 - bits)) & 0xFFu) << (channel * 8) : 0;
+                    int      distance = int(layout.position[channel]) - int(8 - bits) - int(channel * 8);
+
+                    masks [channel] = _mm_set1_epi32 (int(mask));
+                    shifts[channel] = _mm_cvtsi32_si128 (distance < 0 ? -distance : distance);
+                }
+
+            #elif defined(__ARM_NEON)
+
+                uint8x16_t masks [4];
+                int16x8_t  shifts[4];
+
+                for (unsigned channel = 0; channel < 4; ++channel)
+                {
+                    unsigned bits = layout.bits[channel];
+
+                    masks [channel] = vdupq_n_u8  (byte(bits ? (0xFFu << (8 - bits)) & 0xFFu : 0));
+                    shifts[channel] = vdupq_n_s16 (int16_t(int(layout.position[channel]) - int(8 - bits)));
+                }
+
+            #endif
+
+            for (unsigned y = 0; y < height; ++y)
+            {
+                const byte * row_offsets = offsets[y & 3];
+                unsigned     x           = 0;
+
+                #if defined(__SSE2__)
+
+                    const __m128i offset_vector = _mm_loadu_si128 (reinterpret_cast< const __m128i * >(row_offsets));
+
+                    for ( ; x + 8 <= width; x += 8)
+                    {
+                        __m128i halves[2];
+
+                        for (unsigned half = 0; half < 2; ++half)
+                        {
+                            __m128i pixels = _mm_loadu_si128 (reinterpret_cast< const __m128i * >(source + (x + half * 4) * 4));
+                            __m128i packed = _mm_setzero_si128 ();
+
+                            pixels = _mm_adds_epu8 (pixels, offset_vector);
+
+                            for (unsigned channel = 0; channel < 4; ++channel)
+                            {
+                                if (!layout.bits[channel]) continue;
+
+                                __m128i value = _mm_and_si128 (pixels, masks[channel]);
+                                int     shift = int(layout.position[channel]) - int(8 - layout.bits[channel]) - int(channel * 8);
+
+                                value  = shift > 0 ? _mm_sll_epi32 (value, shifts[channel]) : _mm_srl_epi32 (value, shifts[channel]);
+                                packed = _mm_or_si128  (packed, value);
+                            }
+
+                            // _mm_packs_epi32() satura con signo. Extendiendo el signo de los 16 bits
+                            // bajos se conservan tal cual:
+
+                            halves[half] = _mm_srai_epi32 (_mm_slli_epi32 (packed, 16), 16);
+                        }
+
+                        _mm_storeu_si128 (reinterpret_cast< __m128i * >(target + x), _mm_packs_epi32 (halves[0], halves[1]));
+                    }
+
+                #elif defined(__ARM_NEON)
+
+                    uint8x16_t offset_vectors[4];
+
+                    for (unsigned channel = 0; channel < 4; ++channel)
+                    {
+                        byte channel_offsets[16];
+
+                        for (unsigned pixel = 0; pixel < 16; ++pixel) channel_offsets[pixel] = row_offsets[(pixel & 3) * 4 + channel];
+
+                        offset_vectors[channel] = vld1q_u8 (channel_offsets);
+                    }
+
+                    for ( ; x + 16 <= width; x += 16)
+                    {
+                        uint8x16x4_t pixels = vld4q_u8 (source + x * 4);
+                        uint16x8_t   low    = vdupq_n_u16 (0);
+                        uint16x8_t   high   = vdupq_n_u16 (0);
+
+                        for (unsigned channel = 0; channel < 4; ++channel)
+                        {
+                            if (!layout.bits[channel]) continue;
+
+                            uint8x16_t value = vandq_u8 (vqaddq_u8 (pixels.val[channel], offset_vectors[channel]), masks[channel]);
+
+                            low  = vorrq_u16 (low,  vshlq_u16 (vmovl_u8 (vget_low_u8  (value)), shifts[channel]));
+                            high = vorrq_u16 (high, vshlq_u16 (vmovl_u8 (vget_high_u8 (value)), shifts[channel]));
+                        }
+
+                        vst1q_u16 (target + x,     low );
+                        vst1q_u16 (target + x + 8, high);
+                    }
+
+                #endif
+
+                for ( ; x < width; ++x)
+                {
+                    target[x] = pack_pixel (source + x * 4, row_offsets + (x & 3) * 4, layout);
+                }
+
+                source += width * 4;
+                target += width;
+            }
+        }
+
+        void convert_to_alpha (const Color_Buffer< Rgba8888 > & color_buffer, byte * target)
+        {
+            size_t       count  = color_buffer.size ();
+            const byte * source = reinterpret_cast< const byte * >(color_buffer.buffer.data ());
+            size_t       index  = 0;
+
+            #if defined(__SSE2__)
+
+                for ( ; index + 16 <= count; index += 16)
+                {
+                    __m128i a[4];
+
+                    for (unsigned group = 0; group < 4; ++group)
+                    {
+                        a[group] = _mm_srli_epi32 (_mm_loadu_si128 (reinterpret_cast< const __m128i * >(source + (index + group * 4) * 4)), 24);
+                    }
+
+                    __m128i packed = _mm_packus_epi16 (_mm_packs_epi32 (a[0], a[1]), _mm_packs_epi32 (a[2], a[3]));
+
+                    _mm_storeu_si128 (reinterpret_cast< __m128i * >(target + index), packed);
+                }
+
+            #elif defined(__ARM_NEON)
+
+                for ( ; index + 16 <= count; index += 16)
+                {
+                    vst1q_u8 (target + index, vld4q_u8 (source + index * 4).val[3]);
+                }
+
+            #endif
+
+            for ( ; index < count; ++index) target[index] = source[index * 4 + 3];
+        }
+
+        void convert_to_luminance (const Color_Buffer< Rgba8888 > & color_buffer, byte * target)
+        {
+            size_t       count  = color_buffer.size ();
+            const byte * source = reinterpret_cast< const byte * >(color_buffer.buffer.data ());
+            size_t       index  = 0;
+
+            #if defined(__SSE2__)
+
+                // Los productos caben en los 16 bits bajos de cada píxel, así que basta con
+                // multiplicaciones de 16 bits:
+
+                const __m128i byte_mask = _mm_set1_epi32 (0xFF);
+                const __m128i r_weight  = _mm_set1_epi32 (77);
+                const __m128i g_weight  = _mm_set1_epi32 (150);
+                const __m128i b_weight  = _mm_set1_epi32 (29);
+                const __m128i rounding  = _mm_set1_epi32 (128);
+
+                for ( ; index + 16 <= count; index += 16)
+                {
+                    __m128i l[4];
+
+                    for (unsigned group = 0; group < 4; ++group)
+                    {
+                        __m128i pixels = _mm_loadu_si128 (reinterpret_cast< const __m128i * >(source + (index + group * 4) * 4));
+                        __m128i r      = _mm_and_si128 (pixels, byte_mask);
+                        __m128i g      = _mm_and_si128 (_mm_srli_epi32 (pixels,  8), byte_mask);
+                        __m128i b      = _mm_and_si128 (_mm_srli_epi32 (pixels, 16), byte_mask);
+                        __m128i sum    = _mm_add_epi32 (_mm_mullo_epi16 (r, r_weight), _mm_mullo_epi16 (g, g_weight));
+
+                        sum      = _mm_add_epi32 (sum, _mm_mullo_epi16 (b, b_weight));
+                        l[group] = _mm_srli_epi32 (_mm_add_epi32 (sum, rounding), 8);
+                    }
+
+                    __m128i packed = _mm_packus_epi16 (_mm_packs_epi32 (l[0], l[1]), _mm_packs_epi32 (l[2], l[3]));
+
+                    _mm_storeu_si128 (reinterpret_cast< __m128i * >(target + index), packed);
+                }
+
+            #elif defined(__ARM_NEON)
+
+                for ( ; index + 8 <= count; index += 8)
+                {
+                    uint8x8x4_t pixels = vld4_u8 (source + index * 4);
+                    uint16x8_t  sum    = vmull_u8 (pixels.val[0], vdup_n_u8 (77));
+
+                    sum = vmlal_u8 (sum, pixels.val[1], vdup_n_u8 (150));
+                    sum = vmlal_u8 (sum, pixels.val[2], vdup_n_u8 (29));
+
+                    vst1_u8 (target + index, vrshrn_n_u16 (sum, 8));
+                }
+
+            #endif
+
+            for ( ; index < count; ++index) target[index] = luminance (source + index * 4);
+        }
+
+    }
+
+    void convert_pixels (const Color_Buffer< Rgba8888 > & color_buffer, Pixel_Format format, bool dither, byte * target)
+    {
+        switch (format)
+        {
+            case RGBA_8888:   std::memcpy (target, color_buffer.buffer.data (), color_buffer.size () * sizeof(Rgba8888)); break;
+            case RGB_565:     convert_to_16_bits (color_buffer, layout_565,  dither, reinterpret_cast< uint16_t * >(target)); break;
+            case RGBA_4444:   convert_to_16_bits (color_buffer, layout_4444, dither, reinterpret_cast< uint16_t * >(target)); break;
+            case RGBA_5551:   convert_to_16_bits (color_buffer, layout_5551, dither, reinterpret_cast< uint16_t * >(target)); break;
+            case ALPHA_8:     convert_to_alpha     (color_buffer, target); break;
+            case LUMINANCE_8: convert_to_luminance (color_buffer, target); break;
+        }
+    }
+
+
+    void premultiply_alpha (Color_Buffer< Rgba8888 > & color_buffer)
+    {
+        size_t count  = color_buffer.size ();
+        byte * pixels = color_buffer;
+        size_t index  = 0;
+
+        #if defined(__SSE2__)
+
+            // Cada mitad del registro tiene dos píxeles en 16 bits. El alfa se reparte por los cuatro
+            // canales de su píxel y se multiplica también por sí mismo (a * 255 / 255 = a), aunque
+            // luego se vuelve a poner el original:
+
+            const __m128i zero       = _mm_setzero_si128 ();
+            const __m128i rounding   = _mm_set1_epi16 (128);
+            const __m128i alpha_mask = _mm_set1_epi32 (int(0xFF000000));
+
+            for ( ; index + 4 <= count; index += 4)
+            {
+                __m128i source = _mm_loadu_si128 (reinterpret_cast< const __m128i * >(pixels + index * 4));
+                __m128i halves[2] = { _mm_unpacklo_epi8 (source, zero), _mm_unpackhi_epi8 (source, zero) };
+
+                for (__m128i & half : halves)
+                {
+                    __m128i alpha = _mm_shufflehi_epi16 (_mm_shufflelo_epi16 (half, 0xFF), 0xFF);
+                    __m128i t     = _mm_add_epi16 (_mm_mullo_epi16 (half, alpha), rounding);
+
+                    half = _mm_srli_epi16 (_mm_add_epi16 (t, _mm_srli_epi16 (t, 8)), 8);
+                }
+
+                __m128i result = _mm_packus_epi16 (halves[0], halves[1]);
+
+                result = _mm_or_si128 (_mm_andnot_si128 (alpha_mask, result), _mm_and_si128 (alpha_mask, source));
+
+                _mm_storeu_si128 (reinterpret_cast< __m128i * >(pixels + index * 4), result);
+            }
+
+        #elif defined(__ARM_NEON)
+
+            for ( ; index + 8 <= count; index += 8)
+            {
+                uint8x8x4_t source = vld4_u8 (pixels + index * 4);
+
+                for (unsigned channel = 0; channel < 3; ++channel)
+                {
+                    uint16x8_t product = vmull_u8 (source.val[channel], source.val[3]);
+
+                    source.val[channel] = vrshrn_n_u16 (vrsraq_n_u16 (product, product, 8), 8);
+                }
+
+                vst4_u8 (pixels + index * 4, source);
+            }
+
+        #endif
+
+        for ( ; index < count; ++index)
+        {
+            byte * pixel = pixels + index * 4;
+
+            pixel[0] = premultiply (pixel[0], pixel[3]);
+            pixel[1] = premultiply (pixel[1], pixel[3]);
+            pixel[2] = premultiply (pixel[2], pixel[3]);
+        }
+    }
+
+}
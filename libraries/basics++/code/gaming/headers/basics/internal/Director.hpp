@@ -29,6 +29,15 @@
 
             typedef bool (* Graphics_Context_Factory) (Window::Accessor & window, Graphics_Resource_Cache * cache);
 
+            /**
+             * Contadores de fotogramas desde que se inició el kernel.
+             */
+            struct Frame_Statistics
+            {
+                unsigned rendered_frames;       ///< Fotogramas dibujados y presentados.
+                unsigned skipped_frames;        ///< Fotogramas omitidos porque la escena no había cambiado.
+            };
+
         public:
 
             static Director & get_instance ()
@@ -70,6 +79,8 @@
             Graphics_Context_Factory graphics_context_factory;
             Graphics_Resource_Cache  graphics_resource_cache;
 
+            Frame_Statistics         frame_statistics;
+
         private:
 
             Director();
@@ -97,6 +108,11 @@
                 event_queue.push (event);
             }
 
+            const Frame_Statistics & get_frame_statistics () const
+            {
+                return frame_statistics;
+            }
+
         private:
 
             void run_kernel ();
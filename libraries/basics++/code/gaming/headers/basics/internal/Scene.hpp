@@ -13,6 +13,7 @@
 #ifndef BASICS_SCENE_HEADER
 #define BASICS_SCENE_HEADER
 
+    #include <basics/Asset_Prefetcher>
     #include <basics/Event>
     #include <basics/Graphics_Context>
     #include <basics/Size>
@@ -22,15 +23,24 @@
 
         class Scene
         {
+
+            friend class Director;
+
         private:
 
             float frame_duration;
+            bool  render_on_demand;             ///< Si es true solo se dibuja cuando la escena ha cambiado.
+            bool  dirty;                        ///< Indica si hay cambios pendientes de dibujar.
+
+            Asset_Prefetcher::Request_List successor_assets;     ///< Assets de las escenas que pueden venir después.
 
         public:
 
             Scene()
             {
-                frame_duration = -1.f;
+                frame_duration   = -1.f;
+                render_on_demand = false;
+                dirty            = true;
             }
 
             virtual ~Scene() = default;
@@ -60,6 +70,58 @@
                 return frame_duration;
             }
 
+        public:
+
+            /**
+             * En modo de dibujado bajo demanda Director no llama a render() ni presenta el fotograma
+             * mientras la escena no se marque como cambiada con invalidate(). Los eventos de entrada,
+             * los cambios de viewport y la reanudación de la escena la marcan automáticamente.
+             */
+            void set_render_on_demand (bool enabled)
+            {
+                render_on_demand = enabled;
+                dirty            = true;
+            }
+
+            bool is_render_on_demand () const
+            {
+                return render_on_demand;
+            }
+
+            /**
+             * Indica que el aspecto de la escena ha cambiado y que debe volver a dibujarse.
+             */
+            void invalidate ()
+            {
+                dirty = true;
+            }
+
+            bool needs_render () const
+            {
+                return dirty || !render_on_demand;
+            }
+
+        protected:
+
+            /**
+             * Declara los assets de una escena a la que se puede pasar desde esta. Normalmente se llama
+             * en el constructor con los assets que la escena siguiente carga en su initialize().
+             */
+            void add_successor_assets (const Asset_Prefetcher::Request_List & assets)
+            {
+                successor_assets.insert (successor_assets.end (), assets.begin (), assets.end ());
+            }
+
+            /**
+             * Pide a Asset_Prefetcher que prepare en segundo plano los assets de las escenas siguientes.
+             * Conviene llamarla cuando la escena ha terminado de cargar lo suyo, para no competir con
+             * su propia carga.
+             */
+            void prefetch_successors ()
+            {
+                Asset_Prefetcher::get_instance ().prefetch (successor_assets);
+            }
+
         };
 
     }
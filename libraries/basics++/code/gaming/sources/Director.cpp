@@ -11,6 +11,9 @@
  */
 
 #include <basics/Application>
+#include <chrono>
+#include <thread>
+#include <basics/Asset_Prefetcher>
 #include <basics/Director>
 #include <basics/Log>
 #include <basics/Scene>
@@ -30,6 +33,7 @@ namespace basics
     {
         kernel.running           = false;
         graphics_context_factory = opengles::Context::create;
+        frame_statistics         = Frame_Statistics();
     }
 
     // ---------------------------------------------------------------------------------------------
@@ -69,8 +73,9 @@ namespace basics
 
     void Director::run_kernel ()
     {
-        kernel.running = true;
-        kernel.exit    = false;
+        kernel.running   = true;
+        kernel.exit      = false;
+        frame_statistics = Frame_Statistics();
 
         Window::Handle window_handle;
 
@@ -164,6 +169,8 @@ namespace basics
                             reset_viewport (window);
 
                             state.graphics = true;
+
+                            if (current_scene) current_scene->invalidate ();
                         }
 
                         break;
@@ -181,6 +188,8 @@ namespace basics
 
                         reset_viewport  (window);
 
+                        if (current_scene) current_scene->invalidate ();
+
                         break;
                     }
 
@@ -206,7 +215,14 @@ namespace basics
                             case Window::LOST_FOCUS:            state.focused = false;   break;
                             case Window::LOST_GRAPHICS_CONTEXT:                          break;
                             case Window::RESIZED:
-                            case Window::VIEWPORT_RESIZED:      reset_viewport (window); break;
+                            case Window::VIEWPORT_RESIZED:
+                            {
+                                reset_viewport (window);
+
+                                if (current_scene) current_scene->invalidate ();
+
+                                break;
+                            }
                         }
                     }
 
@@ -217,6 +233,13 @@ namespace basics
                         if (!previously_active &&  currently_active) current_scene->resume  (); else
                         if ( previously_active && !currently_active) current_scene->suspend ();
 
+                        // The surface contents can't be trusted after a scene change or a resume:
+
+                        if (reset_canvas || (!previously_active && currently_active))
+                        {
+                            current_scene->invalidate ();
+                        }
+
                         if (currently_active)
                         {
                             Size2u scene_view_size = current_scene->get_view_size ();
@@ -242,25 +265,63 @@ namespace basics
                                     }
                                 }
 
+                                // Any input may change what the scene shows:
+
+                                current_scene->invalidate ();
                                 current_scene->handle (event);
                             }
 
                             current_scene->update (time);
 
+                            // A scene rendering on demand with nothing new to show keeps the last frame
+                            // on screen. The swap is skipped too, so the frame time is slept instead of
+                            // being paced by the display:
+
+                            if (!current_scene->needs_render ())
+                            {
+                                frame_statistics.skipped_frames++;
+
+                                float frame_duration = current_scene->get_frame_duration ();
+
+                                if (frame_duration <= 0.f) frame_duration = 1.f / 60.f;
+
+                                float remaining = frame_duration - timer.get_elapsed_seconds ();
+
+                                if (remaining > 0.f)
+                                {
+                                    std::this_thread::sleep_for (std::chrono::duration< float >(remaining));
+                                }
+
+                                time = timer.get_elapsed_seconds ();
+
+                                continue;
+                            }
+
                             Graphics_Context::Accessor graphics_context = window->lock_graphics_context ();
 
                             if (graphics_context)
                             {
-                                if (reset_canvas)
-                                {
-                                    Canvas * canvas = graphics_context->get_renderer< Canvas > (ID(canvas));
+                                Canvas * canvas = graphics_context->get_renderer< Canvas > (ID(canvas));
 
-                                    if (canvas) canvas->reset_state ();
+                                if (canvas && reset_canvas)
+                                {
+                                    canvas->reset_state ();
                                 }
 
                                 current_scene->render (graphics_context);
 
+                                // The scene may have created the canvas while rendering, and whatever it
+                                // left batched must reach the GPU before the buffers are swapped:
+
+                                if (!canvas) canvas = graphics_context->get_renderer< Canvas > (ID(canvas));
+
+                                if (canvas) canvas->end_frame ();
+
                                 graphics_context->flush_and_display ();
+
+                                current_scene->dirty = false;
+
+                                frame_statistics.rendered_frames++;
                             }
                         }
                     }
@@ -275,6 +336,11 @@ namespace basics
 
         current_scene.reset ();
 
+        // The prefetcher thread is stopped here rather than when the static objects are destroyed,
+        // as by then the assets and the log it uses may be gone:
+
+        Asset_Prefetcher::get_instance ().stop ();
+
         kernel.running = false;
     }
 
@@ -0,0 +1,62 @@
+/*
+ *  AFFINE KERNEL
+ *  Copyright © 2018+ Ángel Rodríguez Ballesteros
+ *
+ *  Distributed under the Boost Software License, version  1.0
+ *  See documents/LICENSE.TXT or www.boost.org/LICENSE_1_0.txt
+ *
+ *  angel.rodriguez@esne.edu
+ *
+ *  C2610171910
+ */
+
+#ifndef BASICS_AFFINE_KERNEL_HEADER
+#define BASICS_AFFINE_KERNEL_HEADER
+
+    #include <cstddef>
+    #include "Float4.hpp"
+    #include "Transformation.hpp"
+
+    namespace basics
+    {
+
+        /**
+         * Aplica la parte afín (2x3) de una transformación 2D a una serie de puntos guardados como
+         * pares (x, y) consecutivos. Se transforman dos puntos por registro.
+         * @param transform Transformación. Se ignora su última fila.
+         * @param input Coordenadas de entrada (2 * count floats).
+         * @param output Coordenadas de salida (2 * count floats). Puede ser igual a input.
+         * @param count Número de puntos.
+         */
+        inline void transform_points_2d (const Transformation2f & transform, const float * input, float * output, size_t count)
+        {
+            const float * m = transform.matrix.values;
+
+            // Para dos puntos (x0, y0, x1, y1): resultado = even * (a, c, a, c) + odd * (b, d, b, d) + (tx, ty, tx, ty)
+
+            const Float4 column_x   (m[0], m[3], m[0], m[3]);
+            const Float4 column_y   (m[1], m[4], m[1], m[4]);
+            const Float4 translation(m[2], m[5], m[2], m[5]);
+
+            size_t index = 0;
+
+            for ( ; index + 2 <= count; index += 2, input += 4, output += 4)
+            {
+                Float4 points = Float4::load (input);
+
+                Float4::multiply_add (points.even (), column_x, Float4::multiply_add (points.odd (), column_y, translation)).store (output);
+            }
+
+            if (index < count)
+            {
+                float x = input[0];
+                float y = input[1];
+
+                output[0] = m[0] * x + m[1] * y + m[2];
+                output[1] = m[3] * x + m[4] * y + m[5];
+            }
+        }
+
+    }
+
+#endif
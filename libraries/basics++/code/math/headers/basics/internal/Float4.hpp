@@ -0,0 +1,145 @@
+/*
+ *  FLOAT 4
+ *  Copyright © 2018+ Ángel Rodríguez Ballesteros
+ *
+ *  Distributed under the Boost Software License, version  1.0
+ *  See documents/LICENSE.TXT or www.boost.org/LICENSE_1_0.txt
+ *
+ *  angel.rodriguez@esne.edu
+ *
+ *  C2610171900
+ */
+
+#ifndef BASICS_FLOAT4_HEADER
+#define BASICS_FLOAT4_HEADER
+
+    #if   defined(__ARM_NEON) || defined(__ARM_NEON__)
+        #define BASICS_FLOAT4_NEON
+        #include <arm_neon.h>
+    #elif defined(__SSE__)
+        #define BASICS_FLOAT4_SSE
+        #include <xmmintrin.h>
+    #endif
+
+    namespace basics
+    {
+
+        /**
+         * Envoltorio portable de un registro de cuatro floats. Usa NEON o SSE cuando el compilador
+         * los tiene activados y cuatro floats normales en otro caso, por lo que el código que lo usa
+         * no necesita distinguir plataformas.
+         */
+        class Float4
+        {
+        public:
+
+            #if   defined(BASICS_FLOAT4_NEON)
+                typedef float32x4_t Native;
+            #elif defined(BASICS_FLOAT4_SSE)
+                typedef __m128      Native;
+            #else
+                struct Native { float values[4]; };
+            #endif
+
+        public:
+
+            Native value;
+
+        public:
+
+            Float4() = default;
+
+            Float4(const Native & value) : value(value)
+            {
+            }
+
+            Float4(float a, float b, float c, float d)
+            {
+                #if   defined(BASICS_FLOAT4_NEON)
+                    const float values[] = { a, b, c, d };
+                    value = vld1q_f32 (values);
+                #elif defined(BASICS_FLOAT4_SSE)
+                    value = _mm_setr_ps (a, b, c, d);
+                #else
+                    value.values[0] = a; value.values[1] = b; value.values[2] = c; value.values[3] = d;
+                #endif
+            }
+
+        public:
+
+            /**
+             * Lee cuatro floats consecutivos. No necesitan estar alineados.
+             */
+            static Float4 load (const float * values)
+            {
+                #if   defined(BASICS_FLOAT4_NEON)
+                    return vld1q_f32 (values);
+                #elif defined(BASICS_FLOAT4_SSE)
+                    return _mm_loadu_ps (values);
+                #else
+                    return Float4(values[0], values[1], values[2], values[3]);
+                #endif
+            }
+
+            void store (float * values) const
+            {
+                #if   defined(BASICS_FLOAT4_NEON)
+                    vst1q_f32 (values, value);
+                #elif defined(BASICS_FLOAT4_SSE)
+                    _mm_storeu_ps (values, value);
+                #else
+                    for (unsigned i = 0; i < 4; ++i) values[i] = value.values[i];
+                #endif
+            }
+
+        public:
+
+            /**
+             * @return (a0, a0, a2, a2)
+             */
+            Float4 even () const
+            {
+                #if   defined(BASICS_FLOAT4_NEON)
+                    return vtrnq_f32 (value, value).val[0];
+                #elif defined(BASICS_FLOAT4_SSE)
+                    return _mm_shuffle_ps (value, value, _MM_SHUFFLE(2, 2, 0, 0));
+                #else
+                    return Float4(value.values[0], value.values[0], value.values[2], value.values[2]);
+                #endif
+            }
+
+            /**
+             * @return (a1, a1, a3, a3)
+             */
+            Float4 odd () const
+            {
+                #if   defined(BASICS_FLOAT4_NEON)
+                    return vtrnq_f32 (value, value).val[1];
+                #elif defined(BASICS_FLOAT4_SSE)
+                    return _mm_shuffle_ps (value, value, _MM_SHUFFLE(3, 3, 1, 1));
+                #else
+                    return Float4(value.values[1], value.values[1], value.values[3], value.values[3]);
+                #endif
+            }
+
+            /**
+             * @return a * b + c
+             */
+            static Float4 multiply_add (const Float4 & a, const Float4 & b, const Float4 & c)
+            {
+                #if   defined(BASICS_FLOAT4_NEON)
+                    return vmlaq_f32 (c.value, a.value, b.value);
+                #elif defined(BASICS_FLOAT4_SSE)
+                    return _mm_add_ps (_mm_mul_ps (a.value, b.value), c.value);
+                #else
+                    Float4 result;
+                    for (unsigned i = 0; i < 4; ++i) result.value.values[i] = a.value.values[i] * b.value.values[i] + c.value.values[i];
+                    return result;
+                #endif
+            }
+
+        };
+
+    }
+
+#endif
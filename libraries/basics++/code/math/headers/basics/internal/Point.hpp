@@ -26,7 +26,7 @@
             typedef NUMERIC_TYPE Numeric_Type;
             typedef Numeric_Type Number;
 
-            typedef Coordinates< DIMENSION, NUMERIC_TYPE, COORDINATE_SYSTEM > Coordinates;
+            typedef basics::Coordinates< DIMENSION, NUMERIC_TYPE, COORDINATE_SYSTEM > Coordinates;
 
         public:
 
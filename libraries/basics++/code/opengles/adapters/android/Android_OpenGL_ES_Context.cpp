@@ -185,7 +185,7 @@
             {
                 EGL_ATTRIBUTE( EGL_RENDERABLE_TYPE, EGL_OPENGL_ES2_BIT ),
                 EGL_ATTRIBUTE( EGL_SURFACE_TYPE,    EGL_WINDOW_BIT     ),
-                EGL_ATTRIBUTE( EGL_DEPTH_SIZE,      0                  ),
+                EGL_ATTRIBUTE( EGL_DEPTH_SIZE,      16                 ),
                 EGL_NONE
             };
 
@@ -14,22 +14,73 @@
 #define BASICS_OPENGLES_CANVAS_ES2_HEADER
 
     #include <memory>
+    #include <vector>
     #include <basics/Canvas>
+    #include <basics/Render_Command_List>
     #include <basics/Transformation>
 
     namespace basics { namespace opengles
     {
 
+        class Index_Buffer;
         class Shader_Program;
+        class Texture_2D;
+        class Vertex_Buffer_Ring;
 
         class Canvas_ES2 : public basics::Canvas
         {
+        public:
+
+            static constexpr unsigned max_batch_quads        = 2048;    ///< Quads por lote antes de forzar un flush.
+            static constexpr unsigned max_instances_per_draw = 1024;    ///< Instancias que se envían en cada llamada de draw_instances().
+
+        private:
+
+            /**
+             * Vértice de un quad texturizado tal y como se guarda en el lote (posición, profundidad, uv
+             * y factor de mezcla intercalados). La profundidad solo se usa en el pase de quads opacos.
+             */
+            struct Vertex
+            {
+                float x, y, z;
+                float u, v;
+                float blend;                    ///< 1 con la transparencia normal y 0 con la mezcla aditiva.
+            };
+
+            typedef std::vector< Vertex > Vertex_List;
+
+            /**
+             * Datos de una instancia tal y como los lee el shader de instancias (rectángulo, rectángulo
+             * de uvs y opacidad).
+             */
+            struct Instance_Data
+            {
+                float x, y, width, height;
+                float u0, v0, u1, v1;
+                float opacity;
+            };
+
+            /**
+             * Vértice con los datos de su instancia copiados. Se usa cuando el contexto no permite
+             * dibujar con instancias y hay que expandir cada instancia a un quad.
+             */
+            struct Instance_Vertex
+            {
+                float         corner_x, corner_y;
+                Instance_Data instance;
+            };
+
+            typedef std::vector< Instance_Data   > Instance_Data_List;
+            typedef std::vector< Instance_Vertex > Instance_Vertex_List;
+
         private:
 
             static const char * internal_vertex_shader_f;
             static const char * internal_vertex_shader_t;
             static const char * internal_fragment_shader_f;
             static const char * internal_fragment_shader_t;
+            static const char * internal_vertex_shader_i;
+            static const char * internal_fragment_shader_i;
 
         public:
 
@@ -49,22 +100,62 @@
 
             Transformation2f transform;
             Transformation2f projection;
+            float            opacity;
+            Blending         blending;
 
             std::shared_ptr< Shader_Program > shader_program_f;
             std::shared_ptr< Shader_Program > shader_program_t;
+            std::shared_ptr< Shader_Program > shader_program_i;
 
             int  transform_f_id;
             int projection_f_id;
             int      color_f_id;
             int    opacity_f_id;
+            int      blend_f_id;
             int  transform_t_id;
             int projection_t_id;
             int    sampler_t_id;
             int    opacity_t_id;
+            int alpha_plane_t_id;
+            int  alpha_only_t_id;
+            int premultiplied_t_id;
+            int  transform_i_id;
+            int projection_i_id;
+            int    sampler_i_id;
+            int    opacity_i_id;
+            int alpha_plane_i_id;
+            int  alpha_only_i_id;
+            int premultiplied_i_id;
+            int      blend_i_id;
 
             unsigned   vertex_position_location_f;
             unsigned   vertex_position_location_t;
             unsigned vertex_texture_uv_location_t;
+            unsigned      vertex_blend_location_t;
+            unsigned     vertex_corner_location_i;
+            unsigned     instance_rect_location_i;
+            unsigned  instance_uv_rect_location_i;
+            unsigned  instance_opacity_location_i;
+
+            std::shared_ptr< Vertex_Buffer_Ring > vertex_buffer_ring;      ///< VBOs donde se sube la geometría de cada draw.
+            std::shared_ptr< Index_Buffer       > quad_index_buffer;       ///< IBO estático con los índices de max_batch_quads quads.
+
+            bool                 batching;              ///< Si es false cada quad se envía en cuanto se añade.
+            Vertex_List          batch_vertices;        ///< Quads acumulados pendientes de dibujar.
+            const Texture_2D   * batch_texture;         ///< Textura que usan todos los quads del lote.
+
+            bool                 sorting;               ///< Si es true los quads se ordenan antes de dibujarse.
+            int                  layer;                 ///< Capa en la que se registran los siguientes quads.
+            bool                 transform_baking;      ///< Si es true los quads se transforman en la CPU.
+            Render_Command_List  commands;              ///< Quads registrados pendientes de ordenar.
+
+            bool                 opaque_pass;           ///< Si es true los quads opacos se dibujan antes y sin mezcla.
+            unsigned             opaque_commands;       ///< Comandos opacos en la lista pendiente.
+            unsigned             depth_capacity;        ///< Valores de profundidad distintos que admite el buffer (0 si no hay).
+            unsigned             depth_base;            ///< Primer valor de profundidad libre desde que se limpió el buffer.
+
+            Instance_Data_List   instance_data;         ///< Instancias de la llamada actual de draw_instances().
+            Instance_Vertex_List instance_vertices;     ///< Instancias expandidas cuando no hay dibujado con instancias.
 
         public:
 
@@ -73,6 +164,11 @@
         public:
 
             void reset_state     () override;
+            void set_batching    (bool enabled) override;
+            void flush           () override;
+            void set_sorting     (bool enabled) override;
+            void set_layer       (int  layer  ) override;
+            void dump_commands   (std::ostream & output) override;
 
         public:
 
@@ -83,8 +179,11 @@
             void set_clear_color (float r, float g, float b) override;
             void set_color       (float r, float g, float b) override;
             void set_opacity     (float opacity) override;
+            void set_blending    (Blending blending) override;
             void set_transform   (const Transformation2f & transform) override;
             void apply_transform (const Transformation2f & transform) override;
+            void set_transform_baking (bool enabled) override;
+            void set_opaque_pass (bool enabled) override;
 
         public:
 
@@ -97,6 +196,30 @@
             void fill_rectangle  (const Point2f & bottom_left, const Size2f & size) override;
             void fill_rectangle  (const Point2f & where, const Size2f & size, const basics::Texture_2D * texture, int handling = CENTER) override;
             void fill_rectangle  (const Point2f & where, const Size2f & size, const Atlas::Slice * slice, int handling = CENTER) override;
+            void draw_instances  (const basics::Texture_2D * texture, const Instance * instances, size_t count, int handling = CENTER) override;
+            void draw_text       (const Point2f & where, const Text_Layout & text_layout, int handling = TOP | LEFT) override;
+
+        private:
+
+            void record_quad     (const Texture_2D * texture, const Point2f & bottom_left, const Size2f & size, const Point2f * texture_uvs);
+            void record_quad     (const Texture_2D * texture, float * positions, const Point2f * texture_uvs);
+            void submit_commands ();
+            void add_quad        (const Texture_2D * texture, const float * positions, const Point2f * texture_uvs, float depth = 0.f, float blend = 1.f);
+            float get_area_scale () const;
+            void flush_batch     ();
+            void draw_flat       (unsigned mode, const Point2f * coordinates, unsigned count);
+            void draw_instanced  ();
+            void draw_expanded   ();
+            void draw_vertex_block (const Texture_2D * texture, const Text_Layout::Vertex * vertices, size_t vertex_count, const Transformation2f & block_transform, float area, float blend);
+
+            /**
+             * Con GL_ONE y GL_ONE_MINUS_SRC_ALPHA, un fragmento cuyo alfa se multiplica por 0 se suma
+             * a lo que tiene detrás.
+             */
+            float get_blend_factor () const
+            {
+                return blending == ADD ? 0.f : 1.f;
+            }
 
         };
 
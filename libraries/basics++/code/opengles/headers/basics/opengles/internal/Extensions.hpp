@@ -0,0 +1,74 @@
+/*
+ * EXTENSIONS
+ * Copyright © 2018+ Ángel Rodríguez Ballesteros
+ *
+ * Distributed under the Boost Software License, version 1.0
+ * See the LICENSE file or www.boost.org/LICENSE_1_0.txt
+ *
+ * angel.rodriguez@esne.edu
+ *
+ * C2610171800
+ */
+
+#ifndef BASICS_OPENGLES_EXTENSIONS_HEADER
+#define BASICS_OPENGLES_EXTENSIONS_HEADER
+
+    #include <basics/Non_Instantiable>
+    #include <basics/opengles/OpenGL_ES2>
+
+    namespace basics { namespace opengles
+    {
+
+        /**
+         * Funciones que no forman parte de OpenGL ES 2 y que se obtienen en tiempo de ejecución cuando
+         * el contexto las ofrece, ya sea porque es OpenGL ES 3 o a través de una extensión. Se debe
+         * llamar a load() con el contexto activo antes de usarlas.
+         */
+        class Extensions : Non_Instantiable
+        {
+        public:
+
+            typedef void (GL_APIENTRYP Draw_Arrays_Instanced) (GLenum mode, GLint first, GLsizei count, GLsizei instance_count);
+            typedef void (GL_APIENTRYP Vertex_Attrib_Divisor) (GLuint index, GLuint divisor);
+
+        public:
+
+            static Draw_Arrays_Instanced draw_arrays_instanced;     ///< glDrawArraysInstanced() o equivalente.
+            static Vertex_Attrib_Divisor vertex_attrib_divisor;     ///< glVertexAttribDivisor() o equivalente.
+
+        public:
+
+            /**
+             * Busca las funciones en el contexto activo. Las que no están disponibles quedan a nullptr.
+             */
+            static void load ();
+
+            static bool has_instancing ()
+            {
+                return draw_arrays_instanced && vertex_attrib_divisor;
+            }
+
+            /**
+             * @return true si el contexto activo anuncia la extensión indicada.
+             */
+            static bool has_extension (const char * name);
+
+            /**
+             * @return true si el contexto activo es de OpenGL ES 3 o posterior.
+             */
+            static bool is_es3 ();
+
+            /**
+             * OpenGL ES 2 solo admite mipmaps en texturas cuyos lados son potencias de 2, salvo que el
+             * contexto sea de OpenGL ES 3 o anuncie GL_OES_texture_npot.
+             */
+            static bool has_npot_mipmaps ()
+            {
+                return is_es3 () || has_extension ("GL_OES_texture_npot");
+            }
+
+        };
+
+    }}
+
+#endif
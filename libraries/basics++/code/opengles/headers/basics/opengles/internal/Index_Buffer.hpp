@@ -0,0 +1,88 @@
+/*
+ * INDEX BUFFER
+ * Copyright © 2018+ Ángel Rodríguez Ballesteros
+ *
+ * Distributed under the Boost Software License, version 1.0
+ * See the LICENSE file or www.boost.org/LICENSE_1_0.txt
+ *
+ * angel.rodriguez@esne.edu
+ *
+ * C2610171215
+ */
+
+#ifndef BASICS_OPENGLES_INDEX_BUFFER_HEADER
+#define BASICS_OPENGLES_INDEX_BUFFER_HEADER
+
+    #include <vector>
+    #include <basics/Graphics_Resource>
+    #include <basics/opengles/OpenGL_ES2>
+    #include <basics/opengles/State_Cache>
+
+    namespace basics { namespace opengles
+    {
+
+        /**
+         * Buffer de índices inmutable que reside en la memoria de la GPU. Se conserva una copia de
+         * los índices para poder volver a crearlo si se pierde el contexto gráfico.
+         */
+        class Index_Buffer : public Graphics_Resource
+        {
+        private:
+
+            std::vector< GLushort > indices;
+            GLuint                  buffer_object_id;
+
+        public:
+
+            Index_Buffer(const std::vector< GLushort > & indices)
+            :
+                indices         (indices),
+                buffer_object_id(0)
+            {
+            }
+
+            Index_Buffer(const Index_Buffer & ) = delete;
+
+           ~Index_Buffer()
+            {
+                finalize ();
+            }
+
+        public:
+
+            bool initialize () override;
+
+            void finalize () override
+            {
+                if (initialized)
+                {
+                    glDeleteBuffers (1, &buffer_object_id);
+
+                    State_Cache::forget_buffer (buffer_object_id);
+
+                    initialized = false;
+                }
+            }
+
+        public:
+
+            bool is_usable () const
+            {
+                return initialized;
+            }
+
+            size_t size () const
+            {
+                return indices.size ();
+            }
+
+            void use () const
+            {
+                State_Cache::bind_buffer (GL_ELEMENT_ARRAY_BUFFER, buffer_object_id);
+            }
+
+        };
+
+    }}
+
+#endif
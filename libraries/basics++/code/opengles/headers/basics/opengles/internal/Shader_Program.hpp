@@ -15,11 +15,13 @@
     #include <vector>
     #include <string>
     #include <cassert>
+    #include <cstring>
     #include <basics/Graphics_Resource>
     #include <basics/Matrix>
     #include <basics/Point>
     #include <basics/Vector>
     #include <basics/opengles/Shader>
+    #include <basics/opengles/State_Cache>
 
     namespace basics { namespace opengles
     {
@@ -30,6 +32,14 @@
 
             typedef std::map< std::string, GLint > Uniform_Map;
 
+            struct Uniform_Value
+            {
+                size_t  size;
+                GLfloat values[16];                     ///< Cabe el mayor tipo admitido (Matrix44f).
+            };
+
+            typedef std::map< GLint, Uniform_Value > Uniform_Cache;
+
         private:
 
             static const Shader_Program * active_shader_program;
@@ -44,7 +54,9 @@
 
             static void disable ()
             {
-                glUseProgram (0);
+                active_shader_program = nullptr;
+
+                State_Cache::use_program (0);
             }
 
         private:
@@ -55,6 +67,8 @@
             GLuint      program_object_id;
             std::string log_string;
 
+            mutable Uniform_Cache uniform_cache;        ///< Último valor enviado a cada uniform.
+
         public:
 
             Shader_Program()
@@ -77,7 +91,13 @@
             {
                 if (initialized)
                 {
+                    if (active_shader_program == this) disable ();
+
                     glDeleteProgram (program_object_id);
+
+                    uniform_cache.clear ();
+
+                    initialized = false;
                 }
             }
 
@@ -108,12 +128,36 @@
             {
                 assert(is_usable ());
 
-                if (this != active_shader_program)
-                {
-                    glUseProgram (program_object_id);
+                State_Cache::use_program (program_object_id);
+
+                active_shader_program = this;
+            }
+
+        private:
+
+            /**
+             * Compara el valor con el último que se envió al uniform. Si ha cambiado lo guarda y activa
+             * el programa (glUniform*() actúa sobre el programa activo) para que se pueda enviar.
+             * @return false si el valor es el mismo y no hace falta enviarlo.
+             */
+            bool uniform_changed (GLint uniform_id, const void * value, size_t size) const
+            {
+                assert(size <= sizeof(Uniform_Value::values));
 
-                    active_shader_program = this;
+                Uniform_Value & cached = uniform_cache[uniform_id];
+
+                if (cached.size == size && std::memcmp (cached.values, value, size) == 0)
+                {
+                    State_Cache::count_skipped ();
+                    return false;
                 }
+
+                std::memcpy (cached.values, value, cached.size = size);
+
+                use ();
+
+                State_Cache::count_issued ();
+                return true;
             }
 
         public:
@@ -129,20 +173,20 @@
                 return (uniform_id);
             }
 
-            void set_uniform_value (GLint uniform_id, const GLint     & value     ) const { glUniform1i  (uniform_id, value); }
-            void set_uniform_value (GLint uniform_id, const float     & value     ) const { glUniform1f  (uniform_id, value); }
-            void set_uniform_value (GLint uniform_id, const float    (& vector)[2]) const { glUniform2f  (uniform_id, vector[0], vector[1]); }
-            void set_uniform_value (GLint uniform_id, const float    (& vector)[3]) const { glUniform3f  (uniform_id, vector[0], vector[1], vector[2]); }
-            void set_uniform_value (GLint uniform_id, const float    (& vector)[4]) const { glUniform4f  (uniform_id, vector[0], vector[1], vector[2], vector[3]); }
-            void set_uniform_value (GLint uniform_id, const Point2f   & point     ) const { glUniform2f  (uniform_id,  point[0],  point[1]); }
-            void set_uniform_value (GLint uniform_id, const Point3f   & point     ) const { glUniform3f  (uniform_id,  point[0],  point[1],  point[2]); }
-            void set_uniform_value (GLint uniform_id, const Point4f   & point     ) const { glUniform4f  (uniform_id,  point[0],  point[1],  point[2],  point[3]); }
-            void set_uniform_value (GLint uniform_id, const Vector2f  & vector    ) const { glUniform2f  (uniform_id, vector[0], vector[1]); }
-            void set_uniform_value (GLint uniform_id, const Vector3f  & vector    ) const { glUniform3f  (uniform_id, vector[0], vector[1], vector[2]); }
-            void set_uniform_value (GLint uniform_id, const Vector4f  & vector    ) const { glUniform4f  (uniform_id, vector[0], vector[1], vector[2], vector[3]); }
-            void set_uniform_value (GLint uniform_id, const Matrix22f & matrix    ) const { glUniformMatrix2fv (uniform_id, 1, GL_FALSE, matrix.values); }
-            void set_uniform_value (GLint uniform_id, const Matrix33f & matrix    ) const { glUniformMatrix3fv (uniform_id, 1, GL_FALSE, matrix.values); }
-            void set_uniform_value (GLint uniform_id, const Matrix44f & matrix    ) const { glUniformMatrix4fv (uniform_id, 1, GL_FALSE, matrix.values); }
+            void set_uniform_value (GLint uniform_id, const GLint     & value     ) const { if (uniform_changed (uniform_id, &value,  sizeof value )) glUniform1i  (uniform_id, value); }
+            void set_uniform_value (GLint uniform_id, const float     & value     ) const { if (uniform_changed (uniform_id, &value,  sizeof value )) glUniform1f  (uniform_id, value); }
+            void set_uniform_value (GLint uniform_id, const float    (& vector)[2]) const { if (uniform_changed (uniform_id,  vector, sizeof vector)) glUniform2f  (uniform_id, vector[0], vector[1]); }
+            void set_uniform_value (GLint uniform_id, const float    (& vector)[3]) const { if (uniform_changed (uniform_id,  vector, sizeof vector)) glUniform3f  (uniform_id, vector[0], vector[1], vector[2]); }
+            void set_uniform_value (GLint uniform_id, const float    (& vector)[4]) const { if (uniform_changed (uniform_id,  vector, sizeof vector)) glUniform4f  (uniform_id, vector[0], vector[1], vector[2], vector[3]); }
+            void set_uniform_value (GLint uniform_id, const Point2f   & point     ) const { if (uniform_changed (uniform_id, &point,  sizeof point )) glUniform2f  (uniform_id,  point[0],  point[1]); }
+            void set_uniform_value (GLint uniform_id, const Point3f   & point     ) const { if (uniform_changed (uniform_id, &point,  sizeof point )) glUniform3f  (uniform_id,  point[0],  point[1],  point[2]); }
+            void set_uniform_value (GLint uniform_id, const Point4f   & point     ) const { if (uniform_changed (uniform_id, &point,  sizeof point )) glUniform4f  (uniform_id,  point[0],  point[1],  point[2],  point[3]); }
+            void set_uniform_value (GLint uniform_id, const Vector2f  & vector    ) const { if (uniform_changed (uniform_id, &vector, sizeof vector)) glUniform2f  (uniform_id, vector[0], vector[1]); }
+            void set_uniform_value (GLint uniform_id, const Vector3f  & vector    ) const { if (uniform_changed (uniform_id, &vector, sizeof vector)) glUniform3f  (uniform_id, vector[0], vector[1], vector[2]); }
+            void set_uniform_value (GLint uniform_id, const Vector4f  & vector    ) const { if (uniform_changed (uniform_id, &vector, sizeof vector)) glUniform4f  (uniform_id, vector[0], vector[1], vector[2], vector[3]); }
+            void set_uniform_value (GLint uniform_id, const Matrix22f & matrix    ) const { if (uniform_changed (uniform_id, matrix.values, sizeof matrix.values)) glUniformMatrix2fv (uniform_id, 1, GL_FALSE, matrix.values); }
+            void set_uniform_value (GLint uniform_id, const Matrix33f & matrix    ) const { if (uniform_changed (uniform_id, matrix.values, sizeof matrix.values)) glUniformMatrix3fv (uniform_id, 1, GL_FALSE, matrix.values); }
+            void set_uniform_value (GLint uniform_id, const Matrix44f & matrix    ) const { if (uniform_changed (uniform_id, matrix.values, sizeof matrix.values)) glUniformMatrix4fv (uniform_id, 1, GL_FALSE, matrix.values); }
 
         public:
 
@@ -0,0 +1,109 @@
+/*
+ * STATE CACHE
+ * Copyright © 2018+ Ángel Rodríguez Ballesteros
+ *
+ * Distributed under the Boost Software License, version 1.0
+ * See the LICENSE file or www.boost.org/LICENSE_1_0.txt
+ *
+ * angel.rodriguez@esne.edu
+ *
+ * C2610171300
+ */
+
+#ifndef BASICS_OPENGLES_STATE_CACHE_HEADER
+#define BASICS_OPENGLES_STATE_CACHE_HEADER
+
+    #include <basics/Non_Instantiable>
+    #include <basics/opengles/OpenGL_ES2>
+
+    namespace basics { namespace opengles
+    {
+
+        /**
+         * Copia en memoria del estado de OpenGL ES que se cambia con más frecuencia al dibujar.
+         * Todos los cambios de estado que hace la librería pasan por aquí para poder descartar los
+         * que no cambian nada. Solo hay un contexto activo a la vez, por lo que el estado es estático.
+         */
+        class State_Cache : Non_Instantiable
+        {
+        public:
+
+            struct Statistics
+            {
+                unsigned issued;                        ///< Llamadas a OpenGL que se han emitido.
+                unsigned skipped;                       ///< Llamadas descartadas por ser redundantes.
+            };
+
+        private:
+
+            static constexpr unsigned max_vertex_attributes = 16;
+
+            static GLuint     program;
+            static GLuint     texture;
+            static GLenum     texture_unit;
+            static GLuint     array_buffer;
+            static GLuint     element_array_buffer;
+            static unsigned   enabled_attributes;       ///< Un bit por cada vertex attribute array activo.
+            static bool       blending;
+            static GLenum     blend_source;
+            static GLenum     blend_destination;
+            static bool       depth_test;
+            static bool       depth_writes;
+            static Statistics statistics;
+
+        public:
+
+            /**
+             * Fuerza el estado real y el guardado a sus valores por defecto. Se debe llamar cuando el
+             * contexto se crea de nuevo o cuando otro código puede haber cambiado el estado sin pasar
+             * por esta clase.
+             */
+            static void invalidate ();
+
+            static void use_program                (GLuint program_object_id);
+            static void bind_texture               (GLuint texture_object_id);
+            static void set_active_texture_unit    (GLenum unit);
+            static void bind_buffer                (GLenum target, GLuint buffer_object_id);
+            static void enable_vertex_attribute    (GLuint index);
+            static void disable_vertex_attribute   (GLuint index);
+            static void set_vertex_attributes      (unsigned enabled_mask);
+            static void set_blending               (bool enabled);
+            static void set_blend_function         (GLenum source, GLenum destination);
+            static void set_depth_test             (bool enabled);
+            static void set_depth_writes           (bool enabled);
+
+            /**
+             * Al borrar un objeto que está enlazado OpenGL ES enlaza el 0 en su lugar. Hay que avisar
+             * de ello para que la copia del estado no se quede desfasada.
+             */
+            static void forget_texture (GLuint texture_object_id);
+            static void forget_buffer  (GLuint  buffer_object_id);
+
+        public:
+
+            static void count_issued ()
+            {
+                statistics.issued++;
+            }
+
+            static void count_skipped ()
+            {
+                statistics.skipped++;
+            }
+
+            static const Statistics & get_statistics ()
+            {
+                return statistics;
+            }
+
+            static void reset_statistics ()
+            {
+                statistics.issued  = 0;
+                statistics.skipped = 0;
+            }
+
+        };
+
+    }}
+
+#endif
@@ -16,6 +16,7 @@
     #include <basics/Color_Buffer>
     #include <basics/Graphics_Resource>
     #include <basics/opengles/OpenGL_ES2>
+    #include <basics/opengles/State_Cache>
     #include <basics/Texture_2D>
 
     namespace basics { namespace opengles
@@ -29,30 +30,76 @@
         public:
 
             static std::shared_ptr< basics::Texture_2D > create (Id id, Color_Buffer< Rgba8888 > & color_buffer, const Options & options = {});
+            static std::shared_ptr< basics::Texture_2D > create (Id id, Compressed_Image         & image,        const Options & options = {});
 
         public:
 
             static void enable ()
             {
-                register_factory (ID(opengles2), basics::opengles::Texture_2D::create);
+                register_factory
+                (
+                    ID(opengles2),
+                    static_cast< Factory            >(basics::opengles::Texture_2D::create),
+                    static_cast< Compressed_Factory >(basics::opengles::Texture_2D::create)
+                );
             }
 
+            /**
+             * @return el formato de OpenGL ES con el que se puede subir una imagen comprimida en el
+             *     contexto activo o 0 si el contexto no lo admite.
+             */
+            static GLenum get_compressed_format (Compressed_Image::Format format, unsigned block_width, unsigned block_height);
+
             static void unuse ()
             {
-                glBindTexture (GL_TEXTURE_2D, 0);
+                active_texture = nullptr;
+
+                State_Cache::bind_texture (0);
             }
 
         private:
 
             Color_Buffer< Rgba8888 > color_buffer;
+            Compressed_Image         compressed_image;  ///< Bloques pendientes de subir si la imagen está comprimida.
+            bool                     alpha_plane;       ///< La mitad inferior de la textura es el alfa de la superior.
+            Pixel_Format             pixel_format;      ///< Formato al que se convierten los píxeles al subirlos.
+            bool                     dither;
+            Mipmaps                  mipmaps;
+            bool                     trilinear;
             GLuint texture_object_id;
 
         public:
 
-            Texture_2D(const Color_Buffer< Rgba8888 > & color_buffer, unsigned width, unsigned height)
+            /**
+             * La textura se queda con los píxeles de color_buffer (sin copiarlos) para poder subirlos
+             * de nuevo si se pierde el contexto.
+             */
+            Texture_2D(Color_Buffer< Rgba8888 > && color_buffer, const Options & options)
+            :
+                basics::Texture_2D(ID(opengles2), options.width, options.height, is_opaque_format (options), options.residency, premultiplies (options)),
+                color_buffer      (std::move (color_buffer)),
+                alpha_plane       (false),
+                pixel_format      (options.format),
+                dither            (options.dither),
+                mipmaps           (options.mipmaps),
+                trilinear         (options.trilinear)
+            {
+            }
+
+            /**
+             * La textura se queda con los bloques de image. Si el contexto no admite su formato se
+             * decodifican por software al inicializarla, y entonces se aplica el resto de options
+             * (salvo la premultiplicación: los bloques se usan tal cual).
+             */
+            Texture_2D(Compressed_Image && image, const Options & options)
             :
-                basics::Texture_2D(width, height),
-                color_buffer      (color_buffer )
+                basics::Texture_2D(ID(opengles2), image.get_width (), image.get_height (), image.is_opaque () || is_opaque_format (options), options.residency),
+                compressed_image  (std::move (image)),
+                alpha_plane       (false),
+                pixel_format      (options.format),
+                dither            (options.dither),
+                mipmaps           (options.mipmaps),
+                trilinear         (options.trilinear)
             {
             }
 
@@ -74,6 +121,10 @@
                 if (initialized)
                 {
                     glDeleteTextures (1, &texture_object_id);
+
+                    State_Cache::forget_texture (texture_object_id);
+
+                    initialized = false;
                 }
             }
 
@@ -84,10 +135,47 @@
                 return initialized;
             }
 
+            GLuint get_texture_object_id () const
+            {
+                return texture_object_id;
+            }
+
+            /**
+             * Una imagen ETC1 con plano de alfa se sube con el plano debajo del color, en una textura
+             * del doble de alto. Los shaders del canvas leen entonces el color de la mitad superior
+             * y el alfa del canal verde de la inferior.
+             */
+            bool has_alpha_plane () const
+            {
+                return alpha_plane;
+            }
+
+            /**
+             * Una textura ALPHA_8 se sube como GL_ALPHA y los shaders del canvas la tiñen de blanco.
+             */
+            bool is_alpha_only () const
+            {
+                return pixel_format == ALPHA_8;
+            }
+
         public:
 
             bool use () const;
 
+        private:
+
+            /**
+             * Sin canal alfa la textura es opaca aunque la imagen no lo fuese.
+             */
+            static bool is_opaque_format (const Options & options)
+            {
+                return options.opaque || options.format == RGB_565 || options.format == LUMINANCE_8;
+            }
+
+            bool upload_compressed ();
+            bool upload_pixels     ();
+            void upload_level      (GLint level, const Color_Buffer< Rgba8888 > & pixels);
+
         };
 
     }}
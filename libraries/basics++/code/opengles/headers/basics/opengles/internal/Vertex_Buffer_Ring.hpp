@@ -0,0 +1,102 @@
+/*
+ * VERTEX BUFFER RING
+ * Copyright © 2018+ Ángel Rodríguez Ballesteros
+ *
+ * Distributed under the Boost Software License, version 1.0
+ * See the LICENSE file or www.boost.org/LICENSE_1_0.txt
+ *
+ * angel.rodriguez@esne.edu
+ *
+ * C2610171210
+ */
+
+#ifndef BASICS_OPENGLES_VERTEX_BUFFER_RING_HEADER
+#define BASICS_OPENGLES_VERTEX_BUFFER_RING_HEADER
+
+    #include <vector>
+    #include <basics/Graphics_Resource>
+    #include <basics/opengles/OpenGL_ES2>
+    #include <basics/opengles/State_Cache>
+
+    namespace basics { namespace opengles
+    {
+
+        /**
+         * Conjunto de vertex buffer objects que se usan de forma rotatoria para subir geometría que
+         * cambia en cada fotograma. Los datos se van añadiendo uno detrás de otro dentro del buffer
+         * actual. Cuando no caben, se pasa al siguiente buffer del anillo y se huerfaniza su
+         * contenido anterior (glBufferData con nullptr) para que el driver no tenga que esperar a
+         * que la GPU termine de leerlo.
+         */
+        class Vertex_Buffer_Ring : public Graphics_Resource
+        {
+        private:
+
+            std::vector< GLuint > buffer_object_ids;
+
+            size_t   capacity;                          ///< Tamaño en bytes de cada buffer del anillo.
+            size_t   cursor;                            ///< Primer byte libre del buffer actual.
+            unsigned current;                           ///< Índice del buffer actual dentro del anillo.
+
+        public:
+
+            Vertex_Buffer_Ring(size_t capacity, unsigned count)
+            :
+                buffer_object_ids(count, 0),
+                capacity         (capacity),
+                cursor           (0),
+                current          (0)
+            {
+            }
+
+            Vertex_Buffer_Ring(const Vertex_Buffer_Ring & ) = delete;
+
+           ~Vertex_Buffer_Ring()
+            {
+                finalize ();
+            }
+
+        public:
+
+            bool initialize () override;
+
+            void finalize () override
+            {
+                if (initialized)
+                {
+                    glDeleteBuffers (GLsizei(buffer_object_ids.size ()), buffer_object_ids.data ());
+
+                    for (auto buffer_object_id : buffer_object_ids) State_Cache::forget_buffer (buffer_object_id);
+
+                    initialized = false;
+                }
+            }
+
+        public:
+
+            bool is_usable () const
+            {
+                return initialized;
+            }
+
+            size_t get_capacity () const
+            {
+                return capacity;
+            }
+
+        public:
+
+            /**
+             * Copia los datos al buffer actual (pasando al siguiente si no caben) y lo deja enlazado
+             * a GL_ARRAY_BUFFER.
+             * @param data Puntero a los datos de los vértices.
+             * @param size Tamaño en bytes de los datos. No debe superar la capacidad de un buffer.
+             * @return Offset en bytes de los datos dentro del buffer enlazado.
+             */
+            size_t upload (const void * data, size_t size);
+
+        };
+
+    }}
+
+#endif
@@ -10,11 +10,19 @@
  * C1801091703
  */
 
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <basics/Affine_Kernel>
 #include <basics/Transformation>
 #include <basics/opengles/OpenGL_ES2>
 #include <basics/opengles/Canvas_ES2>
+#include <basics/opengles/Extensions>
+#include <basics/opengles/Index_Buffer>
+#include <basics/opengles/State_Cache>
 #include <basics/opengles/Shader_Program>
 #include <basics/opengles/Texture_2D>
+#include <basics/opengles/Vertex_Buffer_Ring>
 
 // glTexCoordPointer (2, GL_FLOAT, 0, tex_coords);
 
@@ -35,33 +43,93 @@ namespace basics { namespace opengles
         "precision mediump float;"
         "uniform   mat3 transform;"
         "uniform   mat3 projection;"
-        "attribute vec2 vertex_position;"
+        "attribute highp vec3 vertex_position;"
         "attribute vec2 vertex_texture_uv;"
+        "attribute float vertex_blend;"
         "varying   vec2 varying_uv;"
+        "varying   float varying_blend;"
         "void main()"
         "{"
             "varying_uv  = vertex_texture_uv;"
-            "gl_Position = vec4((vec3(vertex_position, 1.0) * transform * projection).xy, 0.0, 1.0);"
+            "varying_blend = vertex_blend;"
+            "gl_Position = vec4((vec3(vertex_position.xy, 1.0) * transform * projection).xy, vertex_position.z, 1.0);"
         "}";
 
+    // Todos los shaders escriben el color premultiplicado por el alfa, que se mezcla con GL_ONE y
+    // GL_ONE_MINUS_SRC_ALPHA. El alfa que escriben se multiplica además por blend: con 1 se obtiene
+    // la transparencia normal y con 0 la mezcla aditiva, por lo que ambas comparten estado y lote:
+
     const char * Canvas_ES2::internal_fragment_shader_f =
         "precision mediump float;"
         "uniform vec3  color;"
         "uniform float opacity;"
+        "uniform float blend;"
         "void main()"
         "{"
-            "gl_FragColor = vec4(color, opacity);"
+            "gl_FragColor = vec4(color * opacity, opacity * blend);"
         "}";
 
+    // Con alpha_plane = 1 la textura lleva el color en su mitad superior y el alfa en el canal verde
+    // de la inferior (ETC1 no tiene canal alfa). Con alpha_only = 1 la textura es GL_ALPHA, que se
+    // lee con el color a 0, y se toma blanco. Con premultiplied = 1 el color de la textura ya está
+    // multiplicado por su alfa:
+
     const char * Canvas_ES2::internal_fragment_shader_t =
         "precision mediump   float;"
         "uniform   sampler2D sampler;"
         "uniform   float     opacity;"
+        "uniform   float     alpha_plane;"
+        "uniform   float     alpha_only;"
+        "uniform   float     premultiplied;"
         "varying   vec2      varying_uv;"
+        "varying   float     varying_blend;"
         "void main()"
         "{"
-            "vec4 texel   = texture2D (sampler, varying_uv);"
-            "gl_FragColor = vec4(texel.rgb, texel.a * opacity);"
+            "vec2 uv      = vec2(varying_uv.x, varying_uv.y * (1.0 - 0.5 * alpha_plane));"
+            "vec4 texel   = texture2D (sampler, uv);"
+            "if (alpha_plane > 0.5) texel.a = texture2D (sampler, uv + vec2(0.0, 0.5)).g;"
+            "texel.rgb    = mix (texel.rgb, vec3(1.0), alpha_only);"
+            "texel.rgb   *= mix (texel.a, 1.0, premultiplied) * opacity;"
+            "gl_FragColor = vec4(texel.rgb, texel.a * opacity * varying_blend);"
+        "}";
+
+    const char * Canvas_ES2::internal_vertex_shader_i =
+        "precision mediump float;"
+        "uniform   mat3  transform;"
+        "uniform   mat3  projection;"
+        "attribute vec2  vertex_corner;"
+        "attribute vec4  instance_rect;"
+        "attribute vec4  instance_uv_rect;"
+        "attribute float instance_opacity;"
+        "varying   vec2  varying_uv;"
+        "varying   float varying_opacity;"
+        "void main()"
+        "{"
+            "vec2 position  = instance_rect.xy + vertex_corner * instance_rect.zw;"
+            "varying_uv      = mix (instance_uv_rect.xy, instance_uv_rect.zw, vertex_corner);"
+            "varying_opacity = instance_opacity;"
+            "gl_Position     = vec4((vec3(position, 1.0) * transform * projection).xy, 0.0, 1.0);"
+        "}";
+
+    const char * Canvas_ES2::internal_fragment_shader_i =
+        "precision mediump   float;"
+        "uniform   sampler2D sampler;"
+        "uniform   float     opacity;"
+        "uniform   float     alpha_plane;"
+        "uniform   float     alpha_only;"
+        "uniform   float     premultiplied;"
+        "uniform   float     blend;"
+        "varying   vec2      varying_uv;"
+        "varying   float     varying_opacity;"
+        "void main()"
+        "{"
+            "vec2  uv     = vec2(varying_uv.x, varying_uv.y * (1.0 - 0.5 * alpha_plane));"
+            "vec4  texel  = texture2D (sampler, uv);"
+            "float alpha  = opacity * varying_opacity;"
+            "if (alpha_plane > 0.5) texel.a = texture2D (sampler, uv + vec2(0.0, 0.5)).g;"
+            "texel.rgb    = mix (texel.rgb, vec3(1.0), alpha_only);"
+            "texel.rgb   *= mix (texel.a, 1.0, premultiplied) * alpha;"
+            "gl_FragColor = vec4(texel.rgb, texel.a * alpha * blend);"
         "}";
 
     static const Point2f normal_texture_uvs[] =
@@ -96,6 +164,42 @@ namespace basics { namespace opengles
         { 0.f, 1.f },
     };
 
+    constexpr unsigned Canvas_ES2::max_batch_quads;
+    constexpr unsigned Canvas_ES2::max_instances_per_draw;
+
+    static const float quad_corners[] = { 0.f, 0.f,  0.f, 1.f,  1.f, 0.f,  1.f, 1.f };
+
+    static inline const GLvoid * buffer_offset (size_t offset)
+    {
+        return reinterpret_cast< const GLvoid * >(offset);
+    }
+
+    // Área del paralelogramo formado por las esquinas de un quad (inferior izquierda, superior
+    // izquierda, inferior derecha, superior derecha):
+
+    static inline float quad_area (const float * positions)
+    {
+        float up_x    = positions[2] - positions[0];
+        float up_y    = positions[3] - positions[1];
+        float right_x = positions[4] - positions[0];
+        float right_y = positions[5] - positions[1];
+
+        return std::abs (up_x * right_y - up_y * right_x);
+    }
+
+    // Transformación precedida de un desplazamiento (la que se aplica a un bloque de vértices de
+    // texto cuyas posiciones son relativas a su esquina superior izquierda):
+
+    static inline Transformation2f offset_transform (const Transformation2f & transform, const Point2f & offset)
+    {
+        Transformation2f result = transform;
+
+        result.matrix[0][2] += transform.matrix[0][0] * offset[0] + transform.matrix[0][1] * offset[1];
+        result.matrix[1][2] += transform.matrix[1][0] * offset[0] + transform.matrix[1][1] * offset[1];
+
+        return result;
+    }
+
     Canvas * Canvas_ES2::create (Id id, Graphics_Context::Accessor & context, const Options & options)
     {
         std::shared_ptr< Canvas >  canvas(new Canvas_ES2(context, options.size));
@@ -107,8 +211,47 @@ namespace basics { namespace opengles
 
     Canvas_ES2::Canvas_ES2(Graphics_Context::Accessor & context, const Size2u & size)
     :
-        size{ float(size.width), float(size.height) }
+        size{ float(size.width), float(size.height) },
+        opacity      (1.f    ),
+        blending     (TRANSPARENCY),
+        batching     (true   ),
+        batch_texture(nullptr),
+        sorting         (false  ),
+        layer           (0      ),
+        transform_baking(false  ),
+        opaque_commands (0      ),
+        depth_capacity  (0      ),
+        depth_base      (0      )
     {
+        // Los índices de los quads no cambian nunca, por lo que se suben a la GPU una sola vez:
+
+        std::vector< GLushort > quad_indices;
+
+        quad_indices.reserve (max_batch_quads * 6);
+
+        for (unsigned quad = 0, vertex = 0; quad < max_batch_quads; ++quad, vertex += 4)
+        {
+            quad_indices.push_back (GLushort(vertex + 0));
+            quad_indices.push_back (GLushort(vertex + 1));
+            quad_indices.push_back (GLushort(vertex + 2));
+            quad_indices.push_back (GLushort(vertex + 2));
+            quad_indices.push_back (GLushort(vertex + 1));
+            quad_indices.push_back (GLushort(vertex + 3));
+        }
+
+        quad_index_buffer.reset (new Index_Buffer(quad_indices));
+
+        context->add (quad_index_buffer);
+
+        // Cada buffer del anillo tiene espacio para dos lotes completos:
+
+        vertex_buffer_ring.reset (new Vertex_Buffer_Ring(max_batch_quads * 4 * sizeof(Vertex) * 2, 3));
+
+        context->add (vertex_buffer_ring);
+
+        batch_vertices.reserve (max_batch_quads * 4);
+        commands      .reserve (max_batch_quads);
+
         shader_program_f.reset (new Shader_Program);
 
         shader_program_f->add (Shader::Source_Code::from_string (internal_vertex_shader_f,   Shader::Source_Code::VERTEX  ));
@@ -124,6 +267,7 @@ namespace basics { namespace opengles
             projection_f_id = shader_program_f->get_uniform_id ("projection");
                  color_f_id = shader_program_f->get_uniform_id ("color"     );
                opacity_f_id = shader_program_f->get_uniform_id ("opacity"   );
+                 blend_f_id = shader_program_f->get_uniform_id ("blend"     );
         }
 
         shader_program_t.reset (new Shader_Program);
@@ -141,40 +285,407 @@ namespace basics { namespace opengles
             projection_t_id = shader_program_t->get_uniform_id ("projection");
                sampler_t_id = shader_program_t->get_uniform_id ("sampler"   );
                opacity_t_id = shader_program_t->get_uniform_id ("opacity"   );
+           alpha_plane_t_id = shader_program_t->get_uniform_id ("alpha_plane");
+            alpha_only_t_id = shader_program_t->get_uniform_id ("alpha_only" );
+         premultiplied_t_id = shader_program_t->get_uniform_id ("premultiplied");
 
               vertex_position_location_t = shader_program_t->get_vertex_attribute_id ("vertex_position"  );
             vertex_texture_uv_location_t = shader_program_t->get_vertex_attribute_id ("vertex_texture_uv");
+                 vertex_blend_location_t = shader_program_t->get_vertex_attribute_id ("vertex_blend"     );
 
             shader_program_t->set_uniform_value (sampler_t_id, 0);
         }
 
+        shader_program_i.reset (new Shader_Program);
+
+        shader_program_i->add (Shader::Source_Code::from_string (internal_vertex_shader_i,   Shader::Source_Code::VERTEX  ));
+        shader_program_i->add (Shader::Source_Code::from_string (internal_fragment_shader_i, Shader::Source_Code::FRAGMENT));
+
+        context->add (shader_program_i);
+
+        if (shader_program_i->is_usable ())
+        {
+             transform_i_id = shader_program_i->get_uniform_id ("transform" );
+            projection_i_id = shader_program_i->get_uniform_id ("projection");
+               sampler_i_id = shader_program_i->get_uniform_id ("sampler"   );
+               opacity_i_id = shader_program_i->get_uniform_id ("opacity"   );
+           alpha_plane_i_id = shader_program_i->get_uniform_id ("alpha_plane");
+            alpha_only_i_id = shader_program_i->get_uniform_id ("alpha_only" );
+         premultiplied_i_id = shader_program_i->get_uniform_id ("premultiplied");
+                 blend_i_id = shader_program_i->get_uniform_id ("blend"      );
+
+               vertex_corner_location_i = shader_program_i->get_vertex_attribute_id ("vertex_corner"   );
+               instance_rect_location_i = shader_program_i->get_vertex_attribute_id ("instance_rect"   );
+            instance_uv_rect_location_i = shader_program_i->get_vertex_attribute_id ("instance_uv_rect");
+            instance_opacity_location_i = shader_program_i->get_vertex_attribute_id ("instance_opacity");
+
+            shader_program_i->set_uniform_value (sampler_i_id, 0);
+        }
+
+        // Si el contexto no permite dibujar con instancias, draw_instances() expande cada una a un quad:
+
+        Extensions::load ();
+
+        // Cada quad del pase opaco ocupa dos niveles del buffer de profundidad para que el redondeo no
+        // confunda quads consecutivos. Sin buffer de profundidad no hay pase opaco:
+
+        GLint depth_bits = 0;
+
+        glGetIntegerv (GL_DEPTH_BITS, &depth_bits);
+
+        if (depth_bits > 0)
+        {
+            depth_capacity = (1u << std::min (depth_bits, GLint(16))) / 2 - 1;
+        }
+
+        opaque_pass = depth_capacity > 0;
+
         reset_state ();
     }
 
     void Canvas_ES2::reset_state ()
     {
-        glEnable      (GL_BLEND);
-        glBlendFunc   (GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        // Otro código puede haber tocado el estado de OpenGL ES sin pasar por State_Cache:
+
+        State_Cache::invalidate ();
+        State_Cache::set_blending       (true);
+        State_Cache::set_blend_function (GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+
         glClearColor  (0.f, 0.f, 0.f, 1.f);
 
         set_size      ({ unsigned(size.width), unsigned(size.height) });
         set_transform (Transformation2f());
         set_color     (1.f, 1.f, 1.f);
         set_opacity   (1.f);
+        set_blending  (TRANSPARENCY);
+        set_layer     (0);
+
+        // No se sabe qué contiene el buffer de profundidad, así que se limpiará antes de usarlo:
+
+        depth_base = depth_capacity;
+    }
+
+    void Canvas_ES2::set_batching (bool enabled)
+    {
+        flush ();
+
+        batching = enabled;
+    }
+
+    void Canvas_ES2::set_sorting (bool enabled)
+    {
+        flush ();
+
+        sorting = enabled;
+    }
+
+    void Canvas_ES2::set_opaque_pass (bool enabled)
+    {
+        flush ();
+
+        opaque_pass = enabled && depth_capacity > 0;
+    }
+
+    void Canvas_ES2::set_layer (int new_layer)
+    {
+        layer = new_layer;
+    }
+
+    void Canvas_ES2::dump_commands (std::ostream & output)
+    {
+        commands.sort ();
+        commands.dump (output);
+    }
+
+    void Canvas_ES2::flush ()
+    {
+        submit_commands ();
+        flush_batch     ();
+
+        // Los cambios de estado se cuentan en State_Cache y se pasan aquí a las estadísticas del
+        // canvas. end_frame() llama a flush(), así que cada fotograma recibe los suyos:
+
+        const State_Cache::Statistics & state_statistics = State_Cache::get_statistics ();
+
+        statistics.state_changes           += state_statistics.issued;
+        statistics.redundant_state_changes += state_statistics.skipped;
+
+        State_Cache::reset_statistics ();
+    }
+
+    void Canvas_ES2::record_quad (const Texture_2D * texture, const Point2f & bottom_left, const Size2f & size, const Point2f * texture_uvs)
+    {
+        float left   = bottom_left[0];
+        float bottom = bottom_left[1];
+        float right  = left   + size.width;
+        float top    = bottom + size.height;
+
+        float positions[] = { left, bottom,  left, top,  right, bottom,  right, top };
+
+        record_quad (texture, positions, texture_uvs);
+    }
+
+    void Canvas_ES2::record_quad (const Texture_2D * texture, float * positions, const Point2f * texture_uvs)
+    {
+        if (transform_baking)
+        {
+            transform_points_2d (transform, positions, positions, 4);
+        }
+
+        if (sorting)
+        {
+            // La opacidad del canvas no cambia sin enviar antes los comandos pendientes:
+
+            bool opaque = opaque_pass && opacity == 1.f && blending == TRANSPARENCY && texture->is_opaque ();
+
+            commands.add (layer, shader_program_t->id (), texture->get_texture_object_id (), texture, positions, texture_uvs, opaque, get_blend_factor ());
+
+            if (opaque) opaque_commands++;
+        }
+        else
+        {
+            unsigned area = unsigned(quad_area (positions) * get_area_scale () + .5f);
+
+            statistics. filled_pixels += area;
+            statistics.blended_pixels += area;
+
+            add_quad (texture, positions, texture_uvs, 0.f, get_blend_factor ());
+        }
+    }
+
+    float Canvas_ES2::get_area_scale () const
+    {
+        // Si la transformación no se aplica en la CPU las posiciones están sin transformar y el área
+        // se escala con el determinante de la transformación:
+
+        if (transform_baking) return 1.f;
+
+        const float * m = transform.matrix.values;
+
+        return std::abs (m[0] * m[4] - m[1] * m[3]);
+    }
+
+    void Canvas_ES2::submit_commands ()
+    {
+        if (!commands.empty ())
+        {
+            commands.sort ();
+
+            size_t count       = commands.size ();
+            float  area_scale  = get_area_scale ();
+            bool   depth_pass  = opaque_commands > 0 && count <= depth_capacity;
+            float  depth_step  = depth_pass ? 2.f / float(depth_capacity + 1) : 0.f;
+
+            // Cada comando recibe una profundidad según su posición en el orden de dibujado (los que
+            // se dibujarían después quedan delante). Se sigue contando desde el último envío para que
+            // lo nuevo quede siempre delante de lo que ya se dibujó en el mismo fotograma:
+
+            if (depth_pass && depth_base + count > depth_capacity)
+            {
+                State_Cache::set_depth_writes (true);
+
+                glClear (GL_DEPTH_BUFFER_BIT);
+
+                depth_base = 0;
+            }
+
+            // Los opacos se dibujan primero, de delante hacia atrás, sin mezcla y escribiendo la
+            // profundidad, para que la GPU descarte antes del fragment shader todo lo que tapan:
+
+            if (depth_pass)
+            {
+                State_Cache::set_blending     (false);
+                State_Cache::set_depth_test   (true );
+                State_Cache::set_depth_writes (true );
+
+                for (size_t index = count; index-- > 0; )
+                {
+                    const Render_Command_List::Command & command = commands[index];
+
+                    if (command.opaque)
+                    {
+                        const float positions[] =
+                        {
+                            command.positions[0][0], command.positions[0][1],
+                            command.positions[1][0], command.positions[1][1],
+                            command.positions[2][0], command.positions[2][1],
+                            command.positions[3][0], command.positions[3][1],
+                        };
+
+                        statistics.filled_pixels += unsigned(quad_area (positions) * area_scale + .5f);
+
+                        add_quad (static_cast< const Texture_2D * >(command.texture), positions, command.texture_uvs, 1.f - float(depth_base + index + 1) * depth_step, command.blend);
+                    }
+                }
+
+                flush_batch ();
+
+                State_Cache::set_blending     (true );
+                State_Cache::set_depth_writes (false);
+            }
+
+            // Los demás se pasan a los lotes de atrás hacia delante. Como ya están ordenados, los que
+            // comparten textura quedan seguidos y se dibujan con una sola llamada:
+
+            for (size_t index = 0; index < count; ++index)
+            {
+                const Render_Command_List::Command & command = commands[index];
+
+                if (command.vertex_count > 0)
+                {
+                    const Texture_2D          * texture  = static_cast< const Texture_2D * >(command.texture);
+                    const Text_Layout::Vertex * vertices = commands.get_vertices (command);
+
+                    if (!depth_pass)
+                    {
+                        // Los vértices ya están desplazados (y transformados si el baking está activo):
+
+                        draw_vertex_block (texture, vertices, command.vertex_count, transform_baking ? Transformation2f() : transform, command.area, command.blend);
+                    }
+                    else
+                    {
+                        // La profundidad va en la posición de cada vértice y el bloque no la tiene, por
+                        // lo que con la pasada de opacos el texto se pasa a los lotes glifo a glifo:
+
+                        for (const Text_Layout::Vertex * vertex = vertices, * end = vertices + command.vertex_count; vertex + 4 <= end; vertex += 4)
+                        {
+                            const float   positions  [] = { vertex[0].x, vertex[0].y, vertex[1].x, vertex[1].y, vertex[2].x, vertex[2].y, vertex[3].x, vertex[3].y };
+                            const Point2f texture_uvs[] =
+                            {
+                                { vertex[0].u, vertex[0].v }, { vertex[1].u, vertex[1].v },
+                                { vertex[2].u, vertex[2].v }, { vertex[3].u, vertex[3].v },
+                            };
+
+                            add_quad (texture, positions, texture_uvs, 1.f - float(depth_base + index + 1) * depth_step, command.blend);
+                        }
+
+                        unsigned area = unsigned(command.area + .5f);
+
+                        statistics. filled_pixels += area;
+                        statistics.blended_pixels += area;
+                    }
+                }
+                else
+                if (!depth_pass || !command.opaque)
+                {
+                    const float positions[] =
+                    {
+                        command.positions[0][0], command.positions[0][1],
+                        command.positions[1][0], command.positions[1][1],
+                        command.positions[2][0], command.positions[2][1],
+                        command.positions[3][0], command.positions[3][1],
+                    };
+
+                    unsigned area = unsigned(quad_area (positions) * area_scale + .5f);
+
+                    statistics. filled_pixels += area;
+                    statistics.blended_pixels += area;
+
+                    add_quad (static_cast< const Texture_2D * >(command.texture), positions, command.texture_uvs, 1.f - float(depth_base + index + 1) * depth_step, command.blend);
+                }
+            }
+
+            if (depth_pass)
+            {
+                flush_batch ();
+
+                State_Cache::set_depth_test (false);
+
+                depth_base += unsigned(count);
+            }
+
+            commands.clear ();
+
+            opaque_commands = 0;
+        }
+    }
+
+    void Canvas_ES2::flush_batch ()
+    {
+        if (!batch_vertices.empty ())
+        {
+            batch_texture   ->use ();
+            shader_program_t->use ();
+            shader_program_t->set_uniform_value (alpha_plane_t_id, batch_texture->has_alpha_plane () ? 1.f : 0.f);
+            shader_program_t->set_uniform_value (alpha_only_t_id,  batch_texture->is_alpha_only   () ? 1.f : 0.f);
+            shader_program_t->set_uniform_value (premultiplied_t_id, batch_texture->is_premultiplied () ? 1.f : 0.f);
+
+            size_t offset = vertex_buffer_ring->upload (batch_vertices.data (), batch_vertices.size () * sizeof(Vertex));
+
+            quad_index_buffer->use ();
+
+            State_Cache::set_vertex_attributes ((1u << vertex_position_location_t) | (1u << vertex_texture_uv_location_t) | (1u << vertex_blend_location_t));
+
+            glVertexAttribPointer     (  vertex_position_location_t, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), buffer_offset (offset + offsetof(Vertex, x    )));
+            glVertexAttribPointer     (vertex_texture_uv_location_t, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), buffer_offset (offset + offsetof(Vertex, u    )));
+            glVertexAttribPointer     (     vertex_blend_location_t, 1, GL_FLOAT, GL_FALSE, sizeof(Vertex), buffer_offset (offset + offsetof(Vertex, blend)));
+            glDrawElements            (GL_TRIANGLES, GLsizei(batch_vertices.size () / 4 * 6), GL_UNSIGNED_SHORT, buffer_offset (0));
+
+            statistics.draw_calls++;
+            statistics.flushes++;
+
+            batch_vertices.clear ();
+        }
+
+        batch_texture = nullptr;
+    }
+
+    void Canvas_ES2::add_quad (const Texture_2D * texture, const float * positions, const Point2f * texture_uvs, float depth, float blend)
+    {
+        // Cualquier cambio de textura obliga a enviar el lote acumulado hasta ahora:
+
+        if (texture != batch_texture || batch_vertices.size () >= max_batch_quads * 4)
+        {
+            flush_batch ();
+
+            batch_texture = texture;
+        }
+
+        for (unsigned corner = 0; corner < 4; ++corner)
+        {
+            batch_vertices.push_back ({ positions[corner * 2], positions[corner * 2 + 1], depth, texture_uvs[corner][0], texture_uvs[corner][1], blend });
+        }
+
+        statistics.quads++;
+
+        if (!batching) flush_batch ();
+    }
+
+    void Canvas_ES2::draw_flat (unsigned mode, const Point2f * coordinates, unsigned count)
+    {
+        flush ();
+
+        shader_program_f->use ();
+
+        size_t offset = vertex_buffer_ring->upload (coordinates, count * sizeof(Point2f));
+
+        State_Cache::set_vertex_attributes (1u << 0);
+
+        glVertexAttribPointer      (0, 2, GL_FLOAT, GL_FALSE, 0, buffer_offset (offset));
+        glDrawArrays               (GLenum(mode), 0, GLsizei(count));
+
+        statistics.draw_calls++;
     }
 
     void Canvas_ES2::set_size (const Size2u & new_viewport_size)
     {
+        flush ();
+
         size.width  = float(new_viewport_size.width );
         size.height = float(new_viewport_size.height);
         half_size   = size * 0.5f;
         projection  = translate_then_scale_2d (Vector2f{ -half_size.width, -half_size.height }, 2.f / size.width, 2.f / size.height);
 
-        shader_program_f->use ();
         shader_program_f->set_uniform_value (projection_f_id, projection.matrix);
-
-        shader_program_t->use ();
         shader_program_t->set_uniform_value (projection_t_id, projection.matrix);
+
+        // Si el programa de instancias no se pudo crear, sus ids no tienen valor (y draw_instances()
+        // no lo usa):
+
+        if (shader_program_i->is_usable ())
+        {
+            shader_program_i->set_uniform_value (projection_i_id, projection.matrix);
+        }
     }
 
     void Canvas_ES2::set_clear_color (float r, float g, float b)
@@ -182,97 +693,144 @@ namespace basics { namespace opengles
         glClearColor (r, g, b, 1.f);
     }
 
-    void Canvas_ES2::set_opacity (float opacity)
+    void Canvas_ES2::set_opacity (float new_opacity)
     {
-        shader_program_f->use ();
+        // Solo hay que enviar el lote pendiente si el valor cambia de verdad. Shader_Program ya
+        // descarta los uniforms que no cambian:
+
+        if (new_opacity != opacity) flush ();
+
+        opacity = new_opacity;
+
         shader_program_f->set_uniform_value (opacity_f_id, opacity);
-        shader_program_t->use ();
         shader_program_t->set_uniform_value (opacity_t_id, opacity);
+
+        if (shader_program_i->is_usable ())
+        {
+            shader_program_i->set_uniform_value (opacity_i_id, opacity);
+        }
     }
 
     void Canvas_ES2::set_color (float r, float g, float b)
     {
-        shader_program_f->use ();
         shader_program_f->set_uniform_value (color_f_id, Vector3f{ r, g, b });
     }
 
+    void Canvas_ES2::set_blending (Blending new_blending)
+    {
+        // La transparencia y la mezcla aditiva usan la misma función de mezcla y se distinguen por
+        // el factor de cada vértice, así que se puede pasar de una a otra sin enviar el lote. Las
+        // demás necesitan cambiar la función:
+
+        bool shared_function = (blending == TRANSPARENCY || blending == ADD) && (new_blending == TRANSPARENCY || new_blending == ADD);
+
+        if (new_blending != blending && !shared_function)
+        {
+            flush ();
+
+            switch (new_blending)
+            {
+                case NONE:     State_Cache::set_blend_function (GL_ONE,       GL_ZERO               ); break;
+                case MULTIPLY: State_Cache::set_blend_function (GL_DST_COLOR, GL_ONE_MINUS_SRC_ALPHA); break;
+                default:       State_Cache::set_blend_function (GL_ONE,       GL_ONE_MINUS_SRC_ALPHA); break;
+            }
+        }
+
+        blending = new_blending;
+
+        shader_program_f->set_uniform_value (blend_f_id, get_blend_factor ());
+
+        if (shader_program_i->is_usable ())
+        {
+            shader_program_i->set_uniform_value (blend_i_id, get_blend_factor ());
+        }
+    }
+
     void Canvas_ES2::set_transform (const Transformation2f & new_transform)
     {
+        // Con la transformación en la CPU los quads pendientes ya están transformados y el programa
+        // de quads mantiene la identidad, así que no hay que enviar el lote:
+
+        if (!transform_baking && new_transform.matrix != transform.matrix) flush ();
+
         transform = new_transform;
 
-        shader_program_f->use ();
         shader_program_f->set_uniform_value (transform_f_id, transform.matrix);
 
-        shader_program_t->use ();
-        shader_program_t->set_uniform_value (transform_t_id, transform.matrix);
+        if (shader_program_i->is_usable ())
+        {
+            shader_program_i->set_uniform_value (transform_i_id, transform.matrix);
+        }
+
+        if (!transform_baking)
+        {
+            shader_program_t->set_uniform_value (transform_t_id, transform.matrix);
+        }
     }
 
-    void Canvas_ES2::apply_transform (const Transformation2f & t)
+    void Canvas_ES2::set_transform_baking (bool enabled)
     {
-        transform = t * transform;
+        if (enabled != transform_baking)
+        {
+            flush ();
 
-        shader_program_f->use ();
-        shader_program_f->set_uniform_value (transform_f_id, transform.matrix);
+            transform_baking = enabled;
 
-        shader_program_t->use ();
-        shader_program_t->set_uniform_value (transform_t_id, transform.matrix);
+            shader_program_t->set_uniform_value (transform_t_id, transform_baking ? Transformation2f().matrix : transform.matrix);
+        }
+    }
+
+    void Canvas_ES2::apply_transform (const Transformation2f & t)
+    {
+        set_transform (t * transform);
     }
 
     void Canvas_ES2::clear ()
     {
-        glClear (GL_COLOR_BUFFER_BIT);
+        flush ();
+
+        if (depth_capacity > 0)
+        {
+            // glClear() respeta la máscara de escritura de profundidad:
+
+            State_Cache::set_depth_writes (true);
+
+            glClear (GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+            depth_base = 0;
+        }
+        else
+            glClear (GL_COLOR_BUFFER_BIT);
     }
 
     void Canvas_ES2::draw_point (const Point2f & position)
     {
-        shader_program_f->use ();
-
-        glEnableVertexAttribArray  (0);
-        glDisableVertexAttribArray (1);
-        glVertexAttribPointer      (0, 2, GL_FLOAT, GL_FALSE, 0, position.coordinates);
-        glDrawArrays               (GL_POINTS, 0, 1);
+        draw_flat (GL_POINTS, &position, 1);
     }
 
     void Canvas_ES2::draw_segment (const Point2f & a, const Point2f & b)
     {
-        shader_program_f->use ();
-
         const Point2f coordinates[] = { a, b };
 
-        glEnableVertexAttribArray  (0);
-        glDisableVertexAttribArray (1);
-        glVertexAttribPointer      (0, 2, GL_FLOAT, GL_FALSE, 0, coordinates);
-        glDrawArrays               (GL_LINES, 0, 2);
+        draw_flat (GL_LINES, coordinates, 2);
     }
 
     void Canvas_ES2::draw_triangle (const Point2f & a, const Point2f & b, const Point2f & c)
     {
-        shader_program_f->use ();
-
         const Point2f coordinates[] = { a, b, c, a };
 
-        glEnableVertexAttribArray  (0);
-        glDisableVertexAttribArray (1);
-        glVertexAttribPointer      (0, 2, GL_FLOAT, GL_FALSE, 0, coordinates);
-        glDrawArrays               (GL_LINE_STRIP, 0, 4);
+        draw_flat (GL_LINE_STRIP, coordinates, 4);
     }
 
     void Canvas_ES2::fill_triangle (const Point2f & a, const Point2f & b, const Point2f & c)
     {
-        shader_program_f->use ();
-
         const Point2f coordinates[] = { a, b, c };
 
-        glEnableVertexAttribArray  (0);
-        glDisableVertexAttribArray (1);
-        glVertexAttribPointer      (0, 2, GL_FLOAT, GL_FALSE, 0, coordinates);
-        glDrawArrays               (GL_TRIANGLES, 0, 3);
+        draw_flat (GL_TRIANGLES, coordinates, 3);
     }
 
     void Canvas_ES2::draw_rectangle (const Point2f & bottom_left, const Size2f & size)
     {
-        shader_program_f->use ();
-
         Point2f top_right{ bottom_left.coordinates.x () + size.width, bottom_left.coordinates.y () + size.height };
 
         const Point2f coordinates[] =
@@ -284,16 +842,11 @@ namespace basics { namespace opengles
               bottom_left
         };
 
-        glEnableVertexAttribArray  (0);
-        glDisableVertexAttribArray (1);
-        glVertexAttribPointer      (0, 2, GL_FLOAT, GL_FALSE, 0, coordinates);
-        glDrawArrays               (GL_LINE_STRIP, 0, 5);
+        draw_flat (GL_LINE_STRIP, coordinates, 5);
     }
 
     void Canvas_ES2::fill_rectangle (const Point2f & bottom_left, const Size2f & size)
     {
-        shader_program_f->use ();
-
         Point2f top_right{ bottom_left.coordinates.x () + size.width, bottom_left.coordinates.y () + size.height };
 
         const Point2f coordinates[] =
@@ -304,18 +857,17 @@ namespace basics { namespace opengles
                 top_right,
         };
 
-        glEnableVertexAttribArray  (0);
-        glDisableVertexAttribArray (1);
-        glVertexAttribPointer      (0, 2, GL_FLOAT, GL_FALSE, 0, coordinates);
-        glDrawArrays               (GL_TRIANGLE_STRIP, 0, 4);
+        draw_flat (GL_TRIANGLE_STRIP, coordinates, 4);
     }
 
     void Canvas_ES2::fill_rectangle (const Point2f & where, const Size2f & size, const basics::Texture_2D * texture, int handling)
     {
-        const opengles::Texture_2D * opengl_es_texture = dynamic_cast< const opengles::Texture_2D * >(texture);
+        // La etiqueta de la textura se comprueba en lugar de usar dynamic_cast en cada quad:
 
-        if (opengl_es_texture)
+        if (texture && texture->get_backend () == ID(opengles2))
         {
+            const opengles::Texture_2D * opengl_es_texture = static_cast< const opengles::Texture_2D * >(texture);
+
                   Point2f   bottom_left;
             const Point2f * texture_uvs;
 
@@ -342,28 +894,7 @@ namespace basics { namespace opengles
                 default:               texture_uvs = normal_texture_uvs; break;
             }
 
-            Point2f top_right
-            {
-                bottom_left.coordinates.x () + size.width,
-                bottom_left.coordinates.y () + size.height
-            };
-
-            const Point2f coordinates[] =
-            {
-                  bottom_left,
-                { bottom_left.coordinates.x (),   top_right.coordinates.y () },
-                {   top_right.coordinates.x (), bottom_left.coordinates.y () },
-                    top_right,
-            };
-
-            opengl_es_texture->use ();
-            shader_program_t ->use ();
-
-            glEnableVertexAttribArray (  vertex_position_location_t);
-            glEnableVertexAttribArray (vertex_texture_uv_location_t);
-            glVertexAttribPointer     (  vertex_position_location_t, 2, GL_FLOAT, GL_FALSE, 0, coordinates);
-            glVertexAttribPointer     (vertex_texture_uv_location_t, 2, GL_FLOAT, GL_FALSE, 0, texture_uvs);
-            glDrawArrays              (GL_TRIANGLE_STRIP, 0, 4);
+            record_quad (opengl_es_texture, bottom_left, size, texture_uvs);
         }
     }
 
@@ -374,10 +905,12 @@ namespace basics { namespace opengles
             return;
         }
 
-        const opengles::Texture_2D * opengl_es_texture = dynamic_cast< const opengles::Texture_2D * >(slice->atlas->get_texture ().get ());
+        const basics::Texture_2D * texture = slice->atlas->get_texture ().get ();
 
-        if (opengl_es_texture)
+        if (texture && texture->get_backend () == ID(opengles2))
         {
+            const opengles::Texture_2D * opengl_es_texture = static_cast< const opengles::Texture_2D * >(texture);
+
             float   horizontal_ratio  = 1.f / opengl_es_texture->get_width  ();
             float     vertical_ratio  = 1.f / opengl_es_texture->get_height ();
             float   normalized_left   = slice->left   * horizontal_ratio;
@@ -420,29 +953,234 @@ namespace basics { namespace opengles
                 std::swap (texture_uvs[2][1], texture_uvs[3][1]);
             }
 
-            Point2f top_right
+            record_quad (opengl_es_texture, bottom_left, size, texture_uvs);
+        }
+    }
+
+    void Canvas_ES2::draw_instances (const basics::Texture_2D * texture, const Instance * instances, size_t count, int handling)
+    {
+        if (!texture || texture->get_backend () != ID(opengles2) || !instances || !count || !shader_program_i->is_usable ())
+        {
+            return;
+        }
+
+        flush ();
+
+        static_cast< const Texture_2D * >(texture)->use ();
+
+        shader_program_i->use ();
+        shader_program_i->set_uniform_value (alpha_plane_i_id, static_cast< const Texture_2D * >(texture)->has_alpha_plane () ? 1.f : 0.f);
+        shader_program_i->set_uniform_value (alpha_only_i_id,  static_cast< const Texture_2D * >(texture)->is_alpha_only   () ? 1.f : 0.f);
+        shader_program_i->set_uniform_value (premultiplied_i_id, texture->is_premultiplied () ? 1.f : 0.f);
+
+        State_Cache::set_vertex_attributes
+        (
+            (1u <<    vertex_corner_location_i) |
+            (1u <<    instance_rect_location_i) |
+            (1u << instance_uv_rect_location_i) |
+            (1u << instance_opacity_location_i)
+        );
+
+        // Fracción del tamaño que hay que restar a la posición para llegar a la esquina inferior izquierda:
+
+        float anchor_x = (handling & 0x03) == LEFT   ? 0.f : (handling & 0x03) == RIGHT ? 1.f : .5f;
+        float anchor_y = (handling & 0x0C) == BOTTOM ? 0.f : (handling & 0x0C) == TOP   ? 1.f : .5f;
+
+        for (size_t first = 0; first < count; first += max_instances_per_draw)
+        {
+            size_t last = std::min (count, first + max_instances_per_draw);
+
+            instance_data.clear ();
+
+            for (size_t index = first; index < last; ++index)
             {
-                bottom_left.coordinates.x () + size.width,
-                bottom_left.coordinates.y () + size.height
-            };
+                const Instance & instance = instances[index];
+
+                instance_data.push_back
+                ({
+                    instance.position[0] - instance.size.width  * anchor_x,
+                    instance.position[1] - instance.size.height * anchor_y,
+                    instance.size.width,
+                    instance.size.height,
+                    instance.uv_bottom_left[0],
+                    instance.uv_bottom_left[1],
+                    instance.uv_top_right  [0],
+                    instance.uv_top_right  [1],
+                    instance.opacity
+                });
+            }
+
+            if (Extensions::has_instancing ()) draw_instanced (); else draw_expanded ();
+
+            statistics.draw_calls++;
+        }
+
+        statistics.quads += unsigned(count);
+    }
+
+    void Canvas_ES2::draw_instanced ()
+    {
+        // Cada glVertexAttribPointer() toma el buffer enlazado en ese momento, por lo que no importa
+        // que el anillo cambie de buffer entre las dos subidas:
+
+        size_t corners_offset = vertex_buffer_ring->upload (quad_corners, sizeof(quad_corners));
+
+        glVertexAttribPointer (vertex_corner_location_i, 2, GL_FLOAT, GL_FALSE, 0, buffer_offset (corners_offset));
+
+        size_t offset = vertex_buffer_ring->upload (instance_data.data (), instance_data.size () * sizeof(Instance_Data));
+
+        glVertexAttribPointer (   instance_rect_location_i, 4, GL_FLOAT, GL_FALSE, sizeof(Instance_Data), buffer_offset (offset + offsetof(Instance_Data, x      )));
+        glVertexAttribPointer (instance_uv_rect_location_i, 4, GL_FLOAT, GL_FALSE, sizeof(Instance_Data), buffer_offset (offset + offsetof(Instance_Data, u0     )));
+        glVertexAttribPointer (instance_opacity_location_i, 1, GL_FLOAT, GL_FALSE, sizeof(Instance_Data), buffer_offset (offset + offsetof(Instance_Data, opacity)));
+
+        Extensions::vertex_attrib_divisor (   instance_rect_location_i, 1);
+        Extensions::vertex_attrib_divisor (instance_uv_rect_location_i, 1);
+        Extensions::vertex_attrib_divisor (instance_opacity_location_i, 1);
+
+        Extensions::draw_arrays_instanced (GL_TRIANGLE_STRIP, 0, 4, GLsizei(instance_data.size ()));
+
+        // Los otros programas usan los mismos índices de atributo sin divisor:
+
+        Extensions::vertex_attrib_divisor (   instance_rect_location_i, 0);
+        Extensions::vertex_attrib_divisor (instance_uv_rect_location_i, 0);
+        Extensions::vertex_attrib_divisor (instance_opacity_location_i, 0);
+    }
+
+    void Canvas_ES2::draw_expanded ()
+    {
+        instance_vertices.clear ();
 
-            const Point2f coordinates[] =
+        for (const Instance_Data & instance : instance_data)
+        {
+            for (unsigned corner = 0; corner < 8; corner += 2)
             {
-                  bottom_left,
-                { bottom_left.coordinates.x (),   top_right.coordinates.y () },
-                {   top_right.coordinates.x (), bottom_left.coordinates.y () },
-                    top_right,
-            };
+                instance_vertices.push_back ({ quad_corners[corner], quad_corners[corner + 1], instance });
+            }
+        }
+
+        size_t offset = vertex_buffer_ring->upload (instance_vertices.data (), instance_vertices.size () * sizeof(Instance_Vertex));
 
-            opengl_es_texture->use ();
-            shader_program_t ->use ();
+        quad_index_buffer->use ();
+
+        const size_t instance = offset + offsetof(Instance_Vertex, instance);
+
+        glVertexAttribPointer (   vertex_corner_location_i, 2, GL_FLOAT, GL_FALSE, sizeof(Instance_Vertex), buffer_offset (offset   + offsetof(Instance_Vertex, corner_x)));
+        glVertexAttribPointer (   instance_rect_location_i, 4, GL_FLOAT, GL_FALSE, sizeof(Instance_Vertex), buffer_offset (instance + offsetof(Instance_Data,   x       )));
+        glVertexAttribPointer (instance_uv_rect_location_i, 4, GL_FLOAT, GL_FALSE, sizeof(Instance_Vertex), buffer_offset (instance + offsetof(Instance_Data,   u0      )));
+        glVertexAttribPointer (instance_opacity_location_i, 1, GL_FLOAT, GL_FALSE, sizeof(Instance_Vertex), buffer_offset (instance + offsetof(Instance_Data,   opacity )));
+        glDrawElements        (GL_TRIANGLES, GLsizei(instance_data.size () * 6), GL_UNSIGNED_SHORT, buffer_offset (0));
+    }
+
+    void Canvas_ES2::draw_text (const Point2f & where, const Text_Layout & text_layout, int handling)
+    {
+        const basics::Texture_2D * texture = text_layout.get_texture ();
 
-            glEnableVertexAttribArray (  vertex_position_location_t);
-            glEnableVertexAttribArray (vertex_texture_uv_location_t);
-            glVertexAttribPointer     (  vertex_position_location_t, 2, GL_FLOAT, GL_FALSE, 0, coordinates);
-            glVertexAttribPointer     (vertex_texture_uv_location_t, 2, GL_FLOAT, GL_FALSE, 0, texture_uvs);
-            glDrawArrays              (GL_TRIANGLE_STRIP, 0, 4);
+        if (texture && texture->get_backend () == ID(opengles2))
+        {
+            const Texture_2D * opengl_es_texture = static_cast< const Texture_2D * >(texture);
+
+            Point2f top_left = get_text_top_left (where, text_layout, handling);
+
+            // Los vértices y el área salen del mismo cálculo aunque el layout no tenga la caché activa:
+
+            const float                    * m        = transform.matrix.values;
+            const Text_Layout::Vertex_List & vertices = text_layout.get_vertices   ();
+            float                            area     = text_layout.get_glyph_area () * std::abs (m[0] * m[4] - m[1] * m[3]);
+
+            if (sorting)
+            {
+                // El bloque entero se graba como un solo comando. La lista se queda con una copia de
+                // los vértices ya desplazados (y transformados si el baking está activo, ya que en ese
+                // caso la transformación puede cambiar antes de que se envíen los comandos):
+
+                Transformation2f block_transform;
+
+                if (transform_baking)
+                {
+                    block_transform = offset_transform (transform, top_left);
+                }
+                else
+                {
+                    block_transform.matrix[0][2] = top_left[0];
+                    block_transform.matrix[1][2] = top_left[1];
+                }
+
+                commands.add_block
+                (
+                    layer,
+                    shader_program_t->id (),
+                    opengl_es_texture->get_texture_object_id (),
+                    opengl_es_texture,
+                    vertices.data (),
+                    vertices.size (),
+                    block_transform,
+                    area,
+                    get_blend_factor ()
+                );
+            }
+            else
+            {
+                // Los vértices están en el espacio del layout y se quedan en caché dentro de él. Se
+                // envían tal cual en un solo bloque y el desplazamiento lo aplica la transformación:
+
+                draw_vertex_block (opengl_es_texture, vertices.data (), vertices.size (), offset_transform (transform, top_left), area, get_blend_factor ());
+            }
         }
     }
 
+    void Canvas_ES2::draw_vertex_block
+    (
+        const Texture_2D          * texture,
+        const Text_Layout::Vertex * vertices,
+        size_t                      vertex_count,
+        const Transformation2f    & block_transform,
+        float                       area,
+        float                       blend
+    )
+    {
+        if (vertex_count == 0) return;
+
+        flush_batch ();
+
+        texture         ->use ();
+        shader_program_t->use ();
+        shader_program_t->set_uniform_value (alpha_plane_t_id, texture->has_alpha_plane () ? 1.f : 0.f);
+        shader_program_t->set_uniform_value (alpha_only_t_id,  texture->is_alpha_only   () ? 1.f : 0.f);
+        shader_program_t->set_uniform_value (premultiplied_t_id, texture->is_premultiplied () ? 1.f : 0.f);
+
+        // Los vértices del bloque no se transforman en la CPU aunque el baking esté activo, sino con la
+        // transformación que se recibe:
+
+        shader_program_t->set_uniform_value (transform_t_id, block_transform.matrix);
+
+        // El índice de quads solo cubre max_batch_quads, por lo que un texto más largo se trocea:
+
+        const size_t block_size = max_batch_quads * 4;
+
+        for (size_t first = 0; first < vertex_count; first += block_size)
+        {
+            size_t count  = std::min (block_size, vertex_count - first);
+            size_t buffer = vertex_buffer_ring->upload (vertices + first, count * sizeof(Text_Layout::Vertex));
+
+            quad_index_buffer->use ();
+
+            State_Cache::set_vertex_attributes ((1u << vertex_position_location_t) | (1u << vertex_texture_uv_location_t));
+
+            glVertexAttrib1f          (     vertex_blend_location_t, blend);
+            glVertexAttribPointer     (  vertex_position_location_t, 2, GL_FLOAT, GL_FALSE, sizeof(Text_Layout::Vertex), buffer_offset (buffer + offsetof(Text_Layout::Vertex, x)));
+            glVertexAttribPointer     (vertex_texture_uv_location_t, 2, GL_FLOAT, GL_FALSE, sizeof(Text_Layout::Vertex), buffer_offset (buffer + offsetof(Text_Layout::Vertex, u)));
+            glDrawElements            (GL_TRIANGLES, GLsizei(count / 4 * 6), GL_UNSIGNED_SHORT, buffer_offset (0));
+
+            statistics.draw_calls++;
+        }
+
+        shader_program_t->set_uniform_value (transform_t_id, transform_baking ? Transformation2f().matrix : transform.matrix);
+
+        unsigned pixels = unsigned(area + .5f);
+
+        statistics.quads          += unsigned(vertex_count / 4);
+        statistics. filled_pixels += pixels;
+        statistics.blended_pixels += pixels;
+    }
+
 }}
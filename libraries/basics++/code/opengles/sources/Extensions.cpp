@@ -0,0 +1,91 @@
+/*
+ * EXTENSIONS
+ * Copyright © 2018+ Ángel Rodríguez Ballesteros
+ *
+ * Distributed under the Boost Software License, version 1.0
+ * See the LICENSE file or www.boost.org/LICENSE_1_0.txt
+ *
+ * angel.rodriguez@esne.edu
+ *
+ * C2610171810
+ */
+
+#include <cstring>
+#include <EGL/egl.h>
+#include <basics/opengles/Extensions>
+
+namespace basics { namespace opengles
+{
+
+    Extensions::Draw_Arrays_Instanced Extensions::draw_arrays_instanced = nullptr;
+    Extensions::Vertex_Attrib_Divisor Extensions::vertex_attrib_divisor = nullptr;
+
+    template< typename FUNCTION >
+    static FUNCTION get_function (const char * name)
+    {
+        return reinterpret_cast< FUNCTION >(eglGetProcAddress (name));
+    }
+
+    void Extensions::load ()
+    {
+        draw_arrays_instanced = nullptr;
+        vertex_attrib_divisor = nullptr;
+
+        // Aunque se pida un contexto de OpenGL ES 2, muchos drivers devuelven uno de OpenGL ES 3, que
+        // incluye el dibujado con instancias. Si no, se prueba con las extensiones de OpenGL ES 2:
+
+        if (is_es3 ())
+        {
+            draw_arrays_instanced = get_function< Draw_Arrays_Instanced > ("glDrawArraysInstanced");
+            vertex_attrib_divisor = get_function< Vertex_Attrib_Divisor > ("glVertexAttribDivisor");
+        }
+        else
+        if (has_extension ("GL_EXT_instanced_arrays"))
+        {
+            draw_arrays_instanced = get_function< Draw_Arrays_Instanced > ("glDrawArraysInstancedEXT");
+            vertex_attrib_divisor = get_function< Vertex_Attrib_Divisor > ("glVertexAttribDivisorEXT");
+        }
+        else
+        if (has_extension ("GL_ANGLE_instanced_arrays"))
+        {
+            draw_arrays_instanced = get_function< Draw_Arrays_Instanced > ("glDrawArraysInstancedANGLE");
+            vertex_attrib_divisor = get_function< Vertex_Attrib_Divisor > ("glVertexAttribDivisorANGLE");
+        }
+
+        if (!has_instancing ())
+        {
+            draw_arrays_instanced = nullptr;
+            vertex_attrib_divisor = nullptr;
+        }
+    }
+
+    bool Extensions::is_es3 ()
+    {
+        const char * version = reinterpret_cast< const char * >(glGetString (GL_VERSION));
+
+        return version && std::strncmp (version, "OpenGL ES ", 10) == 0 && version[10] >= '3';
+    }
+
+    bool Extensions::has_extension (const char * name)
+    {
+        const char * extensions = reinterpret_cast< const char * >(glGetString (GL_EXTENSIONS));
+
+        if (extensions && name)
+        {
+            size_t length = std::strlen (name);
+
+            // Se busca el nombre completo, no como parte de otro más largo:
+
+            for (const char * found = std::strstr (extensions, name); found; found = std::strstr (found + length, name))
+            {
+                if ((found == extensions || found[-1] == ' ') && (found[length] == ' ' || found[length] == '\0'))
+                {
+                    return true;
+                }
+            }
+        }
+
+        return false;
+    }
+
+}}
@@ -0,0 +1,46 @@
+/*
+ * INDEX BUFFER
+ * Copyright © 2018+ Ángel Rodríguez Ballesteros
+ *
+ * Distributed under the Boost Software License, version 1.0
+ * See the LICENSE file or www.boost.org/LICENSE_1_0.txt
+ *
+ * angel.rodriguez@esne.edu
+ *
+ * C2610171225
+ */
+
+#include <basics/assert>
+#include <basics/opengles/Index_Buffer>
+
+namespace basics { namespace opengles
+{
+
+    bool Index_Buffer::initialize ()
+    {
+        if (!initialized)
+        {
+            if (indices.size () > 0)
+            {
+                glGenBuffers (1, &buffer_object_id);
+
+                State_Cache::bind_buffer (GL_ELEMENT_ARRAY_BUFFER, buffer_object_id);
+
+                glBufferData
+                (
+                    GL_ELEMENT_ARRAY_BUFFER,
+                    GLsizeiptr(indices.size () * sizeof(GLushort)),
+                    indices.data (),
+                    GL_STATIC_DRAW
+                );
+
+                assert(glGetError () == GL_NO_ERROR);
+
+                initialized = true;
+            }
+        }
+
+        return initialized;
+    }
+
+}}
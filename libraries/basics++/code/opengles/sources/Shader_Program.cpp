@@ -25,6 +25,8 @@ namespace basics { namespace opengles
         {
             if (source_code.size () > 0)
             {
+                uniform_cache.clear ();
+
                 program_object_id = glCreateProgram ();
 
                 assert(program_object_id != 0);
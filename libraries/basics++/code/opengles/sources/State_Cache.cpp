@@ -0,0 +1,222 @@
+/*
+ * STATE CACHE
+ * Copyright © 2018+ Ángel Rodríguez Ballesteros
+ *
+ * Distributed under the Boost Software License, version 1.0
+ * See the LICENSE file or www.boost.org/LICENSE_1_0.txt
+ *
+ * angel.rodriguez@esne.edu
+ *
+ * C2610171310
+ */
+
+#include <basics/assert>
+#include <basics/opengles/State_Cache>
+
+namespace basics { namespace opengles
+{
+
+    constexpr unsigned        State_Cache::max_vertex_attributes;
+
+    GLuint                    State_Cache::program              = 0;
+    GLuint                    State_Cache::texture              = 0;
+    GLenum                    State_Cache::texture_unit         = GL_TEXTURE0;
+    GLuint                    State_Cache::array_buffer         = 0;
+    GLuint                    State_Cache::element_array_buffer = 0;
+    unsigned                  State_Cache::enabled_attributes   = 0;
+    bool                      State_Cache::blending             = false;
+    GLenum                    State_Cache::blend_source         = GL_ONE;
+    GLenum                    State_Cache::blend_destination    = GL_ZERO;
+    bool                      State_Cache::depth_test           = false;
+    bool                      State_Cache::depth_writes         = true;
+    State_Cache::Statistics   State_Cache::statistics           = { 0, 0 };
+
+    // ---------------------------------------------------------------------------------------------
+
+    void State_Cache::invalidate ()
+    {
+        // Se lleva el contexto a un estado conocido emitiendo todos los cambios sin comprobar nada:
+
+        glUseProgram    (program      = 0);
+        glActiveTexture (texture_unit = GL_TEXTURE0);
+        glBindTexture   (GL_TEXTURE_2D,           texture              = 0);
+        glBindBuffer    (GL_ARRAY_BUFFER,         array_buffer         = 0);
+        glBindBuffer    (GL_ELEMENT_ARRAY_BUFFER, element_array_buffer = 0);
+        glDisable       (GL_BLEND);
+        glBlendFunc     (blend_source = GL_ONE, blend_destination = GL_ZERO);
+        glDisable       (GL_DEPTH_TEST);
+        glDepthMask     (GL_TRUE);
+        glDepthFunc     (GL_LESS);
+
+        for (GLuint index = 0; index < max_vertex_attributes; ++index)
+        {
+            glDisableVertexAttribArray (index);
+        }
+
+        blending           = false;
+        depth_test         = false;
+        depth_writes       = true;
+        enabled_attributes = 0;
+        statistics.issued += 10 + max_vertex_attributes;
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    void State_Cache::use_program (GLuint program_object_id)
+    {
+        if (program == program_object_id) { statistics.skipped++; return; }
+
+        glUseProgram (program = program_object_id);
+
+        statistics.issued++;
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    void State_Cache::bind_texture (GLuint texture_object_id)
+    {
+        if (texture == texture_object_id) { statistics.skipped++; return; }
+
+        glBindTexture (GL_TEXTURE_2D, texture = texture_object_id);
+
+        statistics.issued++;
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    void State_Cache::set_active_texture_unit (GLenum unit)
+    {
+        if (texture_unit == unit) { statistics.skipped++; return; }
+
+        glActiveTexture (texture_unit = unit);
+
+        statistics.issued++;
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    void State_Cache::bind_buffer (GLenum target, GLuint buffer_object_id)
+    {
+        GLuint & bound = target == GL_ELEMENT_ARRAY_BUFFER ? element_array_buffer : array_buffer;
+
+        if (bound == buffer_object_id) { statistics.skipped++; return; }
+
+        glBindBuffer (target, bound = buffer_object_id);
+
+        statistics.issued++;
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    void State_Cache::enable_vertex_attribute (GLuint index)
+    {
+        assert(index < max_vertex_attributes);
+
+        unsigned mask = 1u << index;
+
+        if ((enabled_attributes & mask)) { statistics.skipped++; return; }
+
+        glEnableVertexAttribArray (index);
+
+        enabled_attributes |= mask;
+        statistics.issued++;
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    void State_Cache::disable_vertex_attribute (GLuint index)
+    {
+        assert(index < max_vertex_attributes);
+
+        unsigned mask = 1u << index;
+
+        if (!(enabled_attributes & mask)) { statistics.skipped++; return; }
+
+        glDisableVertexAttribArray (index);
+
+        enabled_attributes &= ~mask;
+        statistics.issued++;
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    void State_Cache::set_vertex_attributes (unsigned enabled_mask)
+    {
+        // Deja activos exactamente los arrays indicados para que no quede ninguno activo de un
+        // programa anterior:
+
+        for (GLuint index = 0; index < max_vertex_attributes; ++index)
+        {
+            unsigned mask = 1u << index;
+
+            if (enabled_mask & mask)
+                enable_vertex_attribute  (index);
+            else
+            if (enabled_attributes & mask)
+                disable_vertex_attribute (index);
+        }
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    void State_Cache::set_blending (bool enabled)
+    {
+        if (blending == enabled) { statistics.skipped++; return; }
+
+        if (enabled) glEnable (GL_BLEND); else glDisable (GL_BLEND);
+
+        blending = enabled;
+        statistics.issued++;
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    void State_Cache::set_blend_function (GLenum source, GLenum destination)
+    {
+        if (blend_source == source && blend_destination == destination) { statistics.skipped++; return; }
+
+        glBlendFunc (blend_source = source, blend_destination = destination);
+
+        statistics.issued++;
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    void State_Cache::set_depth_test (bool enabled)
+    {
+        if (depth_test == enabled) { statistics.skipped++; return; }
+
+        if (enabled) glEnable (GL_DEPTH_TEST); else glDisable (GL_DEPTH_TEST);
+
+        depth_test = enabled;
+        statistics.issued++;
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    void State_Cache::set_depth_writes (bool enabled)
+    {
+        if (depth_writes == enabled) { statistics.skipped++; return; }
+
+        glDepthMask (enabled ? GL_TRUE : GL_FALSE);
+
+        depth_writes = enabled;
+        statistics.issued++;
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    void State_Cache::forget_texture (GLuint texture_object_id)
+    {
+        if (texture == texture_object_id) texture = 0;
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    void State_Cache::forget_buffer (GLuint buffer_object_id)
+    {
+        if (        array_buffer == buffer_object_id)         array_buffer = 0;
+        if (element_array_buffer == buffer_object_id) element_array_buffer = 0;
+    }
+
+}}
@@ -10,74 +10,381 @@
  * C1801221334
  */
 
+#include <algorithm>
 #include <basics/assert>
+#include <basics/Log>
+#include <basics/mipmap>
+#include <basics/opengles/Extensions>
 #include <basics/opengles/Texture_2D>
 
 namespace basics { namespace opengles
 {
 
+    // Enums de los formatos comprimidos. No todos están en las cabeceras de OpenGL ES 2:
+
+    #ifndef GL_ETC1_RGB8_OES
+        #define GL_ETC1_RGB8_OES                          0x8D64
+    #endif
+    #ifndef GL_COMPRESSED_RGB8_ETC2
+        #define GL_COMPRESSED_RGB8_ETC2                   0x9274
+    #endif
+    #ifndef GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2
+        #define GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2 0x9276
+    #endif
+    #ifndef GL_COMPRESSED_RGBA8_ETC2_EAC
+        #define GL_COMPRESSED_RGBA8_ETC2_EAC              0x9278
+    #endif
+    #ifndef GL_COMPRESSED_RGBA_ASTC_4x4_KHR
+        #define GL_COMPRESSED_RGBA_ASTC_4x4_KHR           0x93B0
+    #endif
+
     const Texture_2D * Texture_2D::active_texture = nullptr;
 
-    std::shared_ptr< basics::Texture_2D > Texture_2D::create (Id id, Color_Buffer< Rgba8888 > & color_buffer, const Options & options)
+    // Descarta los errores pendientes para que el que se comprueba después de una subida sea el suyo.
+    // Cada llamada a glGetError() limpia un solo flag, por lo que basta con unas pocas vueltas (con el
+    // contexto perdido algunas implementaciones devuelven un error en todas las llamadas):
+
+    static inline void discard_gl_errors ()
+    {
+        for (unsigned count = 0; count < 8 && glGetError () != GL_NO_ERROR; ++count);
+    }
+
+    std::shared_ptr< basics::Texture_2D > Texture_2D::create (Id , Color_Buffer< Rgba8888 > & color_buffer, const Options & options)
+    {
+        return std::shared_ptr< Texture_2D >(new Texture_2D(std::move (color_buffer), options));
+    }
+
+    std::shared_ptr< basics::Texture_2D > Texture_2D::create (Id , Compressed_Image & image, const Options & options)
     {
-        return std::shared_ptr< Texture_2D >(new Texture_2D(color_buffer, options.width, options.height));
+        return std::shared_ptr< Texture_2D >(new Texture_2D(std::move (image), options));
+    }
+
+    GLenum Texture_2D::get_compressed_format (Compressed_Image::Format format, unsigned block_width, unsigned block_height)
+    {
+        static const unsigned astc_block_sizes[14][2] =
+        {
+            {  4, 4 }, {  5, 4 }, {  5,  5 }, {  6,  5 }, {  6, 6 }, { 8, 5 }, { 8, 6 },
+            {  8, 8 }, { 10, 5 }, { 10,  6 }, { 10,  8 }, { 10, 10 }, { 12, 10 }, { 12, 12 },
+        };
+
+        GLenum candidates[2] = { 0, 0 };
+
+        switch (format)
+        {
+            case Compressed_Image::ETC1_RGB:
+            {
+                // ETC2 es compatible con ETC1, así que en OpenGL ES 3 sirve aunque falte la extensión:
+
+                candidates[0] = GL_ETC1_RGB8_OES;
+                candidates[1] = GL_COMPRESSED_RGB8_ETC2;
+                break;
+            }
+
+            case Compressed_Image::ETC2_RGB:    candidates[0] = GL_COMPRESSED_RGB8_ETC2;                    break;
+            case Compressed_Image::ETC2_RGB_A1: candidates[0] = GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2; break;
+            case Compressed_Image::ETC2_RGBA:   candidates[0] = GL_COMPRESSED_RGBA8_ETC2_EAC;               break;
+
+            case Compressed_Image::ASTC_RGBA:
+            {
+                for (GLenum index = 0; index < 14; ++index)
+                {
+                    if (astc_block_sizes[index][0] == block_width && astc_block_sizes[index][1] == block_height)
+                    {
+                        candidates[0] = GL_COMPRESSED_RGBA_ASTC_4x4_KHR + index;
+                    }
+                }
+
+                break;
+            }
+
+            default: return 0;
+        }
+
+        // El contexto enumera todos los formatos comprimidos que acepta glCompressedTexImage2D():
+
+        GLint count = 0;
+
+        glGetIntegerv (GL_NUM_COMPRESSED_TEXTURE_FORMATS, &count);
+
+        if (count > 0)
+        {
+            std::vector< GLint > supported(count);
+
+            glGetIntegerv (GL_COMPRESSED_TEXTURE_FORMATS, supported.data ());
+
+            for (GLenum candidate : candidates)
+            {
+                if (candidate && std::find (supported.begin (), supported.end (), GLint(candidate)) != supported.end ())
+                {
+                    return candidate;
+                }
+            }
+        }
+
+        return 0;
     }
 
     bool Texture_2D::initialize ()
     {
         if (!initialized)
         {
-            if (color_buffer.size () > 0)
+            // Si los píxeles se liberaron tras la subida anterior (el contexto se ha perdido y se está
+            // restaurando), se vuelven a obtener según la política de residencia:
+
+            if (color_buffer.size () == 0 && compressed_image.empty () && can_reload_pixels ())
+            {
+                reload_pixels (color_buffer, compressed_image);
+            }
+
+            // Si el contexto no admite el formato comprimido se decodifica por software y se sube
+            // como cualquier otra imagen:
+
+            if (!compressed_image.empty () && !upload_compressed ())
+            {
+                if (!compressed_image.decode (color_buffer))
+                {
+                    log.e ("ERROR: the graphics context does not support the format of a compressed texture.");
+                }
+
+                compressed_image.clear ();
+            }
+
+            if (color_buffer.size () > 0 && !upload_pixels ())
+            {
+                log.e ("ERROR: the texture could not be uploaded to the graphics context.");
+            }
+
+            if (initialized)
             {
-                glEnable        (GL_TEXTURE_2D);////
-                glGenTextures   (1, &texture_object_id);
-                glBindTexture   (GL_TEXTURE_2D, texture_object_id);
-
-                glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-                glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-                glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-                glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-
-                glTexImage2D
-                (
-                    GL_TEXTURE_2D,
-                    0,
-                    GL_RGBA,
-                    color_buffer.get_width  (),
-                    color_buffer.get_height (),
-                    0,
-                    GL_RGBA,
-                    GL_UNSIGNED_BYTE,
-                    color_buffer
-                );
-
-                int error = glGetError ();
-
-                assert(glGetError () == GL_NO_ERROR);
                 assert(width > 0 && height > 0);
 
-                initialized = true;
+                // Una vez en la GPU solo se conservan los píxeles si no hay otra forma de recuperarlos:
+
+                if (can_reload_pixels ())
+                {
+                    color_buffer = Color_Buffer< Rgba8888 >();
+
+                    compressed_image.clear ();
+                }
             }
         }
 
         return initialized;
     }
 
-    bool Texture_2D::use () const
+    bool Texture_2D::upload_compressed ()
     {
-        assert(is_usable ());
+        GLenum format = get_compressed_format (compressed_image.get_format (), compressed_image.get_block_width (), compressed_image.get_block_height ());
+
+        if (!format) return false;
+
+        GLsizei                     upload_width  = compressed_image.get_width  ();
+        GLsizei                     upload_height = compressed_image.get_height ();
+        const std::vector< byte > & data          = compressed_image.get_data   ();
+        std::vector< byte >         stacked_data;
+
+        // Los bloques de ETC1 son independientes, así que el plano de alfa se puede poner debajo del
+        // color solo con concatenar sus datos. Para que la unión caiga justo en la mitad de la
+        // textura el alto tiene que ser múltiplo del tamaño de bloque:
+
+        alpha_plane = compressed_image.has_alpha_plane ();
+
+        if (alpha_plane)
+        {
+            if (upload_height % 4 != 0) return false;
+
+            stacked_data.reserve (data.size () * 2);
+            stacked_data.insert  (stacked_data.end (), data.begin (), data.end ());
+            stacked_data.insert  (stacked_data.end (), compressed_image.get_alpha_data ().begin (), compressed_image.get_alpha_data ().end ());
+
+            upload_height *= 2;
+        }
+
+        const std::vector< byte > & upload_data = alpha_plane ? stacked_data : data;
+
+        glGenTextures (1, &texture_object_id);
+
+        State_Cache::bind_texture (texture_object_id);
+
+        glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+        discard_gl_errors ();
 
-        //if (active_texture != this)
+        glCompressedTexImage2D (GL_TEXTURE_2D, 0, format, upload_width, upload_height, 0, GLsizei(upload_data.size ()), upload_data.data ());
+
+        if (glGetError () != GL_NO_ERROR)
+        {
+            glDeleteTextures (1, &texture_object_id);
+
+            State_Cache::forget_texture (texture_object_id);
+
+            alpha_plane = false;
+
+            return false;
+        }
+
+        initialized = true;
+
+        return true;
+    }
+
+    bool Texture_2D::upload_pixels ()
+    {
+        unsigned width  = color_buffer.get_width  ();
+        unsigned height = color_buffer.get_height ();
+
+        // En OpenGL ES 2 las texturas con lados que no son potencias de 2 no pueden tener mipmaps:
+
+        bool power_of_two = (width & (width - 1)) == 0 && (height & (height - 1)) == 0;
+        bool mipmapped    = mipmaps != NO_MIPMAPS && (power_of_two || Extensions::has_npot_mipmaps ());
+
+        discard_gl_errors ();
+
+        glGenTextures   (1, &texture_object_id);
+
+        State_Cache::bind_texture (texture_object_id);
+
+        GLint min_filter = !mipmapped ? GL_LINEAR : trilinear ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR_MIPMAP_NEAREST;
+
+        glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, min_filter);
+        glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+        if (!mipmapped)
         {
-            glBindTexture   (GL_TEXTURE_2D, texture_object_id);
-            glActiveTexture (GL_TEXTURE0);
+            upload_level (0, color_buffer);
+        }
+        else
+        {
+            // Los niveles se calculan alternando entre dos buffers para no tocar color_buffer, que
+            // puede hacer falta para volver a subir la textura. Primero se descartan los niveles que
+            // pida el ajuste de memoria (sin bajar de 1x1):
 
-            active_texture  = this;
+            Color_Buffer< Rgba8888 >         levels[2];
+            const Color_Buffer< Rgba8888 > * level   = &color_buffer;
+            unsigned                         dropped = 0;
 
-            return true;
+            for ( ; dropped < get_dropped_mip_levels () && (level->get_width () > 1 || level->get_height () > 1); ++dropped)
+            {
+                build_mip_level (*level, levels[dropped & 1]);
+
+                level = &levels[dropped & 1];
+            }
+
+            if (mipmaps == GPU_MIPMAPS)
+            {
+                upload_level (0, *level);
+
+                glGenerateMipmap (GL_TEXTURE_2D);
+            }
+            else for (GLint index = 0; ; ++index)
+            {
+                upload_level (index, *level);
+
+                if (level->get_width () == 1 && level->get_height () == 1) break;
+
+                Color_Buffer< Rgba8888 > & next = levels[(dropped + index) & 1];
+
+                build_mip_level (*level, next);
+
+                level = &next;
+            }
         }
 
-        return false;
+        // Si la GPU no ha podido crear la textura (por ejemplo, por falta de memoria) se libera el
+        // objeto y se deja sin inicializar, con los píxeles a mano para intentarlo de nuevo:
+
+        if (glGetError () != GL_NO_ERROR)
+        {
+            glDeleteTextures (1, &texture_object_id);
+
+            State_Cache::forget_texture (texture_object_id);
+
+            return false;
+        }
+
+        initialized = true;
+
+        return true;
+    }
+
+    void Texture_2D::upload_level (GLint level, const Color_Buffer< Rgba8888 > & pixels)
+    {
+        if (pixel_format == RGBA_8888)
+        {
+            glTexImage2D
+            (
+                GL_TEXTURE_2D,
+                level,
+                GL_RGBA,
+                pixels.get_width  (),
+                pixels.get_height (),
+                0,
+                GL_RGBA,
+                GL_UNSIGNED_BYTE,
+                pixels.buffer.data ()
+            );
+        }
+        else
+        {
+            // Los píxeles se convierten en una copia temporal para que el color_buffer que se
+            // conserva siga en RGBA8 (así se puede volver a convertir si se pierde el contexto):
+
+            GLenum format = GL_RGBA;
+            GLenum type   = GL_UNSIGNED_SHORT_4_4_4_4;
+
+            switch (pixel_format)
+            {
+                case RGB_565:     format = GL_RGB;       type = GL_UNSIGNED_SHORT_5_6_5;   break;
+                case RGBA_4444:   format = GL_RGBA;      type = GL_UNSIGNED_SHORT_4_4_4_4; break;
+                case RGBA_5551:   format = GL_RGBA;      type = GL_UNSIGNED_SHORT_5_5_5_1; break;
+                case ALPHA_8:     format = GL_ALPHA;     type = GL_UNSIGNED_BYTE;          break;
+                case LUMINANCE_8: format = GL_LUMINANCE; type = GL_UNSIGNED_BYTE;          break;
+                default: break;
+            }
+
+            unsigned            bytes_per_pixel = get_bytes_per_pixel (pixel_format);
+            std::vector< byte > converted(pixels.size () * bytes_per_pixel);
+
+            convert_pixels (pixels, pixel_format, dither, converted.data ());
+
+            // Las filas de 1 o 2 bytes por píxel no tienen por qué medir un múltiplo de 4 bytes:
+
+            glPixelStorei (GL_UNPACK_ALIGNMENT, GLint(bytes_per_pixel));
+
+            glTexImage2D
+            (
+                GL_TEXTURE_2D,
+                level,
+                format,
+                pixels.get_width  (),
+                pixels.get_height (),
+                0,
+                format,
+                type,
+                converted.data ()
+            );
+
+            glPixelStorei (GL_UNPACK_ALIGNMENT, 4);
+        }
+    }
+
+    bool Texture_2D::use () const
+    {
+        assert(is_usable ());
+
+        // Solo se usa la unidad de textura 0. State_Cache descarta los cambios que no hacen falta:
+
+        State_Cache::set_active_texture_unit (GL_TEXTURE0);
+        State_Cache::bind_texture            (texture_object_id);
+
+        active_texture = this;
+
+        return true;
     }
 
 }}
@@ -0,0 +1,75 @@
+/*
+ * VERTEX BUFFER RING
+ * Copyright © 2018+ Ángel Rodríguez Ballesteros
+ *
+ * Distributed under the Boost Software License, version 1.0
+ * See the LICENSE file or www.boost.org/LICENSE_1_0.txt
+ *
+ * angel.rodriguez@esne.edu
+ *
+ * C2610171220
+ */
+
+#include <basics/assert>
+#include <basics/opengles/Vertex_Buffer_Ring>
+
+namespace basics { namespace opengles
+{
+
+    bool Vertex_Buffer_Ring::initialize ()
+    {
+        if (!initialized)
+        {
+            if (capacity > 0 && buffer_object_ids.size () > 0)
+            {
+                glGenBuffers (GLsizei(buffer_object_ids.size ()), buffer_object_ids.data ());
+
+                for (auto buffer_object_id : buffer_object_ids)
+                {
+                    State_Cache::bind_buffer (GL_ARRAY_BUFFER, buffer_object_id);
+                    glBufferData             (GL_ARRAY_BUFFER, GLsizeiptr(capacity), nullptr, GL_STREAM_DRAW);
+                }
+
+                assert(glGetError () == GL_NO_ERROR);
+
+                cursor      = 0;
+                current     = 0;
+                initialized = true;
+            }
+        }
+
+        return initialized;
+    }
+
+    size_t Vertex_Buffer_Ring::upload (const void * data, size_t size)
+    {
+        assert(is_usable () && size <= capacity);
+
+        if (cursor + size > capacity)
+        {
+            // Se pasa al siguiente buffer y se huerfaniza su almacenamiento. Si la GPU todavía lo
+            // está leyendo, el driver le asigna memoria nueva en lugar de sincronizarse:
+
+            current = (current + 1) % unsigned(buffer_object_ids.size ());
+            cursor  = 0;
+
+            State_Cache::bind_buffer (GL_ARRAY_BUFFER, buffer_object_ids[current]);
+            glBufferData             (GL_ARRAY_BUFFER, GLsizeiptr(capacity), nullptr, GL_STREAM_DRAW);
+        }
+        else
+        {
+            State_Cache::bind_buffer (GL_ARRAY_BUFFER, buffer_object_ids[current]);
+        }
+
+        size_t offset = cursor;
+
+        glBufferSubData (GL_ARRAY_BUFFER, GLintptr(offset), GLsizeiptr(size), data);
+
+        // Se mantiene la alineación a 4 bytes de cada bloque de vértices:
+
+        cursor += (size + 3) & ~size_t(3);
+
+        return offset;
+    }
+
+}}
@@ -0,0 +1,32 @@
+/*
+ * INFLATE
+ * Copyright © 2018+ Ángel Rodríguez Ballesteros
+ *
+ * Distributed under the Boost Software License, version  1.0
+ * See documents/LICENSE.TXT or www.boost.org/LICENSE_1_0.txt
+ *
+ * angel.rodriguez@esne.edu
+ *
+ * C2610172322
+ */
+
+#ifndef BASICS_INFLATE_HEADER
+#define BASICS_INFLATE_HEADER
+
+    #include <cstddef>
+    #include <basics/types>
+
+    namespace basics
+    {
+
+        /**
+         * Descomprime un flujo deflate (sin la cabecera de zlib) con el mismo descompresor que usan
+         * los PNG. Los datos se escriben directamente en target, que debe tener el tamaño exacto de
+         * los datos descomprimidos, sin reservar memoria.
+         * @return true si los datos son válidos y ocupan justo target_size bytes.
+         */
+        bool inflate (const byte * source, size_t source_size, byte * target, size_t target_size);
+
+    }
+
+#endif
@@ -20,6 +20,17 @@
 
         bool png_decode (const std::vector< byte > & encoded_data, Color_Buffer< Rgba8888 > & color_buffer, unsigned & width, unsigned & height);
 
+        /**
+         * Además de decodificar la imagen indica si todos sus píxeles son opacos (alfa 255).
+         */
+        bool png_decode (const std::vector< byte > & encoded_data, Color_Buffer< Rgba8888 > & color_buffer, unsigned & width, unsigned & height, bool & opaque);
+
+        /**
+         * Decodifica la imagen directamente desde un bloque de memoria (por ejemplo, la vista que
+         * devuelve Asset::map()) sin necesidad de copiarla antes a un vector.
+         */
+        bool png_decode (const byte * encoded_data, size_t encoded_size, Color_Buffer< Rgba8888 > & color_buffer, unsigned & width, unsigned & height, bool & opaque);
+
     }
 
 #endif
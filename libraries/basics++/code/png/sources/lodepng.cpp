@@ -29,6 +29,7 @@ Rename this file to lodepng.cpp to use it for C++, or to lodepng.c to use it for
 */
 
 #include "lodepng.h"
+#include "png_internal.hpp"
 
 #include <limits.h>
 #include <stdio.h>
@@ -2123,10 +2124,9 @@ static unsigned adler32(const unsigned char* data, unsigned len)
 
 #ifdef LODEPNG_COMPILE_DECODER
 
-unsigned lodepng_zlib_decompress(unsigned char** out, size_t* outsize, const unsigned char* in,
-                                 size_t insize, const LodePNGDecompressSettings* settings)
+/*basics: the header checks of lodepng_zlib_decompress, shared with zlib_decompress_into*/
+static unsigned zlib_check_header(const unsigned char* in, size_t insize)
 {
-  unsigned error = 0;
   unsigned CM, CINFO, FDICT;
 
   if(insize < 2) return 53; /*error, size of zlib data too small*/
@@ -2155,6 +2155,15 @@ unsigned lodepng_zlib_decompress(unsigned char** out, size_t* outsize, const uns
     return 26;
   }
 
+  return 0;
+}
+
+unsigned lodepng_zlib_decompress(unsigned char** out, size_t* outsize, const unsigned char* in,
+                                 size_t insize, const LodePNGDecompressSettings* settings)
+{
+  unsigned error = zlib_check_header(in, insize);
+  if(error) return error;
+
   error = inflate(out, outsize, in + 2, insize - 2, settings);
   if(error) return error;
 
@@ -2168,6 +2177,25 @@ unsigned lodepng_zlib_decompress(unsigned char** out, size_t* outsize, const uns
   return 0; /*no error*/
 }
 
+/*basics: like zlib_decompress, but into a buffer of the caller that the data must fill exactly*/
+static unsigned zlib_decompress_into(unsigned char* out, size_t outsize, const unsigned char* in,
+                                     size_t insize, const LodePNGDecompressSettings* settings)
+{
+  unsigned error = zlib_check_header(in, insize);
+  if(error) return error;
+
+  error = basics::png_inflate_into(out, outsize, in + 2, insize - 2);
+  if(error) return error;
+
+  if(!settings->ignore_adler32)
+  {
+    if(insize < 6) return 53; /*error, size of zlib data too small*/
+    if(adler32(out, (unsigned)outsize) != lodepng_read32bitInt(&in[insize - 4])) return 58;
+  }
+
+  return 0;
+}
+
 static unsigned zlib_decompress(unsigned char** out, size_t* outsize, const unsigned char* in,
                                 size_t insize, const LodePNGDecompressSettings* settings)
 {
@@ -3981,6 +4009,9 @@ static unsigned unfilterScanline(unsigned char* recon, const unsigned char* scan
   */
 
   size_t i;
+
+  /*basics: SSE2/NEON paths for the common cases, see png_unfilter.cpp*/
+  if(basics::png_unfilter_scanline(recon, scanline, precon, bytewidth, filterType, length)) return 0;
   switch(filterType)
   {
     case 0:
@@ -4521,7 +4552,10 @@ static unsigned readChunk_pHYs(LodePNGInfo* info, const unsigned char* data, siz
 #endif /*LODEPNG_COMPILE_ANCILLARY_CHUNKS*/
 
 /*read a PNG, the result will be in the same color type as the PNG (hence "generic")*/
-static void decodeGeneric(unsigned char** out, unsigned* w, unsigned* h,
+/*target: if not NULL and the PNG color type is already the raw one, the image is written there instead of
+into a newly allocated buffer (targetsize must then be its exact size)*/
+static void decodeGeneric(unsigned char** out, unsigned char* target, size_t targetsize,
+                          size_t targetcapacity, unsigned* w, unsigned* h,
                           LodePNGState* state,
                           const unsigned char* in, size_t insize)
 {
@@ -4533,6 +4567,7 @@ static void decodeGeneric(unsigned char** out, unsigned* w, unsigned* h,
   size_t predict;
   size_t numpixels;
   size_t outsize = 0;
+  unsigned inplace;
 
   /*for unknown chunk order*/
   unsigned unknown = 0;
@@ -4710,6 +4745,31 @@ static void decodeGeneric(unsigned char** out, unsigned* w, unsigned* h,
     if(*w > 1) predict += lodepng_get_raw_size_idat((*w + 0) >> 1, (*h + 1) >> 1, color) + ((*h + 1) >> 1);
     predict += lodepng_get_raw_size_idat((*w + 0), (*h + 0) >> 1, color) + ((*h + 0) >> 1);
   }
+  outsize = lodepng_get_raw_size(*w, *h, &state->info_png.color);
+
+  /*basics: if the target also has room for the filtered scanlines, they are inflated straight into it
+  and unfiltered in place, as postProcessScanlines already does for images with padding bits. Then no
+  other buffer of the size of the image is allocated*/
+  inplace = target && outsize == targetsize && predict <= targetcapacity
+         && state->info_png.interlace_method == 0 && lodepng_get_bpp(&state->info_png.color) >= 8
+         && lodepng_color_mode_equal(&state->info_raw, &state->info_png.color);
+
+  if(inplace)
+  {
+    if(!state->error)
+    {
+      state->error = zlib_decompress_into(target, predict, idat.data, idat.size, &state->decoder.zlibsettings);
+    }
+    ucvector_cleanup(&idat);
+
+    if(!state->error)
+    {
+      *out = target;
+      state->error = unfilter(target, target, *w, *h, lodepng_get_bpp(&state->info_png.color));
+    }
+    return;
+  }
+
   if(!state->error && !ucvector_reserve(&scanlines, predict)) state->error = 83; /*alloc fail*/
   if(!state->error)
   {
@@ -4721,9 +4781,15 @@ static void decodeGeneric(unsigned char** out, unsigned* w, unsigned* h,
 
   if(!state->error)
   {
-    outsize = lodepng_get_raw_size(*w, *h, &state->info_png.color);
-    *out = (unsigned char*)lodepng_malloc(outsize);
-    if(!*out) state->error = 83; /*alloc fail*/
+    if(target && outsize == targetsize && lodepng_color_mode_equal(&state->info_raw, &state->info_png.color))
+    {
+      *out = target;
+    }
+    else
+    {
+      *out = (unsigned char*)lodepng_malloc(outsize);
+      if(!*out) state->error = 83; /*alloc fail*/
+    }
   }
   if(!state->error)
   {
@@ -4738,7 +4804,7 @@ unsigned lodepng_decode(unsigned char** out, unsigned* w, unsigned* h,
                         const unsigned char* in, size_t insize)
 {
   *out = 0;
-  decodeGeneric(out, w, h, state, in, insize);
+  decodeGeneric(out, 0, 0, 0, w, h, state, in, insize);
   if(state->error) return state->error;
   if(!state->decoder.color_convert || lodepng_color_mode_equal(&state->info_raw, &state->info_png.color))
   {
@@ -4778,6 +4844,31 @@ unsigned lodepng_decode(unsigned char** out, unsigned* w, unsigned* h,
   return state->error;
 }
 
+unsigned lodepng_decode_into(unsigned char* out, size_t outsize, size_t outcapacity, unsigned* w, unsigned* h,
+                             LodePNGState* state,
+                             const unsigned char* in, size_t insize)
+{
+  unsigned char* image = 0;
+
+  state->error = lodepng_inspect(w, h, state, in, insize);
+  if(state->error) return state->error;
+  if(lodepng_get_raw_size(*w, *h, &state->info_raw) != outsize) return state->error = 95;
+
+  decodeGeneric(&image, out, outsize, outcapacity, w, h, state, in, insize);
+  if(!state->error && image != out)
+  {
+    /*the PNG has another color type: the image was decoded into a temporary buffer and is converted now*/
+    if(!(state->info_raw.colortype == LCT_RGB || state->info_raw.colortype == LCT_RGBA)
+       && !(state->info_raw.bitdepth == 8))
+    {
+      state->error = 56; /*unsupported color mode conversion*/
+    }
+    else state->error = lodepng_convert(out, image, &state->info_raw, &state->info_png.color, *w, *h);
+  }
+  if(image != out) lodepng_free(image);
+  return state->error;
+}
+
 unsigned lodepng_decode_memory(unsigned char** out, unsigned* w, unsigned* h, const unsigned char* in,
                                size_t insize, LodePNGColorType colortype, unsigned bitdepth)
 {
@@ -6013,6 +6104,7 @@ const char* lodepng_error_text(unsigned code)
     case 92: return "too many pixels, not supported";
     case 93: return "zero width or height is invalid";
     case 94: return "header chunk must have a size of 13 bytes";
+    case 95: return "output buffer size doesn't match the size of the decoded image";
   }
   return "unknown error code";
 }
@@ -655,6 +655,20 @@ unsigned lodepng_decode(unsigned char** out, unsigned* w, unsigned* h,
                         LodePNGState* state,
                         const unsigned char* in, size_t insize);
 
+/*
+Same as lodepng_decode, but writes the image into a buffer allocated by the caller, which
+must have exactly lodepng_get_raw_size(w, h, &state->info_raw) bytes (use lodepng_inspect
+to get w and h first). When the PNG already has the color type of info_raw the image is
+unfiltered straight into out and no intermediate image buffer is allocated. outcapacity is the
+number of bytes that can be written from out, which may be more than outsize: if it also fits
+the filtered scanlines (outsize plus one filter byte per row) of a non interlaced image of 8 or
+more bits per pixel, the data is inflated into out and unfiltered in place, so no scanline buffer
+is allocated either.
+*/
+unsigned lodepng_decode_into(unsigned char* out, size_t outsize, size_t outcapacity, unsigned* w, unsigned* h,
+                             LodePNGState* state,
+                             const unsigned char* in, size_t insize);
+
 /*
 Read the PNG header, but not the actual data. This returns only the information
 that is in the header chunk of the PNG, such as width, height and color type. The
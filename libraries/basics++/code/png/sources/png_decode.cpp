@@ -11,11 +11,17 @@
  */
 
 #include "lodepng.h"
+#include "png_internal.hpp"
 #include <basics/png_decode>
 
 namespace basics
 {
 
+    // Lado máximo que se acepta en una imagen. Supera el tamaño máximo de textura de cualquier GPU con
+    // OpenGL ES y hace que el tamaño en bytes (width * height * 4) quepa siempre en 32 bits:
+
+    static const unsigned max_image_side = 16384;
+
     bool png_decode
     (
         const std::vector< byte > & encoded_data,
@@ -24,30 +30,103 @@ namespace basics
         unsigned & height
     )
     {
-        std::vector< byte > decoded_data;
-
-        int error = lodepng::decode
-        (
-            decoded_data,
-            width,
-            height,
-            encoded_data,
-            LCT_RGBA,
-            8
-        );
-
-        if (!error)
+        bool opaque;
+
+        return png_decode (encoded_data, color_buffer, width, height, opaque);
+    }
+
+    bool png_decode
+    (
+        const std::vector< byte > & encoded_data,
+        Color_Buffer < Rgba8888 > & color_buffer,
+        unsigned & width,
+        unsigned & height,
+        bool     & opaque
+    )
+    {
+        return png_decode (encoded_data.data (), encoded_data.size (), color_buffer, width, height, opaque);
+    }
+
+    bool png_decode
+    (
+        const byte * data,
+        size_t       size,
+        Color_Buffer < Rgba8888 > & color_buffer,
+        unsigned & width,
+        unsigned & height,
+        bool     & opaque
+    )
+    {
+        lodepng::State state;
+
+        state.info_raw.colortype = LCT_RGBA;
+        state.info_raw.bitdepth  = 8;
+
+        // Primero se lee solo la cabecera para reservar el buffer de color con su tamaño definitivo.
+        // Las dimensiones no se pueden creer sin más (el archivo puede estar dañado), así que antes
+        // de reservar nada se comprueba que estén dentro de los límites:
+
+        if (lodepng_inspect (&width, &height, &state, data, size) == 0 && width <= max_image_side && height <= max_image_side)
         {
-            color_buffer.resize (width, height);
+            // Las líneas filtradas tienen un byte más que las de la imagen. Con ese sitio de más al
+            // final del buffer, lodepng descomprime en él y deshace el filtro sobre los mismos datos,
+            // por lo que no hace falta otro buffer del tamaño de la imagen. Solo se reservan aparte
+            // los datos comprimidos de los chunks IDAT:
+
+            size_t spare = (height + sizeof(Rgba8888) - 1) / sizeof(Rgba8888);
+
+            color_buffer.resize_with_spare (width, height, spare);
 
             byte * buffer = color_buffer;
+            size_t pixels = size_t(width) * height;
+            size_t bytes  = pixels * sizeof(Rgba8888);
+
+            const LodePNGColorMode & color = state.info_png.color;
+
+            // El inflate propio reserva de una vez el tamaño exacto de los datos filtrados (en las
+            // imágenes entrelazadas no se calcula y se deja que el buffer crezca):
+
+            size_t filtered_size = state.info_png.interlace_method == 0
+                                 ? size_t(height) * (1 + (size_t(width) * lodepng_get_bpp (&color) + 7) / 8)
+                                 : 0;
 
-            for (auto i = decoded_data.begin (); i != decoded_data.end (); ++i)
+            state.decoder.zlibsettings.custom_inflate = png_inflate;
+            state.decoder.zlibsettings.custom_context = filtered_size ? &filtered_size : nullptr;
+
+            // Las imágenes de 8 bits por canal que no son RGBA se decodifican en su formato original
+            // al final del buffer y se expanden a RGBA sobre él mismo, evitando así la conversión
+            // genérica de lodepng y su buffer temporal:
+
+            bool   expand       = png_can_expand_to_rgba8 (color);
+            size_t source_bytes = expand ? pixels * lodepng_get_bpp (&color) / 8 : bytes;
+            byte * source       = buffer + bytes - source_bytes;
+
+            if (expand) lodepng_color_mode_copy (&state.info_raw, &color);
+
+            if (lodepng_decode_into (source, source_bytes, source_bytes + spare * sizeof(Rgba8888), &width, &height, &state, data, size) == 0)
             {
-                *buffer++ = *i;
+                color_buffer.trim_spare ();
+
+                if (expand) png_expand_to_rgba8 (buffer, source, color, pixels);
+
+                // Se busca el primer píxel que no sea opaco. En la mayoría de las imágenes con
+                // transparencia aparece pronto, así que el recorrido completo solo lo hacen las opacas:
+
+                opaque = true;
+
+                for (size_t alpha = 3; alpha < bytes; alpha += 4)
+                {
+                    if (buffer[alpha] != 0xFF)
+                    {
+                        opaque = false;
+                        break;
+                    }
+                }
+
+                return true;
             }
 
-            return true;
+            color_buffer.resize (0, 0);
         }
 
         return false;
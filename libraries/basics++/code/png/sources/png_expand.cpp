@@ -0,0 +1,137 @@
+/*
+ * PNG EXPAND
+ * Copyright © 2018+ Ángel Rodríguez Ballesteros
+ *
+ * Distributed under the Boost Software License, version  1.0
+ * See documents/LICENSE.TXT or www.boost.org/LICENSE_1_0.txt
+ *
+ * angel.rodriguez@esne.edu
+ *
+ * C2610171903
+ */
+
+#include "png_internal.hpp"
+
+// lodepng convierte a RGBA píxel a píxel pasando por una función genérica que consulta el formato
+// en cada llamada, y además necesita un buffer intermedio con la imagen en su formato original.
+// Para los formatos de 8 bits por canal la conversión es trivial y se puede hacer aquí, en el mismo
+// buffer de destino.
+
+namespace basics
+{
+
+    bool png_can_expand_to_rgba8 (const LodePNGColorMode & color)
+    {
+        if (color.bitdepth != 8) return false;
+
+        switch (color.colortype)
+        {
+            case LCT_GREY:
+            case LCT_GREY_ALPHA:
+            case LCT_RGB:
+            case LCT_PALETTE:
+            {
+                return true;
+            }
+
+            default: return false;
+        }
+    }
+
+    void png_expand_to_rgba8 (byte * rgba, const byte * source, const LodePNGColorMode & color, size_t pixel_count)
+    {
+        // El origen ocupa el final del buffer y el destino avanza más deprisa que él, pero nunca le
+        // adelanta: cada píxel se lee completo antes de escribirse su versión RGBA.
+
+        byte * end = rgba + pixel_count * 4;
+
+        switch (color.colortype)
+        {
+            case LCT_GREY:
+            {
+                for ( ; rgba < end; rgba += 4)
+                {
+                    byte grey  = *source++;
+                    byte alpha = color.key_defined && grey == color.key_r ? 0 : 255;
+
+                    rgba[0] = rgba[1] = rgba[2] = grey;
+                    rgba[3] = alpha;
+                }
+
+                break;
+            }
+
+            case LCT_GREY_ALPHA:
+            {
+                for ( ; rgba < end; rgba += 4, source += 2)
+                {
+                    byte grey  = source[0];
+                    byte alpha = source[1];
+
+                    rgba[0] = rgba[1] = rgba[2] = grey;
+                    rgba[3] = alpha;
+                }
+
+                break;
+            }
+
+            case LCT_RGB:
+            {
+                if (color.key_defined)
+                {
+                    for ( ; rgba < end; rgba += 4, source += 3)
+                    {
+                        byte r = source[0], g = source[1], b = source[2];
+
+                        rgba[0] = r;
+                        rgba[1] = g;
+                        rgba[2] = b;
+                        rgba[3] = r == color.key_r && g == color.key_g && b == color.key_b ? 0 : 255;
+                    }
+                }
+                else for ( ; rgba < end; rgba += 4, source += 3)
+                {
+                    byte r = source[0], g = source[1], b = source[2];
+
+                    rgba[0] = r;
+                    rgba[1] = g;
+                    rgba[2] = b;
+                    rgba[3] = 255;
+                }
+
+                break;
+            }
+
+            case LCT_PALETTE:
+            {
+                // lodepng guarda la paleta ya en RGBA (con el alfa de tRNS). Los índices fuera de la
+                // paleta dan negro opaco, igual que en lodepng_convert():
+
+                for ( ; rgba < end; rgba += 4)
+                {
+                    unsigned index = *source++;
+
+                    if (index < color.palettesize)
+                    {
+                        const byte * entry = color.palette + index * 4;
+
+                        rgba[0] = entry[0];
+                        rgba[1] = entry[1];
+                        rgba[2] = entry[2];
+                        rgba[3] = entry[3];
+                    }
+                    else
+                    {
+                        rgba[0] = rgba[1] = rgba[2] = 0;
+                        rgba[3] = 255;
+                    }
+                }
+
+                break;
+            }
+
+            default: break;
+        }
+    }
+
+}
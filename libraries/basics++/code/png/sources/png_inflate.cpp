@@ -0,0 +1,524 @@
+/*
+ * PNG INFLATE
+ * Copyright © 2018+ Ángel Rodríguez Ballesteros
+ *
+ * Distributed under the Boost Software License, version  1.0
+ * See documents/LICENSE.TXT or www.boost.org/LICENSE_1_0.txt
+ *
+ * angel.rodriguez@esne.edu
+ *
+ * C2610171901
+ */
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include "png_internal.hpp"
+#include <basics/inflate>
+
+// El inflate de lodepng decodifica cada símbolo bajando por el árbol de Huffman bit a bit. Aquí
+// los códigos de hasta fast_bits bits (casi todos en la práctica) se resuelven con una sola
+// consulta a una tabla indexada por los siguientes bits de la entrada, y los bits se leen de un
+// acumulador de 64 bits que se rellena de 8 bytes en 8 bytes.
+
+namespace basics
+{
+
+    namespace
+    {
+
+        const unsigned fast_bits = 10;
+        const unsigned fast_mask = (1u << fast_bits) - 1;
+
+        const unsigned length_base [29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+        const unsigned length_extra[29] = { 0, 0, 0, 0, 0, 0, 0,  0,  1,  1,  1,  1,  2,  2,  2,  2,  3,  3,  3,  3,  4,  4,  4,   4,   5,   5,   5,   5,   0 };
+
+        const unsigned distance_base [30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+        const unsigned distance_extra[30] = { 0, 0, 0, 0, 1, 1, 2,  2,  3,  3,  4,  4,  5,  5,   6,   6,   7,   7,   8,   8,    9,    9,   10,   10,   11,   11,   12,    12,    13,    13 };
+
+        const unsigned code_length_order[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+        /**
+         * Código de Huffman canónico. Los códigos cortos se resuelven con la tabla fast (cada entrada
+         * guarda (longitud << 9) | símbolo, o 0 si el código es más largo) y el resto comparando el
+         * código leído con el primer código de cada longitud.
+         */
+        struct Huffman_Table
+        {
+            uint16_t fast        [1 << fast_bits];
+            uint16_t first_code  [17];
+            uint16_t first_symbol[17];
+            uint32_t max_code    [18];          ///< Primer código de cada longitud que ya no la tiene (alineado a 16 bits).
+            uint8_t  lengths     [288];         ///< Longitudes en orden canónico.
+            uint16_t symbols     [288];         ///< Símbolos en orden canónico.
+        };
+
+        inline unsigned reverse_bits (unsigned code, unsigned count)
+        {
+            unsigned result = 0;
+
+            for ( ; count; --count, code >>= 1) result = (result << 1) | (code & 1);
+
+            return result;
+        }
+
+        /**
+         * Construye la tabla a partir de las longitudes de los códigos de cada símbolo.
+         * @return false si las longitudes no describen un código válido.
+         */
+        bool build_table (Huffman_Table & table, const uint8_t * lengths, unsigned count)
+        {
+            unsigned length_count[17] = { 0 };
+            unsigned next_code   [17];
+
+            std::memset (table.fast, 0, sizeof(table.fast));
+
+            for (unsigned i = 0; i < count; ++i) length_count[lengths[i]]++;
+
+            length_count[0] = 0;
+
+            unsigned code   = 0;
+            unsigned symbol = 0;
+
+            for (unsigned length = 1; length < 16; ++length)
+            {
+                next_code         [length] = code;
+                table.first_code  [length] = uint16_t(code  );
+                table.first_symbol[length] = uint16_t(symbol);
+
+                code += length_count[length];
+
+                if (length_count[length] && code - 1 >= (1u << length)) return false;
+
+                table.max_code[length] = code << (16 - length);
+
+                code   <<= 1;
+                symbol  += length_count[length];
+            }
+
+            table.max_code[16] = 0x10000;
+
+            for (unsigned i = 0; i < count; ++i)
+            {
+                unsigned length = lengths[i];
+
+                if (length)
+                {
+                    unsigned index = next_code[length] - table.first_code[length] + table.first_symbol[length];
+
+                    table.lengths[index] = uint8_t (length);
+                    table.symbols[index] = uint16_t(i);
+
+                    if (length <= fast_bits)
+                    {
+                        uint16_t entry = uint16_t((length << 9) | i);
+
+                        for (unsigned j = reverse_bits (next_code[length], length); j < (1u << fast_bits); j += 1u << length)
+                        {
+                            table.fast[j] = entry;
+                        }
+                    }
+
+                    next_code[length]++;
+                }
+            }
+
+            return true;
+        }
+
+        /**
+         * Lector de bits LSB primero. Cuando se agota la entrada sigue entregando ceros y cuenta
+         * cuántos bytes se ha inventado para poder detectar después si se llegaron a consumir.
+         */
+        struct Bit_Reader
+        {
+            const byte * data;
+            const byte * end;
+            uint64_t     bits;
+            unsigned     count;
+            size_t       overrun;
+
+            void refill ()
+            {
+                if (end - data >= 8)
+                {
+                    // Se cargan 8 bytes aunque solo quepan los que completan el acumulador. Los bits
+                    // que sobran son los mismos que se volverán a añadir en la siguiente recarga, así
+                    // que el OR no los altera (todas las plataformas soportadas son little endian):
+
+                    uint64_t word;
+
+                    std::memcpy (&word, data, sizeof(word));
+
+                    bits  |= word << count;
+                    data  += (63 - count) >> 3;
+                    count |= 56;
+                }
+                else while (count <= 56)
+                {
+                    if (data < end) bits |= uint64_t(*data++) << count; else overrun++;
+
+                    count += 8;
+                }
+            }
+
+            unsigned take (unsigned bit_count)
+            {
+                if (count < bit_count) refill ();
+
+                unsigned value = unsigned(bits & ((uint64_t(1) << bit_count) - 1));
+
+                bits  >>= bit_count;
+                count  -= bit_count;
+
+                return value;
+            }
+
+            bool overran () const
+            {
+                return overrun * 8 > count;
+            }
+
+            /**
+             * Descarta los bits hasta el siguiente byte y devuelve al flujo los bytes completos que
+             * quedaban en el acumulador, para poder leer un bloque sin comprimir directamente.
+             */
+            bool align_to_byte ()
+            {
+                unsigned buffered = count >> 3;
+
+                if (buffered < overrun) return false;
+
+                data   -= buffered - overrun;
+                bits    = 0;
+                count   = 0;
+                overrun = 0;
+
+                return true;
+            }
+        };
+
+        /**
+         * @return el símbolo decodificado o -1 si los bits no corresponden a ningún código.
+         */
+        inline int decode_symbol (Bit_Reader & reader, const Huffman_Table & table)
+        {
+            if (reader.count < 16) reader.refill ();
+
+            unsigned entry = table.fast[reader.bits & fast_mask];
+
+            if (entry)
+            {
+                unsigned length = entry >> 9;
+
+                reader.bits  >>= length;
+                reader.count  -= length;
+
+                return int(entry & 511);
+            }
+
+            unsigned code = reverse_bits (unsigned(reader.bits & 0xFFFF), 16);
+            unsigned length;
+
+            for (length = fast_bits + 1; length < 16 && code >= table.max_code[length]; ++length);
+
+            if (length >= 16) return -1;
+
+            unsigned index = (code >> (16 - length)) - table.first_code[length] + table.first_symbol[length];
+
+            if (index >= 288 || table.lengths[index] != length) return -1;
+
+            reader.bits  >>= length;
+            reader.count  -= length;
+
+            return table.symbols[index];
+        }
+
+        /**
+         * Buffer de salida compatible con el de lodepng (se libera con free()).
+         */
+        struct Output
+        {
+            byte   * data;
+            size_t   size;
+            size_t   capacity;
+            size_t   limit;                     ///< Tamaño que no puede superar (capacity si el buffer no es de lodepng).
+
+            bool reserve (size_t required)
+            {
+                if (required <= capacity) return true;
+
+                if (required > limit) return false;
+
+                size_t new_capacity = capacity * 2 > required ? capacity * 2 : required;
+
+                if (new_capacity > limit) new_capacity = limit;
+                byte * new_data     = static_cast< byte * >(std::realloc (data, new_capacity));
+
+                if (!new_data) return false;
+
+                data     = new_data;
+                capacity = new_capacity;
+
+                return true;
+            }
+        };
+
+        unsigned read_dynamic_tables (Bit_Reader & reader, Huffman_Table & literals, Huffman_Table & distances)
+        {
+            unsigned literal_count  = reader.take (5) + 257;
+            unsigned distance_count = reader.take (5) + 1;
+            unsigned code_count     = reader.take (4) + 4;
+
+            if (literal_count > 286 || distance_count > 30) return 50;
+
+            uint8_t code_lengths[19] = { 0 };
+
+            for (unsigned i = 0; i < code_count; ++i)
+            {
+                code_lengths[code_length_order[i]] = uint8_t(reader.take (3));
+            }
+
+            Huffman_Table code_table;
+
+            if (!build_table (code_table, code_lengths, 19)) return 16;
+
+            uint8_t  lengths[286 + 30];
+            unsigned total = literal_count + distance_count;
+
+            for (unsigned i = 0; i < total; )
+            {
+                int symbol = decode_symbol (reader, code_table);
+
+                if (symbol < 0) return 16;
+
+                if (symbol < 16)
+                {
+                    lengths[i++] = uint8_t(symbol);
+                }
+                else
+                {
+                    unsigned repeat;
+                    uint8_t  value = 0;
+
+                    if (symbol == 16)
+                    {
+                        if (i == 0) return 54;
+
+                        value  = lengths[i - 1];
+                        repeat = reader.take (2) + 3;
+                    }
+                    else if (symbol == 17) repeat = reader.take ( 3) +  3;
+                    else                   repeat = reader.take ( 7) + 11;
+
+                    if (i + repeat > total) return 13;
+
+                    std::memset (lengths + i, value, repeat);
+
+                    i += repeat;
+                }
+            }
+
+            if (reader.overran ()) return 50;
+
+            if (lengths[256] == 0) return 64;
+
+            if (!build_table (literals,  lengths,                 literal_count )) return 55;
+            if (!build_table (distances, lengths + literal_count, distance_count)) return 56;
+
+            return 0;
+        }
+
+        void build_fixed_tables (Huffman_Table & literals, Huffman_Table & distances)
+        {
+            uint8_t lengths[288];
+
+            std::memset (lengths +   0, 8, 144);
+            std::memset (lengths + 144, 9, 112);
+            std::memset (lengths + 256, 7,  24);
+            std::memset (lengths + 280, 8,   8);
+
+            build_table (literals, lengths, 288);
+
+            std::memset (lengths, 5, 32);
+
+            build_table (distances, lengths, 32);
+        }
+
+        unsigned inflate_huffman_block (Bit_Reader & reader, Output & output, const Huffman_Table & literals, const Huffman_Table & distances)
+        {
+            for (;;)
+            {
+                int symbol = decode_symbol (reader, literals);
+
+                // Con la entrada truncada el lector entrega ceros, que también forman códigos
+                // válidos, así que hay que parar en cuanto se consume un bit inventado:
+
+                if (reader.overran ()) return 51;
+
+                if (symbol < 256)
+                {
+                    if (symbol < 0) return 11;
+
+                    if (output.size == output.capacity && !output.reserve (output.size + 1)) return 83;
+
+                    output.data[output.size++] = byte(symbol);
+                }
+                else if (symbol == 256)
+                {
+                    return 0;
+                }
+                else
+                {
+                    symbol -= 257;
+
+                    if (symbol >= 29) return 18;
+
+                    size_t length = length_base[symbol] + reader.take (length_extra[symbol]);
+
+                    int distance_symbol = decode_symbol (reader, distances);
+
+                    if (distance_symbol < 0 || distance_symbol >= 30) return 18;
+
+                    size_t distance = distance_base[distance_symbol] + reader.take (distance_extra[distance_symbol]);
+
+                    if (distance > output.size) return 52;
+
+                    if (!output.reserve (output.size + length)) return 83;
+
+                    byte       * target = output.data + output.size;
+                    const byte * source = target - distance;
+
+                    if (distance >= length)
+                    {
+                        std::memcpy (target, source, length);
+                    }
+                    else if (distance == 1)
+                    {
+                        std::memset (target, *source, length);
+                    }
+                    else
+                    {
+                        for (size_t i = 0; i < length; ++i) target[i] = source[i];
+                    }
+
+                    output.size += length;
+                }
+            }
+        }
+
+        unsigned inflate_stored_block (Bit_Reader & reader, Output & output)
+        {
+            reader.take (reader.count & 7);
+
+            if (!reader.align_to_byte ()) return 52;
+
+            if (reader.end - reader.data < 4) return 52;
+
+            const byte * header = reader.data;
+            unsigned     length = header[0] | (header[1] << 8);
+            unsigned     check  = header[2] | (header[3] << 8);
+
+            if (length + check != 65535) return 21;
+
+            reader.data += 4;
+
+            if (size_t(reader.end - reader.data) < length) return 23;
+
+            if (!output.reserve (output.size + length)) return 83;
+
+            std::memcpy (output.data + output.size, reader.data, length);
+
+            output.size += length;
+            reader.data += length;
+
+            return 0;
+        }
+
+        unsigned inflate_blocks (Bit_Reader & reader, Output & output)
+        {
+            Huffman_Table literals;
+            Huffman_Table distances;
+            unsigned      error = 0;
+
+            for (bool final_block = false; !error && !final_block; )
+            {
+                final_block = reader.take (1) != 0;
+
+                switch (reader.take (2))
+                {
+                    case 0:  error = inflate_stored_block (reader, output); break;
+                    case 1:
+                    {
+                        build_fixed_tables (literals, distances);
+
+                        error = inflate_huffman_block (reader, output, literals, distances);
+                        break;
+                    }
+                    case 2:
+                    {
+                        error = read_dynamic_tables (reader, literals, distances);
+
+                        if (!error) error = inflate_huffman_block (reader, output, literals, distances);
+                        break;
+                    }
+                    default: error = 20;
+                }
+            }
+
+            return error;
+        }
+
+    }
+
+    unsigned png_inflate
+    (
+        unsigned char ** out,
+        size_t         * out_size,
+        const unsigned char * in,
+        size_t           in_size,
+        const LodePNGDecompressSettings * settings
+    )
+    {
+        // El buffer que llega de lodepng puede tener ya datos; se conserva y se añade a continuación.
+        // Si se conoce el tamaño de los datos descomprimidos no se permite superarlo y, si no, se
+        // limita a la máxima proporción de deflate (algo menos de 1032 a 1), de modo que una
+        // entrada corrupta no puede hacer crecer el buffer sin medida:
+
+        const size_t * known_size = static_cast< const size_t * >(settings->custom_context);
+
+        size_t expected_size = known_size ? *known_size : in_size * 4;
+        size_t maximum_size  = known_size ? *known_size : in_size < (SIZE_MAX - 1024) / 1032 ? in_size * 1032 + 1024 : SIZE_MAX;
+
+        Output output = { *out, *out_size, *out_size, maximum_size < SIZE_MAX - *out_size ? *out_size + maximum_size : SIZE_MAX };
+
+        unsigned error = output.reserve (output.size + expected_size) ? 0 : 83;
+
+        Bit_Reader reader = { in, in + in_size, 0, 0, 0 };
+
+        if (!error) error = inflate_blocks (reader, output);
+
+        *out      = output.data;
+        *out_size = output.size;
+
+        return error;
+    }
+
+    unsigned png_inflate_into (byte * target, size_t target_size, const unsigned char * in, size_t in_size)
+    {
+        Output     output = { target, 0, target_size, target_size };
+        Bit_Reader reader = { in, in + in_size, 0, 0, 0 };
+
+        unsigned error = inflate_blocks (reader, output);
+
+        // Si faltan datos la imagen está corrupta (el mismo error que da lodepng en ese caso):
+
+        return error ? error : output.size == target_size ? 0 : 91;
+    }
+
+    bool inflate (const byte * source, size_t source_size, byte * target, size_t target_size)
+    {
+        return png_inflate_into (target, target_size, source, source_size) == 0;
+    }
+
+}
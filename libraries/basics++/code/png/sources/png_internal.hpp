@@ -0,0 +1,79 @@
+/*
+ * PNG INTERNAL
+ * Copyright © 2018+ Ángel Rodríguez Ballesteros
+ *
+ * Distributed under the Boost Software License, version  1.0
+ * See documents/LICENSE.TXT or www.boost.org/LICENSE_1_0.txt
+ *
+ * angel.rodriguez@esne.edu
+ *
+ * C2610171900
+ */
+
+#ifndef BASICS_PNG_INTERNAL_HEADER
+#define BASICS_PNG_INTERNAL_HEADER
+
+    #include <cstddef>
+    #include <basics/types>
+    #include "lodepng.h"
+
+    // Rutinas rápidas que sustituyen a las partes más lentas de lodepng al decodificar. Son privadas
+    // del módulo: png_decode() y lodepng.cpp son los únicos que las usan.
+
+    namespace basics
+    {
+
+        /**
+         * Descompresor deflate basado en tablas de búsqueda. Tiene la firma de custom_inflate de
+         * LodePNGDecompressSettings. Si custom_context apunta a un size_t con el tamaño esperado de
+         * los datos descomprimidos el buffer de salida se reserva una sola vez con ese tamaño.
+         * Devuelve 0 o uno de los códigos de error de lodepng.
+         */
+        unsigned png_inflate
+        (
+            unsigned char ** out,
+            size_t         * out_size,
+            const unsigned char * in,
+            size_t           in_size,
+            const LodePNGDecompressSettings * settings
+        );
+
+        /**
+         * Descomprime un flujo deflate en un buffer de tamaño fijo que los datos tienen que llenar
+         * exactamente. Devuelve 0 o uno de los códigos de error de lodepng.
+         */
+        unsigned png_inflate_into (byte * target, size_t target_size, const unsigned char * in, size_t in_size);
+
+        /**
+         * Deshace el filtro de una línea usando SSE2 o NEON cuando están disponibles. Se ocupa del
+         * filtro Up con cualquier tamaño de píxel y de Sub, Average y Paeth con píxeles de 3 y 4
+         * bytes. recon y scanline pueden ser la misma dirección o recon puede ir por detrás de
+         * scanline en el mismo buffer (al deshacer el filtro de una imagen sobre sí misma).
+         * @return false si el caso no está acelerado y lo debe resolver el código genérico.
+         */
+        bool png_unfilter_scanline
+        (
+            byte       * recon,
+            const byte * scanline,
+            const byte * precon,
+            size_t       bytewidth,
+            unsigned     filter_type,
+            size_t       length
+        );
+
+        /**
+         * Indica si png_expand_to_rgba8() sabe convertir el formato de color dado (8 bits por canal
+         * en gris, gris con alfa, RGB o paleta).
+         */
+        bool png_can_expand_to_rgba8 (const LodePNGColorMode & color);
+
+        /**
+         * Convierte pixel_count píxeles del formato de color de la imagen a RGBA8. El origen puede
+         * estar al final del mismo buffer de destino, de modo que la conversión se hace sin buffers
+         * intermedios (cada píxel se lee antes de que la escritura lo alcance).
+         */
+        void png_expand_to_rgba8 (byte * rgba, const byte * source, const LodePNGColorMode & color, size_t pixel_count);
+
+    }
+
+#endif
@@ -0,0 +1,273 @@
+/*
+ * PNG UNFILTER
+ * Copyright © 2018+ Ángel Rodríguez Ballesteros
+ *
+ * Distributed under the Boost Software License, version  1.0
+ * See documents/LICENSE.TXT or www.boost.org/LICENSE_1_0.txt
+ *
+ * angel.rodriguez@esne.edu
+ *
+ * C2610171902
+ */
+
+#include <cstdint>
+#include <cstring>
+#include "png_internal.hpp"
+
+#if defined(__SSE2__)
+    #include <emmintrin.h>
+#elif defined(__ARM_NEON)
+    #include <arm_neon.h>
+#endif
+
+// Los filtros Sub, Average y Paeth dependen del píxel de la izquierda ya reconstruido, así que no
+// se pueden vectorizar a lo largo de la línea. Lo que sí se puede es tratar todos los canales de un
+// píxel a la vez en un registro, que es lo que hacen estas rutinas con los píxeles de 3 y 4 bytes
+// (RGB y RGBA, los formatos de casi todas las texturas). El filtro Up no tiene esa dependencia y se
+// procesa de 16 en 16 bytes.
+
+namespace basics
+{
+
+    namespace
+    {
+
+        inline uint32_t load_pixel (const byte * pixel, size_t bytewidth)
+        {
+            uint32_t value = 0;
+
+            std::memcpy (&value, pixel, bytewidth);
+
+            return value;
+        }
+
+        inline void store_pixel (byte * pixel, uint32_t value, size_t bytewidth)
+        {
+            std::memcpy (pixel, &value, bytewidth);
+        }
+
+        void unfilter_up (byte * recon, const byte * scanline, const byte * precon, size_t length)
+        {
+            size_t i = 0;
+
+            #if defined(__SSE2__)
+
+                for ( ; i + 16 <= length; i += 16)
+                {
+                    __m128i x = _mm_loadu_si128 (reinterpret_cast< const __m128i * >(scanline + i));
+                    __m128i b = _mm_loadu_si128 (reinterpret_cast< const __m128i * >(precon   + i));
+
+                    _mm_storeu_si128 (reinterpret_cast< __m128i * >(recon + i), _mm_add_epi8 (x, b));
+                }
+
+            #elif defined(__ARM_NEON)
+
+                for ( ; i + 16 <= length; i += 16)
+                {
+                    vst1q_u8 (recon + i, vaddq_u8 (vld1q_u8 (scanline + i), vld1q_u8 (precon + i)));
+                }
+
+            #endif
+
+            for ( ; i < length; ++i) recon[i] = byte(scanline[i] + precon[i]);
+        }
+
+        #if defined(__SSE2__)
+
+            inline __m128i load (const byte * pixel, size_t bytewidth)
+            {
+                return _mm_cvtsi32_si128 (int(load_pixel (pixel, bytewidth)));
+            }
+
+            inline void store (byte * pixel, __m128i value, size_t bytewidth)
+            {
+                store_pixel (pixel, uint32_t(_mm_cvtsi128_si32 (value)), bytewidth);
+            }
+
+            void unfilter_sub (byte * recon, const byte * scanline, size_t bytewidth, size_t length)
+            {
+                __m128i a = _mm_setzero_si128 ();
+
+                for (size_t i = 0; i < length; i += bytewidth)
+                {
+                    a = _mm_add_epi8 (a, load (scanline + i, bytewidth));
+
+                    store (recon + i, a, bytewidth);
+                }
+            }
+
+            void unfilter_average (byte * recon, const byte * scanline, const byte * precon, size_t bytewidth, size_t length)
+            {
+                const __m128i one = _mm_set1_epi8 (1);
+                      __m128i a   = _mm_setzero_si128 ();
+
+                for (size_t i = 0; i < length; i += bytewidth)
+                {
+                    __m128i b = load (precon + i, bytewidth);
+
+                    // _mm_avg_epu8() redondea hacia arriba y el filtro trunca: se resta el bit que se
+                    // pierde cuando a + b es impar:
+
+                    __m128i average = _mm_sub_epi8 (_mm_avg_epu8 (a, b), _mm_and_si128 (_mm_xor_si128 (a, b), one));
+
+                    a = _mm_add_epi8 (load (scanline + i, bytewidth), average);
+
+                    store (recon + i, a, bytewidth);
+                }
+            }
+
+            inline __m128i absolute (__m128i value)
+            {
+                return _mm_max_epi16 (value, _mm_sub_epi16 (_mm_setzero_si128 (), value));
+            }
+
+            inline __m128i select (__m128i mask, __m128i if_true, __m128i if_false)
+            {
+                return _mm_or_si128 (_mm_and_si128 (mask, if_true), _mm_andnot_si128 (mask, if_false));
+            }
+
+            void unfilter_paeth (byte * recon, const byte * scanline, const byte * precon, size_t bytewidth, size_t length)
+            {
+                const __m128i zero = _mm_setzero_si128 ();
+                      __m128i a    = zero;          // Píxel de la izquierda (ampliado a 16 bits).
+                      __m128i c    = zero;          // Píxel de arriba a la izquierda (ampliado a 16 bits).
+
+                for (size_t i = 0; i < length; i += bytewidth)
+                {
+                    __m128i b  = _mm_unpacklo_epi8 (load (precon + i, bytewidth), zero);
+
+                    __m128i pa = _mm_sub_epi16 (b, c);              // p - a = b - c
+                    __m128i pb = _mm_sub_epi16 (a, c);              // p - b = a - c
+                    __m128i pc = absolute (_mm_add_epi16 (pa, pb)); // |p - c| = |a + b - 2c|
+
+                    pa = absolute (pa);
+                    pb = absolute (pb);
+
+                    // Se elige a si su distancia es la menor, si no b si lo es la suya, y si no c:
+
+                    __m128i smallest = _mm_min_epi16 (pc, _mm_min_epi16 (pa, pb));
+                    __m128i nearest  = select (_mm_cmpeq_epi16 (pa, smallest), a, select (_mm_cmpeq_epi16 (pb, smallest), b, c));
+
+                    __m128i x = _mm_add_epi8 (load (scanline + i, bytewidth), _mm_packus_epi16 (nearest, nearest));
+
+                    store (recon + i, x, bytewidth);
+
+                    a = _mm_unpacklo_epi8 (x, zero);
+                    c = b;
+                }
+            }
+
+        #elif defined(__ARM_NEON)
+
+            inline uint8x8_t load (const byte * pixel, size_t bytewidth)
+            {
+                return vreinterpret_u8_u32 (vdup_n_u32 (load_pixel (pixel, bytewidth)));
+            }
+
+            inline void store (byte * pixel, uint8x8_t value, size_t bytewidth)
+            {
+                store_pixel (pixel, vget_lane_u32 (vreinterpret_u32_u8 (value), 0), bytewidth);
+            }
+
+            void unfilter_sub (byte * recon, const byte * scanline, size_t bytewidth, size_t length)
+            {
+                uint8x8_t a = vdup_n_u8 (0);
+
+                for (size_t i = 0; i < length; i += bytewidth)
+                {
+                    a = vadd_u8 (a, load (scanline + i, bytewidth));
+
+                    store (recon + i, a, bytewidth);
+                }
+            }
+
+            void unfilter_average (byte * recon, const byte * scanline, const byte * precon, size_t bytewidth, size_t length)
+            {
+                uint8x8_t a = vdup_n_u8 (0);
+
+                for (size_t i = 0; i < length; i += bytewidth)
+                {
+                    a = vadd_u8 (load (scanline + i, bytewidth), vhadd_u8 (a, load (precon + i, bytewidth)));
+
+                    store (recon + i, a, bytewidth);
+                }
+            }
+
+            void unfilter_paeth (byte * recon, const byte * scanline, const byte * precon, size_t bytewidth, size_t length)
+            {
+                uint8x8_t a = vdup_n_u8 (0);
+                uint8x8_t c = vdup_n_u8 (0);
+
+                for (size_t i = 0; i < length; i += bytewidth)
+                {
+                    uint8x8_t  b  = load (precon + i, bytewidth);
+
+                    uint16x8_t pa = vabdl_u8  (b, c);                                   // |b - c|
+                    uint16x8_t pb = vabdl_u8  (a, c);                                   // |a - c|
+                    uint16x8_t pc = vabdq_u16 (vaddl_u8 (a, b), vaddl_u8 (c, c));       // |a + b - 2c|
+
+                    // Se elige a si su distancia es la menor, si no b si lo es la suya, y si no c:
+
+                    uint8x8_t  choose_a = vmovn_u16 (vandq_u16 (vcleq_u16 (pa, pb), vcleq_u16 (pa, pc)));
+                    uint8x8_t  choose_b = vmovn_u16 (vcleq_u16 (pb, pc));
+                    uint8x8_t  nearest  = vbsl_u8   (choose_a, a, vbsl_u8 (choose_b, b, c));
+
+                    a = vadd_u8 (load (scanline + i, bytewidth), nearest);
+                    c = b;
+
+                    store (recon + i, a, bytewidth);
+                }
+            }
+
+        #endif
+
+    }
+
+    bool png_unfilter_scanline
+    (
+        byte       * recon,
+        const byte * scanline,
+        const byte * precon,
+        size_t       bytewidth,
+        unsigned     filter_type,
+        size_t       length
+    )
+    {
+        #if defined(__SSE2__) || defined(__ARM_NEON)
+
+            if ((bytewidth == 3 || bytewidth == 4) && filter_type == 1)
+            {
+                unfilter_sub (recon, scanline, bytewidth, length);
+                return true;
+            }
+
+        #endif
+
+        // En la primera línea (sin precon) el resto de filtros se dejan al código genérico, que la
+        // trata como si la anterior fuese de ceros:
+
+        if (!precon) return false;
+
+        if (filter_type == 2)
+        {
+            unfilter_up (recon, scanline, precon, length);
+            return true;
+        }
+
+        #if defined(__SSE2__) || defined(__ARM_NEON)
+
+            if (bytewidth == 3 || bytewidth == 4)
+            {
+                switch (filter_type)
+                {
+                    case 3: unfilter_average (recon, scanline, precon, bytewidth, length); return true;
+                    case 4: unfilter_paeth   (recon, scanline, precon, bytewidth, length); return true;
+                }
+            }
+
+        #endif
+
+        return false;
+    }
+
+}
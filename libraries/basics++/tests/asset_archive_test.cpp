@@ -0,0 +1,351 @@
+/*
+ * ASSET ARCHIVE TEST
+ * Copyright © 2018+ Ángel Rodríguez Ballesteros
+ *
+ * Distributed under the Boost Software License, version  1.0
+ * See documents/LICENSE.TXT or www.boost.org/LICENSE_1_0.txt
+ *
+ * angel.rodriguez@esne.edu
+ *
+ * C2610172355
+ */
+
+// Comprueba que Asset_Archive lee bien un archivo construido a mano y que al montarlo rechaza los
+// índices corruptos: cada prefijo del archivo, los campos del índice fuera de rango y el archivo
+// con cada uno de sus bytes alterado. Un archivo alterado que aún parece válido debe poder leerse
+// sin salirse de la proyección (lo que conviene comprobar también compilando con -fsanitize=address).
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include <basics/Asset_Archive>
+#include <basics/fnv>
+#include "check.hpp"
+
+using namespace basics;
+
+namespace
+{
+
+    std::string archive_path;
+
+    struct Test_Entry
+    {
+        std::string          path;
+        Asset_Archive::Codec codec;
+        uint32_t             size;              ///< Tamaño sin comprimir.
+        std::vector< byte >  data;              ///< Tal cual se guarda (con la tabla de bloques si está comprimida).
+    };
+
+    void put_uint32 (std::vector< byte > & file, size_t offset, uint32_t value)
+    {
+        std::memcpy (&file[offset], &value, sizeof(value));
+    }
+
+    uint32_t get_uint32 (const std::vector< byte > & file, size_t offset)
+    {
+        uint32_t value;
+
+        std::memcpy (&value, &file[offset], sizeof(value));
+
+        return value;
+    }
+
+    /**
+     * Construye el archivo con el formato descrito en Asset_Archive. Los datos de la última entrada
+     * acaban justo al final del archivo, así que cualquier prefijo queda truncado.
+     */
+    std::vector< byte > build_archive (std::vector< Test_Entry > entries)
+    {
+        std::sort
+        (
+            entries.begin (),
+            entries.end   (),
+            [] (const Test_Entry & a, const Test_Entry & b) { return fnv32 (a.path) < fnv32 (b.path); }
+        );
+
+        size_t names_offset = sizeof(Asset_Archive::Header) + entries.size () * sizeof(Asset_Archive::Entry);
+
+        std::vector< byte > file(names_offset);
+        std::vector< size_t > name_offsets;
+
+        for (const Test_Entry & entry : entries)
+        {
+            name_offsets.push_back (file.size ());
+            file.insert (file.end (), entry.path.begin (), entry.path.end ());
+            file.push_back (0);
+        }
+
+        Asset_Archive::Header header = { Asset_Archive::magic, Asset_Archive::version, uint32_t(entries.size ()), uint32_t(names_offset) };
+
+        std::memcpy (file.data (), &header, sizeof(header));
+
+        for (size_t index = 0; index < entries.size (); ++index)
+        {
+            file.resize ((file.size () + Asset_Archive::alignment - 1) / Asset_Archive::alignment * Asset_Archive::alignment);
+
+            const Test_Entry     & entry  = entries[index];
+            Asset_Archive::Entry   record =
+            {
+                fnv32 (entry.path),
+                uint32_t(name_offsets[index]),
+                uint32_t(file.size ()),
+                entry.size,
+                uint32_t(entry.data.size ()),
+                uint32_t(entry.codec)
+            };
+
+            std::memcpy (&file[sizeof(header) + index * sizeof(record)], &record, sizeof(record));
+
+            file.insert (file.end (), entry.data.begin (), entry.data.end ());
+        }
+
+        return file;
+    }
+
+    /**
+     * Entrada LZ4 de un solo bloque con 16 'a': un literal, una copia de 10 bytes a distancia 1 y
+     * los 5 literales con los que debe acabar un bloque.
+     */
+    Test_Entry lz4_entry (const std::string & path)
+    {
+        std::vector< byte > data = { 10, 0, 0, 0, 0x16, 'a', 1, 0, 0x50, 'a', 'a', 'a', 'a', 'a' };
+
+        return Test_Entry{ path, Asset_Archive::LZ4, 16, data };
+    }
+
+    Test_Entry stored_entry (const std::string & path, const std::string & contents)
+    {
+        return Test_Entry{ path, Asset_Archive::STORED, uint32_t(contents.size ()), std::vector< byte >(contents.begin (), contents.end ()) };
+    }
+
+    /**
+     * Entrada LZ4 de dos bloques que se guardan tal cual porque no se pueden comprimir.
+     */
+    Test_Entry two_block_entry (const std::string & path)
+    {
+        uint32_t            size = uint32_t(Asset_Archive::block_size + 100);
+        std::vector< byte > data(8);
+
+        put_uint32 (data, 0, uint32_t(Asset_Archive::block_size));
+        put_uint32 (data, 4, size);
+
+        for (uint32_t index = 0; index < size; ++index) data.push_back (byte(index * 7 + index / 251));
+
+        return Test_Entry{ path, Asset_Archive::LZ4, size, data };
+    }
+
+    std::vector< byte > small_archive ()
+    {
+        return build_archive
+        ({
+            stored_entry ("game-scene/milk.txt", "hello archive"),
+            lz4_entry    ("game-scene/a.bin"),
+            stored_entry ("intro.txt", "intro"),
+        });
+    }
+
+    bool mount (const std::vector< byte > & file)
+    {
+        Asset_Archive::unmount_all ();
+
+        FILE * stream = std::fopen (archive_path.c_str (), "wb");
+
+        if (!stream) return false;
+
+        bool written = std::fwrite (file.data (), 1, file.size (), stream) == file.size ();
+
+        std::fclose (stream);
+
+        return written && Asset_Archive::mount (archive_path);
+    }
+
+    bool read_asset (const std::string & path, std::vector< byte > & contents)
+    {
+        std::shared_ptr< Asset > asset = Asset_Archive::open (path);
+
+        return asset && asset->read_all (contents);
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    void check_valid_archive ()
+    {
+        std::vector< byte > file = build_archive
+        ({
+            stored_entry    ("game-scene/milk.txt", "hello archive"),
+            lz4_entry       ("game-scene/a.bin"),
+            two_block_entry ("big.bin"),
+        });
+
+        CHECK(mount (file));
+
+        std::vector< byte > contents;
+
+        CHECK(read_asset ("game-scene/milk.txt", contents) && std::string(contents.begin (), contents.end ()) == "hello archive");
+        CHECK(read_asset ("game-scene/a.bin", contents) && contents == std::vector< byte >(16, 'a'));
+        CHECK(Asset_Archive::size ("big.bin") == Asset_Archive::block_size + 100);
+        CHECK(!Asset_Archive::exists ("missing.txt"));
+
+        // Una lectura parcial que cruza el final del primer bloque:
+
+        std::shared_ptr< Asset > asset = Asset_Archive::open ("big.bin");
+        byte                     bytes[20];
+        bool                     same  = true;
+
+        CHECK(asset && asset->seek (Asset_Archive::block_size - 10, Asset::BEGINNING) && asset->read (bytes, 20) == 20);
+
+        for (size_t index = 0, position = Asset_Archive::block_size - 10; index < 20; ++index, ++position)
+        {
+            same &= bytes[index] == byte(position * 7 + position / 251);
+        }
+
+        CHECK(same);
+
+        asset.reset ();
+
+        Asset_Archive::unmount_all ();
+    }
+
+    void check_truncated_archives ()
+    {
+        std::vector< byte > file     = small_archive ();
+        unsigned            accepted = 0;
+
+        for (size_t length = 0; length < file.size (); ++length)
+        {
+            accepted += mount (std::vector< byte >(file.begin (), file.begin () + length));
+        }
+
+        CHECK(accepted == 0);
+        CHECK(mount (file));
+
+        Asset_Archive::unmount_all ();
+    }
+
+    void check_corrupt_indices ()
+    {
+        const std::vector< byte > file = small_archive ();
+
+        const size_t header_size = sizeof(Asset_Archive::Header);
+        const size_t entry_size  = sizeof(Asset_Archive::Entry);
+
+        // Desplazamientos de los campos dentro de Header y de Entry:
+
+        const size_t magic = 0, version = 4, entry_count = 8, names_offset = 12;
+        const size_t name_offset = 4, offset = 8, size = 12, stored_size = 16, codec = 20;
+
+        // Primera entrada guardada tal cual y la comprimida:
+
+        size_t stored = 0, compressed = 0;
+
+        for (size_t index = 0; index < 3; ++index)
+        {
+            size_t entry = header_size + index * entry_size;
+
+            if (get_uint32 (file, entry + codec) == Asset_Archive::LZ4) compressed = entry; else if (!stored) stored = entry;
+        }
+
+        struct Corruption
+        {
+            const char * description;
+            size_t       offset;
+            uint32_t     value;
+        };
+
+        const Corruption corruptions[] =
+        {
+            { "magic",                        magic,                      0x12345678                                },
+            { "version",                      version,                    Asset_Archive::version + 1                },
+            { "entry count past the end",     entry_count,                0xFFFFFFFF                                },
+            { "names past the end",           names_offset,               uint32_t(file.size () + 1)                },
+            { "name inside the index",        stored + name_offset,       uint32_t(header_size)                     },
+            { "name without terminator",      stored + name_offset,       uint32_t(file.size () - 1)                },
+            { "misaligned data",              stored + offset,            get_uint32 (file, stored + offset) + 1    },
+            { "data past the end",            stored + offset,            uint32_t(file.size () + 16) & ~15u        },
+            { "stored size past the end",     stored + stored_size,       0xFFFFFFF0                                },
+            { "stored size mismatch",         stored + size,              get_uint32 (file, stored + size) + 1      },
+            { "unknown codec",                stored + codec,             7                                         },
+            { "block table past the data",    compressed + size,          uint32_t(Asset_Archive::block_size * 8)   },
+            { "unsorted hashes",              header_size + 2 * entry_size, 0                                       },
+        };
+
+        for (const Corruption & corruption : corruptions)
+        {
+            std::vector< byte > corrupt = file;
+
+            put_uint32 (corrupt, corruption.offset, corruption.value);
+
+            if (!CHECK(!mount (corrupt))) std::fprintf (stderr, "accepted: %s\n", corruption.description);
+        }
+
+        // Bloques comprimidos que acaban fuera de los datos o que ocupan más que sin comprimir:
+
+        std::vector< byte > corrupt = file;
+        uint32_t            table   = get_uint32 (file, compressed + offset);
+
+        put_uint32 (corrupt, table, 11);
+
+        CHECK(!mount (corrupt));
+
+        put_uint32 (corrupt, table, 17);
+
+        CHECK(!mount (corrupt));
+
+        Asset_Archive::unmount_all ();
+    }
+
+    void check_altered_bytes ()
+    {
+        // Se altera cada byte. Si el archivo se sigue aceptando, sus assets deben poder leerse sin
+        // salirse de la proyección (los datos leídos pueden estar mal):
+
+        const std::vector< byte > file    = small_archive ();
+        const char              * paths[] = { "game-scene/milk.txt", "game-scene/a.bin", "intro.txt" };
+
+        for (size_t index = 0; index < file.size (); ++index)
+        {
+            std::vector< byte > altered = file;
+
+            altered[index] ^= 0xFF;
+
+            if (mount (altered))
+            {
+                for (const char * path : paths)
+                {
+                    std::vector< byte > contents;
+
+                    read_asset (path, contents);
+                }
+            }
+        }
+
+        Asset_Archive::unmount_all ();
+    }
+
+}
+
+int main ()
+{
+    char path[] = "/tmp/asset_archive_test_XXXXXX";
+    int  file   = mkstemp (path);
+
+    if (file < 0) return 1;
+
+    close (file);
+
+    archive_path = path;
+
+    check_valid_archive      ();
+    check_truncated_archives ();
+    check_corrupt_indices    ();
+    check_altered_bytes      ();
+
+    std::remove (path);
+
+    return tests::report ();
+}
@@ -0,0 +1,288 @@
+/*
+ * ATLAS PACKER TEST
+ * Copyright © 2018+ Ángel Rodríguez Ballesteros
+ *
+ * Distributed under the Boost Software License, version  1.0
+ * See documents/LICENSE.TXT or www.boost.org/LICENSE_1_0.txt
+ *
+ * angel.rodriguez@esne.edu
+ *
+ * C2610172350
+ */
+
+// Comprueba cómo coloca Atlas_Packer las imágenes: que no se solapan (contando el margen), que no
+// se salen de sus páginas, que las páginas tienen lados potencia de 2 sin pasar del máximo y que
+// los píxeles y los márgenes se copian bien. Las páginas se crean en un contexto sin gráficos cuyas
+// texturas se quedan con los píxeles para poder mirarlos.
+
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <basics/Atlas_Packer>
+#include <basics/Window>
+#include "check.hpp"
+
+using namespace basics;
+
+namespace
+{
+
+    class Test_Texture final : public Texture_2D
+    {
+    public:
+
+        Color_Buffer< Rgba8888 > pixels;
+
+        Test_Texture(Color_Buffer< Rgba8888 > && pixels)
+        :
+            Texture_2D(ID(test), pixels.get_width (), pixels.get_height ()),
+            pixels(std::move (pixels))
+        {
+        }
+
+        bool initialize () override { return true; }
+        void finalize   () override { }
+
+        static std::shared_ptr< Texture_2D > create (Id , Color_Buffer< Rgba8888 > & color_buffer, const Options & )
+        {
+            return std::make_shared< Test_Texture > (std::move (color_buffer));
+        }
+    };
+
+    class Test_Window final : public Window
+    {
+    public:
+
+        Test_Window() : Window(ID(window))
+        {
+        }
+
+        Size2u   get_size   () override { return { 1, 1 }; }
+        unsigned get_width  () override { return 1; }
+        unsigned get_height () override { return 1; }
+    };
+
+    class Test_Context final : public Graphics_Context
+    {
+    public:
+
+        Test_Context(Window & window) : Graphics_Context(window)
+        {
+        }
+
+        void     invalidate         () override { }
+        void     suspend            () override { }
+        bool     resume             () override { return true; }
+        bool     is_available       () const override { return true; }
+        bool     is_current         () const override { return true; }
+        Id       get_id             () const override { return ID(test); }
+        unsigned get_surface_width  () override { return 1; }
+        unsigned get_surface_height () override { return 1; }
+        bool     set_sync_swap      (bool) override { return true; }
+        void     reset_viewport     () override { }
+        void     set_viewport       (const Point2u &, const Size2u &) override { }
+        bool     make_current       () override { return true; }
+        bool     flush_and_display  () override { return true; }
+    };
+
+    // ---------------------------------------------------------------------------------------------
+
+    Rgba8888 image_color (unsigned index)
+    {
+        Rgba8888 color;
+        byte     bytes[4] = { byte(index * 20 + 10), byte(250 - index * 10), byte(64 + index), 255 };
+
+        std::memcpy (&color, bytes, sizeof(color));
+
+        return color;
+    }
+
+    Color_Buffer< Rgba8888 > solid_image (unsigned width, unsigned height, Rgba8888 color)
+    {
+        Color_Buffer< Rgba8888 > image(width, height);
+
+        for (Rgba8888 & pixel : image.buffer) pixel = color;
+
+        return image;
+    }
+
+    bool is_power_of_two (unsigned value)
+    {
+        return value > 0 && (value & (value - 1)) == 0;
+    }
+
+    /**
+     * Comprueba que las imágenes de una página (con su margen) están dentro de ella, no se solapan y
+     * tienen su color, tanto en la imagen como en el margen que la rodea.
+     */
+    bool page_is_valid (const Atlas & atlas, const std::vector< const Atlas::Slice * > & slices, const std::vector< unsigned > & indices, unsigned padding, unsigned max_page_size)
+    {
+        const Test_Texture * texture = static_cast< const Test_Texture * >(atlas.get_texture ().get ());
+        const auto         & page    = texture->pixels;
+
+        if (!is_power_of_two (page.get_width ()) || !is_power_of_two (page.get_height ())) return false;
+        if (page.get_width () > max_page_size || page.get_height () > max_page_size) return false;
+
+        for (size_t a = 0; a < slices.size (); ++a)
+        {
+            int left   = int(slices[a]->left  ) - int(padding);
+            int bottom = int(slices[a]->bottom) - int(padding);
+            int right  = int(slices[a]->right ) + int(padding);
+            int top    = int(slices[a]->top   ) + int(padding);
+
+            if (left < 0 || bottom < 0 || right > int(page.get_width ()) || top > int(page.get_height ())) return false;
+
+            for (size_t b = a + 1; b < slices.size (); ++b)
+            {
+                bool apart = right  <= int(slices[b]->left  ) - int(padding) || int(slices[b]->right) + int(padding) <= left
+                          || top    <= int(slices[b]->bottom) - int(padding) || int(slices[b]->top  ) + int(padding) <= bottom;
+
+                if (!apart) return false;
+            }
+
+            for (int y = bottom; y < top; ++y)
+            {
+                for (int x = left; x < right; ++x)
+                {
+                    if (page[unsigned(y) * page.get_width () + unsigned(x)] != image_color (indices[a])) return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    struct Fixture
+    {
+        Test_Window                     window;
+        std::shared_ptr< Test_Context > context;
+        std::mutex                      mutex;
+
+        Fixture() : context(std::make_shared< Test_Context > (window))
+        {
+        }
+
+        Atlas_Packer::Atlas_List pack (Atlas_Packer & packer)
+        {
+            Graphics_Context::Accessor accessor(std::weak_ptr< Graphics_Context >(context), mutex);
+
+            return packer.pack (accessor);
+        }
+    };
+
+    void check_skyline_layout ()
+    {
+        // La imagen más ancha se coloca primero en la esquina y la otra encima de ella, porque en
+        // una página de 16 de ancho no caben al lado:
+
+        Fixture      fixture;
+        Atlas_Packer packer({}, 2048, 0);
+
+        packer.add (ID(small), solid_image ( 8, 8, image_color (0)));
+        packer.add (ID(wide),  solid_image (16, 8, image_color (1)));
+
+        Atlas_Packer::Atlas_List atlases = fixture.pack (packer);
+
+        CHECK(atlases.size () == 1);
+
+        if (atlases.size () != 1) return;
+
+        const Atlas::Slice * wide  = atlases[0]->get_slice (ID(wide ));
+        const Atlas::Slice * small = atlases[0]->get_slice (ID(small));
+
+        CHECK(wide  && wide ->left == 0 && wide ->bottom == 0 && wide ->width == 16 && wide ->height == 8);
+        CHECK(small && small->left == 0 && small->bottom == 8 && small->width ==  8 && small->height == 8);
+
+        CHECK(atlases[0]->get_texture ()->get_width  () == 16);
+        CHECK(atlases[0]->get_texture ()->get_height () == 16);
+    }
+
+    void check_many_pages ()
+    {
+        // Imágenes de tamaños variados que no caben en una sola página de 64x64:
+
+        const unsigned padding       = 2;
+        const unsigned max_page_size = 64;
+        const unsigned image_count   = 12;
+
+        Fixture      fixture;
+        Atlas_Packer packer({}, max_page_size, padding);
+
+        unsigned random = 2018;
+
+        for (unsigned index = 0; index < image_count; ++index)
+        {
+            random = random * 1664525u + 1013904223u;
+
+            unsigned width  = 4 + (random >> 16) % 24;
+            unsigned height = 4 + (random >> 24) % 24;
+
+            packer.add (Id(100 + index), solid_image (width, height, image_color (index)));
+        }
+
+        Atlas_Packer::Atlas_List atlases = fixture.pack (packer);
+
+        CHECK(atlases.size () > 1);
+
+        unsigned found = 0;
+
+        for (const Atlas_Packer::Atlas_Handle & atlas : atlases)
+        {
+            std::vector< const Atlas::Slice * > slices;
+            std::vector< unsigned >             indices;
+
+            for (unsigned index = 0; index < image_count; ++index)
+            {
+                const Atlas::Slice * slice = atlas->get_slice (Id(100 + index));
+
+                if (slice)
+                {
+                    slices .push_back (slice);
+                    indices.push_back (index);
+                }
+            }
+
+            CHECK(page_is_valid (*atlas, slices, indices, padding, max_page_size));
+
+            found += unsigned(slices.size ());
+        }
+
+        CHECK(found == image_count);
+    }
+
+    void check_oversized_image ()
+    {
+        // La imagen que no cabe en una página se descarta y el resto se colocan:
+
+        Fixture      fixture;
+        Atlas_Packer packer({}, 64, 2);
+
+        packer.add (ID(huge),  solid_image (100, 10, image_color (0)));
+        packer.add (ID(small), solid_image ( 10, 10, image_color (1)));
+
+        Atlas_Packer::Atlas_List atlases = fixture.pack (packer);
+
+        CHECK(atlases.size () == 1);
+        CHECK(Atlas_Packer::find_slice (atlases, ID(huge )) == nullptr);
+        CHECK(Atlas_Packer::find_slice (atlases, ID(small)) != nullptr);
+
+        // El packer se vacía después de pack():
+
+        CHECK(fixture.pack (packer).empty ());
+    }
+
+}
+
+int main ()
+{
+    Texture_2D::register_factory (ID(test), Test_Texture::create);
+
+    check_skyline_layout  ();
+    check_many_pages      ();
+    check_oversized_image ();
+
+    return tests::report ();
+}
@@ -0,0 +1,61 @@
+/*
+ * CHECK
+ * Copyright © 2018+ Ángel Rodríguez Ballesteros
+ *
+ * Distributed under the Boost Software License, version  1.0
+ * See documents/LICENSE.TXT or www.boost.org/LICENSE_1_0.txt
+ *
+ * angel.rodriguez@esne.edu
+ *
+ * C2610172320
+ */
+
+#ifndef BASICS_TESTS_CHECK_HEADER
+#define BASICS_TESTS_CHECK_HEADER
+
+    #include <cstdio>
+
+    // Cada comprobación es un programa que cuenta los CHECK que fallan y devuelve 1 si falla alguno
+    // (así lo interpreta ctest):
+    //
+    //     int main ()
+    //     {
+    //         CHECK(lz4_decode (...));
+    //
+    //         return basics::tests::report ();
+    //     }
+
+    namespace basics { namespace tests
+    {
+
+        inline unsigned & failures ()
+        {
+            static unsigned count = 0;
+
+            return count;
+        }
+
+        inline bool check (bool condition, const char * text, const char * file, int line)
+        {
+            if (!condition)
+            {
+                std::fprintf (stderr, "%s:%d: CHECK(%s) failed\n", file, line, text);
+
+                failures ()++;
+            }
+
+            return condition;
+        }
+
+        inline int report ()
+        {
+            if (failures () > 0) std::fprintf (stderr, "%u checks failed\n", failures ());
+
+            return failures () > 0 ? 1 : 0;
+        }
+
+    }}
+
+    #define CHECK(CONDITION) basics::tests::check ((CONDITION), #CONDITION, __FILE__, __LINE__)
+
+#endif
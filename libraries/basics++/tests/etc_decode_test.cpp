@@ -0,0 +1,298 @@
+/*
+ * ETC DECODE TEST
+ * Copyright © 2018+ Ángel Rodríguez Ballesteros
+ *
+ * Distributed under the Boost Software License, version  1.0
+ * See documents/LICENSE.TXT or www.boost.org/LICENSE_1_0.txt
+ *
+ * angel.rodriguez@esne.edu
+ *
+ * C2610172330
+ */
+
+// Comprueba etc_decode() con bloques construidos a mano a partir de la especificación de Khronos. Los
+// valores esperados están calculados a mano, no con el propio decodificador.
+
+#include <cstdint>
+#include <vector>
+#include <basics/etc_decode>
+#include "check.hpp"
+
+using namespace basics;
+
+namespace
+{
+
+    /**
+     * Escribe un bloque de 64 bits en el orden en el que se guarda (big endian).
+     */
+    void put_block (std::vector< byte > & data, uint64_t block)
+    {
+        for (int shift = 56; shift >= 0; shift -= 8) data.push_back (byte(block >> shift));
+    }
+
+    /**
+     * Índices de 2 bits de los píxeles de un bloque ETC1/ETC2. index(x, y) da el del píxel (x, y).
+     */
+    template< typename INDEX >
+    uint64_t pixel_indices (INDEX index)
+    {
+        uint64_t bits = 0;
+
+        for (unsigned x = 0; x < 4; ++x)
+        {
+            for (unsigned y = 0; y < 4; ++y)
+            {
+                unsigned bit   = x * 4 + y;
+                unsigned value = index (x, y);
+
+                bits |= uint64_t(value >> 1) << (16 + bit);
+                bits |= uint64_t(value &  1) << bit;
+            }
+        }
+
+        return bits;
+    }
+
+    /**
+     * Bloque en modo individual: dos colores de 4 bits por canal.
+     */
+    uint64_t individual_block (const unsigned (& color1)[3], const unsigned (& color2)[3], unsigned table1, unsigned table2, bool flip, uint64_t indices)
+    {
+        uint64_t block = indices;
+
+        for (unsigned channel = 0; channel < 3; ++channel)
+        {
+            block |= uint64_t((color1[channel] << 4) | color2[channel]) << (56 - channel * 8);
+        }
+
+        return block | uint64_t((table1 << 5) | (table2 << 2) | (flip ? 1 : 0)) << 32;
+    }
+
+    /**
+     * Bloque en modo diferencial: un color de 5 bits por canal y una diferencia de 3 bits con signo.
+     */
+    uint64_t differential_block (const unsigned (& color)[3], const int (& delta)[3], unsigned table1, unsigned table2, bool flip, uint64_t indices)
+    {
+        uint64_t block = indices;
+
+        for (unsigned channel = 0; channel < 3; ++channel)
+        {
+            block |= uint64_t((color[channel] << 3) | (unsigned(delta[channel]) & 7)) << (56 - channel * 8);
+        }
+
+        return block | uint64_t((table1 << 5) | (table2 << 2) | 2 | (flip ? 1 : 0)) << 32;
+    }
+
+    bool pixel_is (const Color_Buffer< Rgba8888 > & color_buffer, unsigned x, unsigned y, int r, int g, int b, int a = 255)
+    {
+        const byte * pixel = reinterpret_cast< const byte * >(&color_buffer[y * color_buffer.get_width () + x]);
+
+        if (pixel[0] == r && pixel[1] == g && pixel[2] == b && pixel[3] == a) return true;
+
+        std::fprintf
+        (
+            stderr, "pixel (%u, %u) is (%d, %d, %d, %d), expected (%d, %d, %d, %d)\n",
+            x, y, pixel[0], pixel[1], pixel[2], pixel[3], r, g, b, a
+        );
+
+        return false;
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    void check_individual_mode ()
+    {
+        // Subbloques izquierdo y derecho (sin flip). Colores (8, 4, 2) -> (136, 68, 34) con la tabla
+        // 0 (2, 8) y (1, 3, 15) -> (17, 51, 255) con la tabla 7 (47, 183). Los índices 0 y 1 suman el
+        // modificador pequeño y el grande, y 2 y 3 los restan:
+
+        const unsigned color1[] = { 8, 4,  2 };
+        const unsigned color2[] = { 1, 3, 15 };
+
+        std::vector< byte > data;
+
+        put_block (data, individual_block (color1, color2, 0, 7, false, pixel_indices ([] (unsigned x, unsigned y) { return (x + y) & 3; })));
+
+        Color_Buffer< Rgba8888 > color_buffer;
+
+        CHECK(etc_decode (Compressed_Image::ETC1_RGB, data.data (), nullptr, 4, 4, color_buffer));
+        CHECK(color_buffer.get_width () == 4 && color_buffer.get_height () == 4);
+
+        CHECK(pixel_is (color_buffer, 0, 0, 138,  70,  36));            // Índice 0: +2
+        CHECK(pixel_is (color_buffer, 1, 0, 144,  76,  42));            // Índice 1: +8
+        CHECK(pixel_is (color_buffer, 1, 1, 134,  66,  32));            // Índice 2: -2
+        CHECK(pixel_is (color_buffer, 0, 3, 128,  60,  26));            // Índice 3: -8
+        CHECK(pixel_is (color_buffer, 2, 2,  64,  98, 255));            // Índice 0: +47
+        CHECK(pixel_is (color_buffer, 3, 0,   0,   0,  72));            // Índice 3: -183
+        CHECK(pixel_is (color_buffer, 3, 3,   0,   4, 208));            // Índice 2: -47
+        CHECK(pixel_is (color_buffer, 2, 3, 200, 234, 255));            // Índice 1: +183
+    }
+
+    void check_differential_mode ()
+    {
+        // Subbloques superior e inferior (con flip). (20, 10, 16) -> (165, 82, 132) y con la
+        // diferencia (-2, +3, 0) queda (18, 13, 16) -> (148, 107, 132). Tablas 1 (5, 17) y 2 (9, 29):
+
+        const unsigned color[] = { 20, 10, 16 };
+        const int      delta[] = { -2,  3,  0 };
+
+        std::vector< byte > data;
+
+        put_block (data, differential_block (color, delta, 1, 2, true, pixel_indices ([] (unsigned x, unsigned) { return x == 3 ? 1 : 0; })));
+
+        Color_Buffer< Rgba8888 > color_buffer;
+
+        CHECK(etc_decode (Compressed_Image::ETC1_RGB, data.data (), nullptr, 4, 4, color_buffer));
+
+        CHECK(pixel_is (color_buffer, 0, 0, 170,  87, 137));
+        CHECK(pixel_is (color_buffer, 3, 1, 182,  99, 149));
+        CHECK(pixel_is (color_buffer, 0, 2, 157, 116, 141));
+        CHECK(pixel_is (color_buffer, 3, 3, 177, 136, 161));
+    }
+
+    void check_planar_mode ()
+    {
+        // En ETC2 un bloque diferencial cuyo azul se sale de rango está en modo planar. Aquí el azul
+        // vale 0 con diferencia -1. Los colores son O = (16, 32, 7), H = O y V = (48, 32, 7), que se
+        // expanden a O = (65, 64, 28) y V = (195, 64, 28):
+
+        uint64_t block = 0;
+
+        block |= uint64_t(1) << 61;                                     // RO = 16
+        block |= uint64_t(1) << 54;                                     // GO = 32
+        block |= uint64_t(7) << 39;                                     // BO = 7
+        block |= uint64_t(1) << 42;                                     // Signo de la diferencia del azul
+        block |= uint64_t(1) << 37;                                     // RH = 16
+        block |= uint64_t(1) << 33;                                     // Modo diferencial
+        block |= uint64_t(1) << 30;                                     // GH = 32
+        block |= uint64_t(7) << 19;                                     // BH = 7
+        block |= uint64_t(3) << 17;                                     // RV = 48
+        block |= uint64_t(1) << 11;                                     // GV = 32
+        block |= uint64_t(7) <<  0;                                     // BV = 7
+
+        std::vector< byte > data;
+
+        put_block (data, block);
+
+        Color_Buffer< Rgba8888 > color_buffer;
+
+        CHECK(etc_decode (Compressed_Image::ETC2_RGB, data.data (), nullptr, 4, 4, color_buffer));
+
+        // R = (y * (RV - RO) + 4 * RO + 2) >> 2, que no depende de x porque RH = RO:
+
+        for (unsigned x = 0; x < 4; ++x)
+        {
+            CHECK(pixel_is (color_buffer, x, 0,  65, 64, 28));
+            CHECK(pixel_is (color_buffer, x, 1,  98, 64, 28));
+            CHECK(pixel_is (color_buffer, x, 2, 130, 64, 28));
+            CHECK(pixel_is (color_buffer, x, 3, 163, 64, 28));
+        }
+    }
+
+    void check_punch_through ()
+    {
+        // Con alfa de un bit el bit diferencial a 0 indica que el bloque puede tener píxeles
+        // transparentes: el índice 2 lo es y el índice 0 no suma nada. (20, 10, 16) -> (165, 82, 132):
+
+        const unsigned color[] = { 20, 10, 16 };
+        const int      delta[] = {  0,  0,  0 };
+
+        uint64_t block = differential_block (color, delta, 0, 0, false, pixel_indices ([] (unsigned x, unsigned) { return x == 0 ? 0u : x == 1 ? 2u : 1u; }));
+
+        std::vector< byte > data;
+
+        put_block (data, block & ~(uint64_t(1) << 33));
+
+        Color_Buffer< Rgba8888 > color_buffer;
+
+        CHECK(etc_decode (Compressed_Image::ETC2_RGB_A1, data.data (), nullptr, 4, 4, color_buffer));
+
+        CHECK(pixel_is (color_buffer, 0, 0, 165, 82, 132));
+        CHECK(pixel_is (color_buffer, 1, 0,   0,  0,   0, 0));
+        CHECK(pixel_is (color_buffer, 2, 0, 173, 90, 140));
+    }
+
+    void check_alpha ()
+    {
+        const unsigned grey  [] = { 8, 8, 8 };
+        const unsigned bright[] = { 10, 10, 10 };
+
+        uint64_t color_block = individual_block (grey, grey, 0, 0, false, 0);
+
+        // EAC: base 128, multiplicador 2 y tabla 13 (-1, -2, -3, -10, 0, 1, 2, 9). Todos los píxeles
+        // usan el índice 4 (+0) salvo (0, 0), con el 7 (+9), y (3, 3), con el 3 (-10):
+
+        uint64_t alpha_block = uint64_t(128) << 56 | uint64_t(2) << 52 | uint64_t(13) << 48;
+
+        for (unsigned pixel = 0; pixel < 16; ++pixel)
+        {
+            uint64_t index = pixel == 0 ? 7 : pixel == 15 ? 3 : 4;
+
+            alpha_block |= index << (45 - pixel * 3);
+        }
+
+        std::vector< byte > data;
+
+        put_block (data, alpha_block);
+        put_block (data, color_block);
+
+        Color_Buffer< Rgba8888 > color_buffer;
+
+        CHECK(etc_decode (Compressed_Image::ETC2_RGBA, data.data (), nullptr, 4, 4, color_buffer));
+
+        CHECK(pixel_is (color_buffer, 0, 0, 138, 138, 138, 146));
+        CHECK(pixel_is (color_buffer, 1, 2, 138, 138, 138, 128));
+        CHECK(pixel_is (color_buffer, 3, 3, 138, 138, 138, 108));
+
+        // ETC1 con plano de alfa: el alfa es el verde de la segunda imagen, 10 -> 170 más 2:
+
+        std::vector< byte > color_data;
+        std::vector< byte > alpha_data;
+
+        put_block (color_data, color_block);
+        put_block (alpha_data, individual_block (bright, bright, 0, 0, false, 0));
+
+        CHECK(etc_decode (Compressed_Image::ETC1_RGB, color_data.data (), alpha_data.data (), 4, 4, color_buffer));
+
+        CHECK(pixel_is (color_buffer, 2, 1, 138, 138, 138, 172));
+    }
+
+    void check_partial_blocks ()
+    {
+        // Una imagen de 5x3 ocupa dos bloques y se recorta sin escribir fuera del buffer:
+
+        const unsigned dark [] = {  1,  1,  1 };
+        const unsigned light[] = { 14, 14, 14 };
+
+        std::vector< byte > data;
+
+        put_block (data, individual_block (dark,  dark,  0, 0, false, 0));
+        put_block (data, individual_block (light, light, 0, 0, false, 0));
+
+        Color_Buffer< Rgba8888 > color_buffer;
+
+        CHECK(etc_decode (Compressed_Image::ETC1_RGB, data.data (), nullptr, 5, 3, color_buffer));
+        CHECK(color_buffer.get_width () == 5 && color_buffer.get_height () == 3);
+
+        CHECK(pixel_is (color_buffer, 3, 2,  19,  19,  19));
+        CHECK(pixel_is (color_buffer, 4, 2, 240, 240, 240));
+
+        // Los formatos que no son ETC se rechazan:
+
+        CHECK(!etc_decode (Compressed_Image::ASTC_RGBA, data.data (), nullptr, 4, 4, color_buffer));
+    }
+
+}
+
+int main ()
+{
+    check_individual_mode   ();
+    check_differential_mode ();
+    check_planar_mode       ();
+    check_punch_through     ();
+    check_alpha             ();
+    check_partial_blocks    ();
+
+    return tests::report ();
+}
@@ -0,0 +1,199 @@
+/*
+ * LZ4 DECODE TEST
+ * Copyright © 2018+ Ángel Rodríguez Ballesteros
+ *
+ * Distributed under the Boost Software License, version  1.0
+ * See documents/LICENSE.TXT or www.boost.org/LICENSE_1_0.txt
+ *
+ * angel.rodriguez@esne.edu
+ *
+ * C2610172358
+ */
+
+// Comprueba lz4_decode() con bloques escritos a mano: literales, copias que se solapan y que no,
+// longitudes que continúan en varios bytes y bloques corruptos o truncados, que deben rechazarse
+// sin escribir fuera del destino.
+
+#include <string>
+#include <vector>
+#include <basics/lz4_decode>
+#include "check.hpp"
+
+using namespace basics;
+
+namespace
+{
+
+    typedef std::vector< byte > Bytes;
+
+    const byte guard = 0xA5;            ///< Relleno tras el destino para detectar escrituras de más.
+
+    /**
+     * Descomprime source en un destino de target_size bytes seguido de unos bytes de guarda.
+     * @return false si lz4_decode() falla o si ha escrito en la guarda.
+     */
+    bool decode (const Bytes & source, size_t target_size, Bytes & target)
+    {
+        target.assign (target_size + 16, guard);
+
+        bool decoded = lz4_decode (source.data (), source.size (), target.data (), target_size);
+
+        for (size_t index = target_size; index < target.size (); ++index)
+        {
+            if (target[index] != guard) return false;
+        }
+
+        target.resize (target_size);
+
+        return decoded;
+    }
+
+    Bytes text (const std::string & characters)
+    {
+        return Bytes(characters.begin (), characters.end ());
+    }
+
+    /**
+     * Bloque de una secuencia con literales y copia seguida de la secuencia final de 5 literales
+     * con la que acaban los bloques de LZ4.
+     */
+    Bytes block (byte token, const std::string & literals, const Bytes & match, const std::string & last_literals)
+    {
+        Bytes result(1, token);
+
+        result.insert (result.end (), literals.begin (), literals.end ());
+        result.insert (result.end (), match.begin (), match.end ());
+        result.push_back (byte(last_literals.size () << 4));
+        result.insert (result.end (), last_literals.begin (), last_literals.end ());
+
+        return result;
+    }
+
+    /**
+     * Bloque con longitudes que no caben en el token: 273 literales (15 + 255 + 3) y una copia de
+     * 284 bytes (4 + 15 + 255 + 10) a distancia 1. Descomprimido ocupa 273 + 284 + 5 bytes.
+     */
+    Bytes long_block ()
+    {
+        Bytes result = { 0xFF, 0xFF, 0x03 };
+
+        for (unsigned index = 0; index < 273; ++index) result.push_back (byte('a' + index % 26));
+
+        Bytes tail = { 0x01, 0x00, 0xFF, 0x0A, 0x50, 'v', 'w', 'x', 'y', 'z' };
+
+        result.insert (result.end (), tail.begin (), tail.end ());
+
+        return result;
+    }
+
+    const size_t long_block_size = 273 + 284 + 5;
+
+    // ---------------------------------------------------------------------------------------------
+
+    void check_valid_blocks ()
+    {
+        Bytes target;
+
+        // Solo literales:
+
+        CHECK(decode (Bytes{ 0x50, 'h', 'e', 'l', 'l', 'o' }, 5, target) && target == text ("hello"));
+
+        // Una copia que no se solapa, otra a distancia 1 que rellena y otra a distancia 3 que repite
+        // el patrón mientras lo escribe:
+
+        CHECK(decode (block (0x40, "abcd", { 4, 0 }, "vwxyz"), 13, target) && target == text ("abcdabcdvwxyz"));
+        CHECK(decode (block (0x16, "z",    { 1, 0 }, "zzzzz"), 16, target) && target == Bytes(16, 'z'));
+        CHECK(decode (block (0x36, "xyz",  { 3, 0 }, "yzxyz"), 18, target) && target == text ("xyzxyzxyzxyzxyzxyz"));
+
+        // Longitudes de varios bytes:
+
+        Bytes expected;
+
+        for (unsigned index = 0; index < 273; ++index) expected.push_back (byte('a' + index % 26));
+
+        expected.insert (expected.end (), 284, expected.back ());
+        expected.insert (expected.end (), { 'v', 'w', 'x', 'y', 'z' });
+
+        CHECK(decode (long_block (), long_block_size, target) && target == expected);
+    }
+
+    void check_invalid_blocks ()
+    {
+        Bytes target;
+
+        // Distancia 0 y distancia que apunta antes del principio del destino:
+
+        CHECK(!decode (block (0x16, "z", { 0, 0 }, "zzzzz"), 16, target));
+        CHECK(!decode (block (0x16, "z", { 2, 0 }, "zzzzz"), 16, target));
+
+        // Más datos de los que caben en el destino (en los literales y en la copia) y menos de los
+        // que lo llenan:
+
+        CHECK(!decode (Bytes{ 0x50, 'h', 'e', 'l', 'l', 'o' }, 4, target));
+        CHECK(!decode (block (0x16, "z", { 1, 0 }, "zzzzz"),     8, target));
+        CHECK(!decode (Bytes{ 0x50, 'h', 'e', 'l', 'l', 'o' }, 6, target));
+
+        // Literales, longitudes y distancias que se salen del bloque:
+
+        CHECK(!decode (Bytes{ 0x50, 'h', 'e' },   5, target));
+        CHECK(!decode (Bytes{ 0xF0, 0xFF },      300, target));
+        CHECK(!decode (Bytes{ 0x1F, 'a', 1, 0 }, 100, target));
+        CHECK(!decode (Bytes{ 0x10, 'a', 1 },     16, target));
+
+        // Ningún prefijo del bloque largo llena el destino:
+
+        Bytes    source   = long_block ();
+        unsigned accepted = 0;
+
+        for (size_t length = 0; length < source.size (); ++length)
+        {
+            accepted += decode (Bytes(source.begin (), source.begin () + length), long_block_size, target);
+        }
+
+        CHECK(accepted == 0);
+    }
+
+    void check_random_blocks ()
+    {
+        // Datos aleatorios: lz4_decode() puede aceptarlos o no, pero nunca escribir fuera del
+        // destino (decode() lo comprueba con la guarda):
+
+        unsigned random   = 2018;
+        unsigned overruns = 0;
+
+        for (unsigned attempt = 0; attempt < 20000; ++attempt)
+        {
+            random = random * 1664525u + 1013904223u;
+
+            Bytes  source(1 + (random >> 16) % 48);
+            size_t target_size = (random >> 8) % 96;
+
+            for (byte & value : source)
+            {
+                random = random * 1664525u + 1013904223u;
+                value  = byte(random >> 24);
+            }
+
+            Bytes target(target_size + 16, guard);
+
+            lz4_decode (source.data (), source.size (), target.data (), target_size);
+
+            for (size_t index = target_size; index < target.size (); ++index)
+            {
+                if (target[index] != guard) { ++overruns; break; }
+            }
+        }
+
+        CHECK(overruns == 0);
+    }
+
+}
+
+int main ()
+{
+    check_valid_blocks   ();
+    check_invalid_blocks ();
+    check_random_blocks  ();
+
+    return tests::report ();
+}
@@ -0,0 +1,259 @@
+/*
+ * PIXEL CONVERT TEST
+ * Copyright © 2018+ Ángel Rodríguez Ballesteros
+ *
+ * Distributed under the Boost Software License, version  1.0
+ * See documents/LICENSE.TXT or www.boost.org/LICENSE_1_0.txt
+ *
+ * angel.rodriguez@esne.edu
+ *
+ * C2610172345
+ */
+
+// Comprueba convert_pixels() y premultiply_alpha() con unos valores calculados a mano y compara el
+// resto con una versión escalar de las fórmulas de pixel_convert.cpp. Las imágenes tienen un ancho
+// que no es múltiplo de 16 para que pasen por el camino SIMD y por el de los píxeles sobrantes.
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <basics/pixel_convert>
+#include "check.hpp"
+
+using namespace basics;
+
+namespace
+{
+
+    Rgba8888 make_pixel (unsigned r, unsigned g, unsigned b, unsigned a)
+    {
+        Rgba8888 pixel;
+        byte     bytes[4] = { byte(r), byte(g), byte(b), byte(a) };
+
+        std::memcpy (&pixel, bytes, sizeof(pixel));
+
+        return pixel;
+    }
+
+    const byte * pixel_bytes (const Color_Buffer< Rgba8888 > & color_buffer, unsigned index)
+    {
+        return reinterpret_cast< const byte * >(color_buffer.buffer.data () + index);
+    }
+
+    /**
+     * Imagen con valores pseudoaleatorios en la que aparecen también los extremos (0 y 255), que
+     * son los que saturan al sumar el desplazamiento del redondeo o del tramado.
+     */
+    Color_Buffer< Rgba8888 > make_image (unsigned width, unsigned height)
+    {
+        Color_Buffer< Rgba8888 > color_buffer(width, height);
+
+        unsigned random = 2018;
+
+        for (Rgba8888 & pixel : color_buffer.buffer)
+        {
+            unsigned channels[4];
+
+            for (unsigned & channel : channels)
+            {
+                random  = random * 1664525u + 1013904223u;
+                channel = (random >> 24) % 5 == 0 ? ((random >> 16) & 1) * 255 : (random >> 16) & 0xFF;
+            }
+
+            pixel = make_pixel (channels[0], channels[1], channels[2], channels[3]);
+        }
+
+        return color_buffer;
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    /**
+     * Un píxel en un formato de 16 bits: bits de cada canal (r, g, b, a) y posición del más bajo.
+     */
+    uint16_t reference_16_bits (const byte * pixel, unsigned x, unsigned y, const unsigned (& bits)[4], const unsigned (& position)[4], bool dither)
+    {
+        static const unsigned bayer_matrix[4][4] =
+        {
+            {  0,  8,  2, 10 },
+            { 12,  4, 14,  6 },
+            {  3, 11,  1,  9 },
+            { 15,  7, 13,  5 },
+        };
+
+        unsigned result = 0;
+
+        for (unsigned channel = 0; channel < 4; ++channel)
+        {
+            if (bits[channel] == 0) continue;
+
+            unsigned step   = 1u << (8 - bits[channel]);
+            unsigned offset = bits[channel] == 1 ? 0 : dither ? bayer_matrix[y & 3][x & 3] * step / 16 : step / 2;
+            unsigned value  = pixel[channel] + offset;
+
+            if (value > 255) value = 255;
+
+            result |= (value >> (8 - bits[channel])) << position[channel];
+        }
+
+        return uint16_t(result);
+    }
+
+    bool matches_reference_16_bits (const Color_Buffer< Rgba8888 > & color_buffer, Pixel_Format format, bool dither, const unsigned (& bits)[4], const unsigned (& position)[4])
+    {
+        std::vector< uint16_t > target(color_buffer.size ());
+
+        convert_pixels (color_buffer, format, dither, reinterpret_cast< byte * >(target.data ()));
+
+        for (unsigned y = 0, index = 0; y < color_buffer.get_height (); ++y)
+        {
+            for (unsigned x = 0; x < color_buffer.get_width (); ++x, ++index)
+            {
+                if (target[index] != reference_16_bits (pixel_bytes (color_buffer, index), x, y, bits, position, dither))
+                {
+                    std::fprintf (stderr, "format %d dither %d: pixel (%u, %u) differs\n", int(format), int(dither), x, y);
+
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    void check_known_values ()
+    {
+        Color_Buffer< Rgba8888 > color_buffer(1, 1);
+        uint16_t                 packed;
+        byte                     single;
+
+        // Sin tramado se redondea al más cercano y el rojo satura en lugar de desbordarse:
+
+        color_buffer.buffer[0] = make_pixel (255, 128, 0, 255);
+
+        convert_pixels (color_buffer, RGB_565, false, reinterpret_cast< byte * >(&packed));
+
+        CHECK(packed == 0xFC00);
+
+        color_buffer.buffer[0] = make_pixel (255, 255, 255, 255);
+
+        convert_pixels (color_buffer, RGBA_4444, false, reinterpret_cast< byte * >(&packed));
+
+        CHECK(packed == 0xFFFF);
+
+        convert_pixels (color_buffer, LUMINANCE_8, false, &single);
+
+        CHECK(single == 255);
+
+        // El alfa de un bit se corta en la mitad:
+
+        color_buffer.buffer[0] = make_pixel (0, 0, 0, 127);
+
+        convert_pixels (color_buffer, RGBA_5551, false, reinterpret_cast< byte * >(&packed));
+
+        CHECK(packed == 0x0000);
+
+        color_buffer.buffer[0] = make_pixel (0, 0, 0, 128);
+
+        convert_pixels (color_buffer, RGBA_5551, false, reinterpret_cast< byte * >(&packed));
+
+        CHECK(packed == 0x0001);
+
+        convert_pixels (color_buffer, ALPHA_8, false, &single);
+
+        CHECK(single == 128);
+
+        // 128 * 128 / 255 = 64.25 y 255 * 128 / 255 = 128:
+
+        color_buffer.buffer[0] = make_pixel (255, 128, 0, 128);
+
+        premultiply_alpha (color_buffer);
+
+        const byte * pixel = pixel_bytes (color_buffer, 0);
+
+        CHECK(pixel[0] == 128 && pixel[1] == 64 && pixel[2] == 0 && pixel[3] == 128);
+    }
+
+    void check_16_bit_formats ()
+    {
+        static const unsigned bits_565 [4] = { 5, 6, 5, 0 }, position_565 [4] = { 11, 5, 0, 0 };
+        static const unsigned bits_4444[4] = { 4, 4, 4, 4 }, position_4444[4] = { 12, 8, 4, 0 };
+        static const unsigned bits_5551[4] = { 5, 5, 5, 1 }, position_5551[4] = { 11, 6, 1, 0 };
+
+        Color_Buffer< Rgba8888 > color_buffer = make_image (37, 6);
+
+        for (bool dither : { false, true })
+        {
+            CHECK(matches_reference_16_bits (color_buffer, RGB_565,   dither, bits_565,  position_565 ));
+            CHECK(matches_reference_16_bits (color_buffer, RGBA_4444, dither, bits_4444, position_4444));
+            CHECK(matches_reference_16_bits (color_buffer, RGBA_5551, dither, bits_5551, position_5551));
+        }
+    }
+
+    void check_8_bit_formats ()
+    {
+        Color_Buffer< Rgba8888 > color_buffer = make_image (37, 3);
+        std::vector< byte >      alpha(color_buffer.size ());
+        std::vector< byte >      luminance(color_buffer.size ());
+        std::vector< byte >      copy(color_buffer.size () * 4);
+
+        convert_pixels (color_buffer, ALPHA_8,     false, alpha.data ());
+        convert_pixels (color_buffer, LUMINANCE_8, false, luminance.data ());
+        convert_pixels (color_buffer, RGBA_8888,   false, copy.data ());
+
+        unsigned alpha_errors     = 0;
+        unsigned luminance_errors = 0;
+
+        for (unsigned index = 0; index < color_buffer.size (); ++index)
+        {
+            const byte * pixel = pixel_bytes (color_buffer, index);
+
+            alpha_errors     += alpha    [index] != pixel[3];
+            luminance_errors += luminance[index] != byte((77 * pixel[0] + 150 * pixel[1] + 29 * pixel[2] + 128) >> 8);
+        }
+
+        CHECK(alpha_errors     == 0);
+        CHECK(luminance_errors == 0);
+        CHECK(std::memcmp (copy.data (), color_buffer.buffer.data (), copy.size ()) == 0);
+    }
+
+    void check_premultiplication ()
+    {
+        Color_Buffer< Rgba8888 > original      = make_image (37, 3);
+        Color_Buffer< Rgba8888 > premultiplied = original;
+
+        premultiply_alpha (premultiplied);
+
+        unsigned errors = 0;
+
+        for (unsigned index = 0; index < original.size (); ++index)
+        {
+            const byte * source = pixel_bytes (original,      index);
+            const byte * result = pixel_bytes (premultiplied, index);
+
+            // Redondeo al más cercano de c * a / 255, calculado con una división:
+
+            for (unsigned channel = 0; channel < 3; ++channel)
+            {
+                errors += result[channel] != byte((source[channel] * source[3] * 2 + 255) / 510);
+            }
+
+            errors += result[3] != source[3];
+        }
+
+        CHECK(errors == 0);
+    }
+
+}
+
+int main ()
+{
+    check_known_values      ();
+    check_16_bit_formats    ();
+    check_8_bit_formats     ();
+    check_premultiplication ();
+
+    return tests::report ();
+}
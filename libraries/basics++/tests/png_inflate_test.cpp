@@ -0,0 +1,285 @@
+/*
+ * PNG INFLATE TEST
+ * Copyright © 2018+ Ángel Rodríguez Ballesteros
+ *
+ * Distributed under the Boost Software License, version  1.0
+ * See documents/LICENSE.TXT or www.boost.org/LICENSE_1_0.txt
+ *
+ * angel.rodriguez@esne.edu
+ *
+ * C2610172321
+ */
+
+// Comprueba inflate() y png_decode() contra el compresor y el decodificador de lodepng, y que las
+// imágenes truncadas se rechazan sin que el buffer de salida crezca sin límite.
+
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <basics/inflate>
+#include <basics/png_decode>
+#include "lodepng.h"
+#include "png_internal.hpp"
+#include "check.hpp"
+
+using namespace basics;
+
+namespace
+{
+
+    /**
+     * Datos que se comprimen bien pero no del todo: repeticiones con ruido.
+     */
+    std::vector< byte > make_data (size_t size, unsigned seed)
+    {
+        std::vector< byte > data(size);
+
+        for (size_t index = 0; index < size; ++index)
+        {
+            seed = seed * 1664525u + 1013904223u;
+
+            data[index] = (seed >> 24) < 64 ? byte(seed >> 16) : byte(index / 7);
+        }
+
+        return data;
+    }
+
+    /**
+     * Círculo con un degradado sobre fondo transparente, como los sprites del juego. Sus códigos de
+     * Huffman hacen que una secuencia de bits a cero se decodifique como literales válidos.
+     */
+    std::vector< byte > make_sprite (unsigned width, unsigned height)
+    {
+        std::vector< byte > pixels(width * height * 4, 0);
+
+        for (unsigned y = 0; y < height; ++y)
+        {
+            for (unsigned x = 0; x < width; ++x)
+            {
+                int dx = int(x) - int(width  / 2);
+                int dy = int(y) - int(height / 2);
+
+                if (dx * dx + dy * dy < int(height * height / 6))
+                {
+                    byte * pixel = &pixels[(y * width + x) * 4];
+
+                    pixel[0] = byte(x);
+                    pixel[1] = byte(y);
+                    pixel[2] = 128;
+                    pixel[3] = 255;
+                }
+            }
+        }
+
+        return pixels;
+    }
+
+    std::vector< byte > deflate (const std::vector< byte > & data, unsigned btype)
+    {
+        LodePNGCompressSettings settings;
+
+        lodepng_compress_settings_init (&settings);
+
+        settings.btype = btype;
+
+        unsigned char * compressed      = nullptr;
+        size_t          compressed_size = 0;
+
+        lodepng_deflate (&compressed, &compressed_size, data.data (), data.size (), &settings);
+
+        std::vector< byte > result(compressed, compressed + compressed_size);
+
+        std::free (compressed);
+
+        return result;
+    }
+
+    /**
+     * Deja en la mitad los datos del chunk IDAT y recalcula su CRC, de modo que el PNG es válido
+     * salvo por el flujo deflate truncado.
+     */
+    std::vector< byte > truncate_idat (const std::vector< byte > & png)
+    {
+        std::vector< byte > result(png.begin (), png.begin () + 8);
+
+        for (size_t offset = 8; offset + 12 <= png.size (); )
+        {
+            const byte * chunk  = png.data () + offset;
+            unsigned     length = lodepng_chunk_length (chunk);
+            size_t       kept   = lodepng_chunk_type_equals (chunk, "IDAT") ? length / 2 : length;
+            size_t       start  = result.size ();
+
+            result.insert (result.end (), chunk, chunk + 8 + kept);
+            result.insert (result.end (), 4, 0);
+
+            result[start    ] = byte(kept >> 24);
+            result[start + 1] = byte(kept >> 16);
+            result[start + 2] = byte(kept >>  8);
+            result[start + 3] = byte(kept      );
+
+            lodepng_chunk_generate_crc (result.data () + start);
+
+            offset += 12 + length;
+        }
+
+        return result;
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    void check_inflate ()
+    {
+        for (unsigned btype = 0; btype < 3; ++btype)
+        {
+            std::vector< byte > data       = make_data (100000, btype);
+            std::vector< byte > compressed = deflate (data, btype);
+            std::vector< byte > output(data.size ());
+
+            CHECK(!compressed.empty ());
+            CHECK(inflate (compressed.data (), compressed.size (), output.data (), output.size ()));
+            CHECK(output == data);
+
+            // El tamaño de destino debe coincidir exactamente:
+
+            CHECK(!inflate (compressed.data (), compressed.size (), output.data (), output.size () - 1));
+
+            // Truncado, con el destino fijo y con el buffer ampliable de lodepng:
+
+            size_t half = compressed.size () / 2;
+
+            CHECK(!inflate (compressed.data (), half, output.data (), output.size ()));
+
+            LodePNGDecompressSettings settings;
+
+            lodepng_decompress_settings_init (&settings);
+
+            unsigned char * inflated      = nullptr;
+            size_t          inflated_size = 0;
+
+            CHECK(png_inflate (&inflated, &inflated_size, compressed.data (), half, &settings) != 0);
+            CHECK(inflated_size <= data.size ());
+
+            std::free (inflated);
+        }
+    }
+
+    void check_png_decode ()
+    {
+        struct Format { LodePNGColorType color_type; unsigned channels; };
+
+        const Format formats[] = { { LCT_GREY, 1 }, { LCT_GREY_ALPHA, 2 }, { LCT_RGB, 3 }, { LCT_RGBA, 4 } };
+
+        unsigned width  = 37;
+        unsigned height = 23;
+
+        // Las imágenes sin entrelazar se descomprimen y se desfiltran sobre el propio Color_Buffer y
+        // las entrelazadas pasan por el buffer de lodepng, así que se prueban las dos:
+
+        for (unsigned interlace = 0; interlace < 2; ++interlace)
+        for (const Format & format : formats)
+        {
+            std::vector< byte > pixels = make_data (width * height * 4, format.channels);
+            std::vector< byte > png;
+            std::vector< byte > expected;
+            std::vector< byte > raw;
+
+            // Se reduce la imagen RGBA al formato a probar y se codifica:
+
+            for (size_t pixel = 0; pixel < size_t(width) * height; ++pixel)
+            {
+                raw.insert (raw.end (), pixels.begin () + pixel * 4, pixels.begin () + pixel * 4 + format.channels);
+            }
+
+            lodepng::State state;
+
+            state.info_raw.colortype        = format.color_type;
+            state.info_png.color.colortype  = format.color_type;
+            state.info_png.interlace_method = interlace;
+            state.encoder.auto_convert      = 0;
+
+            CHECK(lodepng::encode (png, raw, width, height, state) == 0);
+
+            unsigned expected_width, expected_height;
+
+            CHECK(lodepng::decode (expected, expected_width, expected_height, png) == 0);
+
+            Color_Buffer< Rgba8888 > color_buffer;
+            unsigned                 decoded_width, decoded_height;
+            bool                     opaque;
+
+            if (CHECK(png_decode (png.data (), png.size (), color_buffer, decoded_width, decoded_height, opaque)))
+            {
+                CHECK(decoded_width == width && decoded_height == height);
+                CHECK(std::memcmp (static_cast< byte * >(color_buffer), expected.data (), expected.size ()) == 0);
+            }
+        }
+    }
+
+    void check_truncated_png ()
+    {
+        unsigned            width  = 160;
+        unsigned            height = 120;
+        std::vector< byte > pixels = make_sprite (width, height);
+
+        for (unsigned interlace = 0; interlace < 2; ++interlace)
+        {
+            lodepng::State      state;
+            std::vector< byte > png;
+
+            state.info_png.interlace_method = interlace;
+
+            CHECK(lodepng::encode (png, pixels, width, height, state) == 0);
+
+            std::vector< byte > truncated = truncate_idat (png);
+
+            // lodepng lo rechaza y png_decode() debe hacer lo mismo, sin quedarse ampliando el buffer:
+
+            std::vector< byte > expected;
+            unsigned            expected_width, expected_height;
+
+            CHECK(lodepng::decode (expected, expected_width, expected_height, truncated) != 0);
+
+            Color_Buffer< Rgba8888 > color_buffer;
+            unsigned                 decoded_width, decoded_height;
+            bool                     opaque;
+
+            CHECK(!png_decode (truncated.data (), truncated.size (), color_buffer, decoded_width, decoded_height, opaque));
+        }
+    }
+
+    void check_oversized_png ()
+    {
+        // Una cabecera que dice medir 65536 x 65536 (16 GB en RGBA) se tiene que rechazar antes de
+        // reservar el buffer de color:
+
+        std::vector< byte > pixels = make_sprite (16, 16);
+        std::vector< byte > png;
+
+        CHECK(lodepng::encode (png, pixels, 16, 16) == 0);
+
+        byte * ihdr = png.data () + 8;
+
+        ihdr[ 8] = 0; ihdr[ 9] = 1; ihdr[10] = 0; ihdr[11] = 0;                 // Ancho
+        ihdr[12] = 0; ihdr[13] = 1; ihdr[14] = 0; ihdr[15] = 0;                 // Alto
+
+        lodepng_chunk_generate_crc (ihdr);
+
+        Color_Buffer< Rgba8888 > color_buffer;
+        unsigned                 decoded_width, decoded_height;
+        bool                     opaque;
+
+        CHECK(!png_decode (png.data (), png.size (), color_buffer, decoded_width, decoded_height, opaque));
+        CHECK(color_buffer.size () == 0);
+    }
+
+}
+
+int main ()
+{
+    check_inflate       ();
+    check_png_decode    ();
+    check_truncated_png ();
+    check_oversized_png ();
+
+    return tests::report ();
+}
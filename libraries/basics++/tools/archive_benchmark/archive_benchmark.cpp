@@ -0,0 +1,364 @@
+/*
+ * ARCHIVE BENCHMARK
+ * Copyright © 2018+ Ángel Rodríguez Ballesteros
+ *
+ * Distributed under the Boost Software License, version  1.0
+ * See documents/LICENSE.TXT or www.boost.org/LICENSE_1_0.txt
+ *
+ * angel.rodriguez@esne.edu
+ *
+ * C2610172328
+ */
+
+// Herramienta de línea de comandos que mide cuánto tarda en leerse una carpeta de assets completa
+// suelta y desde uno o varios archivos generados con tools/asset_packer (por ejemplo, uno con cada
+// opción de -c), y estima el tiempo de carga según el ancho de banda del almacenamiento. Se compila
+// y ejecuta en la máquina de desarrollo (Linux) con el adaptador de Asset de Linux, por ejemplo:
+//
+//     cmake -S ../../projects/host -B build -DBASICS_BUILD_TOOLS=ON
+//     cmake --build build --target archive_benchmark
+//
+//     build/asset_packer -c stored ../../../../assets /tmp/stored.pak
+//     build/asset_packer -c lz4    ../../../../assets /tmp/lz4.pak
+//     build/archive_benchmark ../../../../assets /tmp/stored.pak /tmp/lz4.pak
+//
+// Cada pasada abre todos los assets de la carpeta con basics::Asset::open() y los lee enteros con
+// read_all(), que es lo que hace el juego al cargar. Con los archivos se incluye también mount().
+// De cada origen se muestra:
+//
+//     stored      bytes que hay que leer del almacenamiento
+//     warm        mejor tiempo con los datos ya en la caché del sistema (solo CPU: descompresión
+//                 y copias)
+//     cold        mejor tiempo tras sacar los archivos de la caché con posix_fadvise() (solo con la
+//                 opción -c; mide el almacenamiento de la máquina en la que se ejecuta y no tiene
+//                 efecto con archivos en tmpfs)
+//
+// y una columna por cada ancho de banda de la opción -b (en MB/s, por defecto 25,50,100,200,400)
+// con el tiempo estimado stored / ancho de banda + warm. Las lecturas no se solapan con la
+// descompresión, así que la estimación es la de un almacenamiento con ese ancho de banda.
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <basics/Asset>
+#include <basics/Asset_Archive>
+
+using basics::Asset;
+using basics::Asset_Archive;
+using basics::byte;
+
+namespace
+{
+
+    typedef std::chrono::steady_clock Clock;
+
+    struct Source
+    {
+        std::string name;
+        std::string archive_path;           ///< Ruta absoluta del archivo o vacía con los assets sueltos.
+        double      stored_bytes;
+        double      warm_time;
+        double      cold_time;
+    };
+
+    typedef std::vector< std::string > Path_List;
+
+    // ---------------------------------------------------------------------------------------------
+
+    bool ends_with (const std::string & text, const std::string & suffix)
+    {
+        return text.size () >= suffix.size () && text.compare (text.size () - suffix.size (), suffix.size (), suffix) == 0;
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    bool collect_files (const std::string & root, const std::string & relative_path, Path_List & paths)
+    {
+        std::string directory_path = relative_path.empty () ? root : root + '/' + relative_path;
+        DIR       * directory      = opendir (directory_path.c_str ());
+
+        if (!directory)
+        {
+            std::fprintf (stderr, "ERROR: could not open the directory %s\n", directory_path.c_str ());
+
+            return false;
+        }
+
+        bool success = true;
+
+        while (dirent * item = readdir (directory))
+        {
+            std::string name = item->d_name;
+
+            if (name.empty () || name[0] == '.') continue;
+
+            std::string path = relative_path.empty () ? name : relative_path + '/' + name;
+            struct stat status;
+
+            if (stat ((root + '/' + path).c_str (), &status) != 0)
+            {
+                success = false;
+            }
+            else
+            if (S_ISDIR(status.st_mode))
+            {
+                success = collect_files (root, path, paths) && success;
+            }
+            else
+            if (S_ISREG(status.st_mode) && !ends_with (name, ".pak"))
+            {
+                paths.push_back (path);
+            }
+        }
+
+        closedir (directory);
+
+        return success;
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    double file_size (const std::string & path)
+    {
+        struct stat status;
+
+        return stat (path.c_str (), &status) == 0 ? double(status.st_size) : 0.0;
+    }
+
+    /**
+     * Pide al sistema que saque el archivo de su caché para que la siguiente lectura llegue al
+     * almacenamiento. No necesita privilegios, pero no descarta las páginas que otro proceso tenga
+     * proyectadas.
+     */
+    void evict (const std::string & path)
+    {
+        int file = ::open (path.c_str (), O_RDONLY | O_CLOEXEC);
+
+        if (file >= 0)
+        {
+            posix_fadvise (file, 0, 0, POSIX_FADV_DONTNEED);
+
+            close (file);
+        }
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    /**
+     * Lee todos los assets desde el origen indicado.
+     * @return El tiempo en segundos o un valor negativo si falla algo.
+     */
+    double load_all (const Source & source, const Path_List & paths, double & loaded_bytes)
+    {
+        std::vector< byte > data;
+
+        loaded_bytes = 0.0;
+
+        Clock::time_point start = Clock::now ();
+
+        if (!source.archive_path.empty () && !Asset_Archive::mount (source.archive_path))
+        {
+            std::fprintf (stderr, "ERROR: could not mount %s\n", source.archive_path.c_str ());
+
+            return -1.0;
+        }
+
+        bool success = true;
+
+        for (const std::string & path : paths)
+        {
+            std::shared_ptr< Asset > asset = Asset::open (path);
+
+            if (!asset || !asset->read_all (data))
+            {
+                std::fprintf (stderr, "ERROR: could not read %s from %s\n", path.c_str (), source.name.c_str ());
+
+                success = false;
+                break;
+            }
+
+            loaded_bytes += double(data.size ());
+        }
+
+        Asset_Archive::unmount_all ();
+
+        double seconds = std::chrono::duration< double >(Clock::now () - start).count ();
+
+        return success ? seconds : -1.0;
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    bool parse_bandwidths (const char * text, std::vector< double > & bandwidths)
+    {
+        bandwidths.clear ();
+
+        for (const char * cursor = text; *cursor; )
+        {
+            char * end;
+            double value = std::strtod (cursor, &end);
+
+            if (end == cursor || value <= 0.0) return false;
+
+            bandwidths.push_back (value);
+
+            cursor = *end == ',' ? end + 1 : end;
+
+            if (*end && *end != ',') return false;
+        }
+
+        return !bandwidths.empty ();
+    }
+
+    double megabytes (double bytes)
+    {
+        return bytes / (1024.0 * 1024.0);
+    }
+
+}
+
+int main (int argc, char ** argv)
+{
+    unsigned              passes     = 5;
+    bool                  cold       = false;
+    std::vector< double > bandwidths = { 25, 50, 100, 200, 400 };
+    int                   argument   = 1;
+
+    for ( ; argument < argc && argv[argument][0] == '-'; ++argument)
+    {
+        std::string option = argv[argument];
+
+        if (option == "-c")
+        {
+            cold = true;
+        }
+        else
+        if (option == "-n" && argument + 1 < argc)
+        {
+            passes = unsigned(std::max (1, std::atoi (argv[++argument])));
+        }
+        else
+        if (option == "-b" && argument + 1 < argc && parse_bandwidths (argv[argument + 1], bandwidths))
+        {
+            ++argument;
+        }
+        else
+        {
+            argument = argc;
+            break;
+        }
+    }
+
+    if (argument >= argc)
+    {
+        std::fprintf (stderr, "usage: archive_benchmark [-c] [-n passes] [-b MB/s,MB/s,...] <assets directory> [archive ...]\n");
+
+        return 1;
+    }
+
+    std::string root = argv[argument++];
+    Path_List   paths;
+
+    if (!collect_files (root, "", paths)) return 1;
+
+    std::sort (paths.begin (), paths.end ());
+
+    Asset::set_root (root);
+
+    // Los assets sueltos se comparan con cada uno de los archivos indicados:
+
+    std::vector< Source > sources;
+
+    double loose_bytes = 0.0;
+
+    for (const std::string & path : paths) loose_bytes += file_size (root + '/' + path);
+
+    sources.push_back ({ "loose", "", loose_bytes, 0.0, 0.0 });
+
+    for ( ; argument < argc; ++argument)
+    {
+        char absolute_path[PATH_MAX];
+
+        if (!realpath (argv[argument], absolute_path))
+        {
+            std::fprintf (stderr, "ERROR: could not find %s\n", argv[argument]);
+
+            return 1;
+        }
+
+        sources.push_back ({ argv[argument], absolute_path, file_size (absolute_path), 0.0, 0.0 });
+    }
+
+    double total_bytes = 0.0;
+
+    for (Source & source : sources)
+    {
+        for (unsigned pass = 0; pass < passes; ++pass)
+        {
+            double loaded_bytes;
+            double warm_time = load_all (source, paths, loaded_bytes);
+
+            if (warm_time < 0.0) return 1;
+
+            if (pass == 0 || warm_time < source.warm_time) source.warm_time = warm_time;
+
+            total_bytes = loaded_bytes;
+
+            if (cold)
+            {
+                if (source.archive_path.empty ())
+                {
+                    for (const std::string & path : paths) evict (root + '/' + path);
+                }
+                else
+                    evict (source.archive_path);
+
+                double cold_time = load_all (source, paths, loaded_bytes);
+
+                if (cold_time < 0.0) return 1;
+
+                if (pass == 0 || cold_time < source.cold_time) source.cold_time = cold_time;
+            }
+        }
+    }
+
+    std::printf ("%u assets, %.2f MB once loaded\n\n", unsigned(paths.size ()), megabytes (total_bytes));
+    std::printf ("%-24s %9s %10s", "source", "stored", "warm");
+
+    if (cold) std::printf (" %10s", "cold");
+
+    for (double bandwidth : bandwidths)
+    {
+        char header[32];
+
+        std::snprintf (header, sizeof(header), "@%gMB/s", bandwidth);
+        std::printf   (" %10s", header);
+    }
+
+    std::printf ("\n");
+
+    for (const Source & source : sources)
+    {
+        std::printf ("%-24s %7.2fMB %8.2fms", source.name.c_str (), megabytes (source.stored_bytes), source.warm_time * 1000.0);
+
+        if (cold) std::printf (" %8.2fms", source.cold_time * 1000.0);
+
+        for (double bandwidth : bandwidths)
+        {
+            std::printf (" %8.2fms", (megabytes (source.stored_bytes) / bandwidth + source.warm_time) * 1000.0);
+        }
+
+        std::printf ("\n");
+    }
+
+    return 0;
+}
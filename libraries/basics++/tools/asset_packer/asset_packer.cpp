@@ -0,0 +1,546 @@
+/*
+ * ASSET PACKER
+ * Copyright © 2018+ Ángel Rodríguez Ballesteros
+ *
+ * Distributed under the Boost Software License, version  1.0
+ * See documents/LICENSE.TXT or www.boost.org/LICENSE_1_0.txt
+ *
+ * angel.rodriguez@esne.edu
+ *
+ * C2610172315
+ */
+
+// Herramienta de línea de comandos que empaqueta todos los archivos de una carpeta de assets en un
+// archivo con el formato que lee basics::Asset_Archive. Se compila y ejecuta en la máquina de
+// desarrollo (Linux o macOS). Usa el compresor deflate de lodepng, por ejemplo:
+//
+//     cmake -S ../../projects/host -B build -DBASICS_BUILD_TOOLS=ON
+//     cmake --build build --target asset_packer
+//
+//     build/asset_packer ../../../../assets ../../../../assets.pak
+//
+// Con la opción -c se elige la compresión de las entradas:
+//
+//     auto        (por defecto) DEFLATE con los archivos de texto y LZ4 con el resto
+//     stored      sin compresión
+//     lz4         LZ4 con todos los archivos
+//     deflate     DEFLATE con todos los archivos
+//
+// Los formatos que ya están comprimidos (PNG, KTX y PKM) se guardan siempre sin comprimir: volver a
+// comprimirlos apenas reduce el archivo y obligaría a descomprimirlos al leerlos. El resto de las
+// entradas que apenas se reducen también se guardan sin comprimir.
+//
+// El archivo generado se monta al arrancar el juego con basics::Asset_Archive::mount(). Debe quedar
+// fuera de la carpeta de assets (como en el ejemplo). Cuando existe, la tarea syncAssets del
+// proyecto de Android Studio lo mete en el APK en lugar de los archivos sueltos, que así no se
+// guardan dos veces. Hay que volver a generarlo cada vez que cambian los assets.
+//
+// Al recorrer la carpeta se omiten los .pak y el propio archivo de salida para no empaquetar un
+// archivo anterior dentro del nuevo.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <basics/Asset_Archive>
+#include <basics/fnv>
+#include "lodepng.h"
+
+using basics::Asset_Archive;
+using basics::byte;
+using basics::fnv32;
+
+namespace
+{
+
+    enum Compression
+    {
+        AUTO,
+        STORED,
+        LZ4,
+        DEFLATE
+    };
+
+    struct File
+    {
+        std::string         path;           ///< Ruta relativa a la carpeta de assets con '/' como separador.
+        std::string         full_path;
+        uint32_t            hash;
+        uint32_t            size;
+        uint32_t            codec;
+        std::vector< byte > payload;        ///< Datos tal cual se guardan en el archivo.
+    };
+
+    typedef std::vector< File > File_List;
+
+    // ---------------------------------------------------------------------------------------------
+
+    bool ends_with (const std::string & text, const std::string & suffix)
+    {
+        return text.size () >= suffix.size () && text.compare (text.size () - suffix.size (), suffix.size (), suffix) == 0;
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    /**
+     * @param output Estado del archivo de salida si ya existe (o nullptr) para reconocerlo aunque
+     *               no tenga la extensión .pak.
+     */
+    bool collect_files (const std::string & root, const std::string & relative_path, File_List & files, const struct stat * output)
+    {
+        std::string directory_path = relative_path.empty () ? root : root + '/' + relative_path;
+        DIR       * directory      = opendir (directory_path.c_str ());
+
+        if (!directory)
+        {
+            std::fprintf (stderr, "ERROR: could not open the directory %s\n", directory_path.c_str ());
+
+            return false;
+        }
+
+        bool success = true;
+
+        while (dirent * item = readdir (directory))
+        {
+            std::string name = item->d_name;
+
+            // Se omiten los archivos ocultos (y con ellos . y ..):
+
+            if (name.empty () || name[0] == '.') continue;
+
+            std::string path      = relative_path.empty () ? name : relative_path + '/' + name;
+            std::string full_path = root + '/' + path;
+            struct stat status;
+
+            if (stat (full_path.c_str (), &status) != 0)
+            {
+                std::fprintf (stderr, "ERROR: could not stat %s\n", full_path.c_str ());
+
+                success = false;
+            }
+            else
+            if (S_ISDIR(status.st_mode))
+            {
+                success = collect_files (root, path, files, output) && success;
+            }
+            else
+            if (S_ISREG(status.st_mode))
+            {
+                if (ends_with (name, ".pak") || (output && status.st_dev == output->st_dev && status.st_ino == output->st_ino))
+                {
+                    std::printf ("skipping %s\n", path.c_str ());
+                }
+                else
+                if (uint64_t(status.st_size) > 0xFFFFFFFFu)
+                {
+                    std::fprintf (stderr, "ERROR: %s is too big\n", full_path.c_str ());
+
+                    success = false;
+                }
+                else
+                    files.push_back ({ path, full_path, fnv32 (path), uint32_t(status.st_size), Asset_Archive::STORED, {} });
+            }
+        }
+
+        closedir (directory);
+
+        return success;
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    bool read_file (const File & file, std::vector< byte > & data)
+    {
+        FILE * input = std::fopen (file.full_path.c_str (), "rb");
+
+        if (!input) return false;
+
+        data.resize (file.size);
+
+        size_t count = data.empty () ? 0 : std::fread (data.data (), 1, data.size (), input);
+
+        std::fclose (input);
+
+        return count == file.size;
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    template< size_t COUNT >
+    bool has_extension (const std::string & path, const char * const (& extensions)[COUNT])
+    {
+        for (auto extension : extensions)
+        {
+            size_t length = std::strlen (extension);
+
+            if (path.size () > length && path.compare (path.size () - length, length, extension) == 0) return true;
+        }
+
+        return false;
+    }
+
+    bool is_text (const std::string & path)
+    {
+        static const char * const extensions[] = { ".xml", ".fnt", ".txt", ".json", ".csv", ".glsl", ".vert", ".frag" };
+
+        return has_extension (path, extensions);
+    }
+
+    bool is_compressed_format (const std::string & path)
+    {
+        static const char * const extensions[] = { ".png", ".ktx", ".pkm" };
+
+        return has_extension (path, extensions);
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    void write_length (std::vector< byte > & output, size_t length)
+    {
+        for ( ; length >= 255; length -= 255) output.push_back (255);
+
+        output.push_back (byte(length));
+    }
+
+    /**
+     * Compresor LZ4 sencillo (busca solo la última aparición de cada secuencia de 4 bytes). Respeta
+     * las reglas del formato de bloque: los últimos 5 bytes son literales y la última copia empieza
+     * al menos 12 bytes antes del final.
+     */
+    void lz4_compress (const byte * data, size_t size, std::vector< byte > & output)
+    {
+        const size_t hash_bits = 16;
+
+        std::vector< int32_t > table(size_t(1) << hash_bits, -1);
+
+        size_t anchor = 0;
+        size_t limit  = size > 12 ? size - 12 : 0;
+
+        for (size_t index = 0; index < limit; )
+        {
+            uint32_t sequence;
+
+            std::memcpy (&sequence, data + index, 4);
+
+            uint32_t hash      = (sequence * 2654435761u) >> (32 - hash_bits);
+            int32_t  candidate = table[hash];
+
+            table[hash] = int32_t(index);
+
+            if (candidate < 0 || index - size_t(candidate) > 65535 || std::memcmp (data + candidate, data + index, 4) != 0)
+            {
+                ++index;
+                continue;
+            }
+
+            size_t length     = 4;
+            size_t max_length = size - 5 - index;
+
+            while (length < max_length && data[candidate + length] == data[index + length]) ++length;
+
+            size_t literal  = index - anchor;
+            size_t distance = index - size_t(candidate);
+
+            output.push_back (byte((std::min< size_t > (literal, 15) << 4) | std::min< size_t > (length - 4, 15)));
+
+            if (literal >= 15) write_length (output, literal - 15);
+
+            output.insert (output.end (), data + anchor, data + index);
+            output.push_back (byte(distance     ));
+            output.push_back (byte(distance >> 8));
+
+            if (length - 4 >= 15) write_length (output, length - 4 - 15);
+
+            index += length;
+            anchor = index;
+        }
+
+        size_t literal = size - anchor;
+
+        output.push_back (byte(std::min< size_t > (literal, 15) << 4));
+
+        if (literal >= 15) write_length (output, literal - 15);
+
+        output.insert (output.end (), data + anchor, data + size);
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    bool deflate_compress (const byte * data, size_t size, std::vector< byte > & output)
+    {
+        LodePNGCompressSettings settings;
+
+        lodepng_compress_settings_init (&settings);
+
+        settings.windowsize = 32768;
+
+        unsigned char * compressed      = nullptr;
+        size_t          compressed_size = 0;
+
+        if (lodepng_deflate (&compressed, &compressed_size, data, size, &settings) != 0) return false;
+
+        output.assign (compressed, compressed + compressed_size);
+
+        std::free (compressed);
+
+        return true;
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    /**
+     * Prepara los datos que se guardarán de un archivo. Se comprime cada bloque por separado y se
+     * guarda tal cual si no se reduce. Si el archivo entero no se reduce al menos un 5% o su formato
+     * ya está comprimido se guarda sin comprimir.
+     */
+    bool build_payload (File & file, Compression compression)
+    {
+        std::vector< byte > data;
+
+        if (!read_file (file, data)) return false;
+
+        if (compression == AUTO) compression = is_text (file.path) ? DEFLATE : LZ4;
+
+        if (is_compressed_format (file.path)) compression = STORED;
+
+        if (compression != STORED && !data.empty ())
+        {
+            size_t block_count = (data.size () + Asset_Archive::block_size - 1) / Asset_Archive::block_size;
+
+            std::vector< uint32_t > block_ends(block_count);
+            std::vector< byte     > blocks;
+            std::vector< byte     > compressed;
+
+            for (size_t index = 0; index < block_count; ++index)
+            {
+                const byte * block        = data.data () + index * Asset_Archive::block_size;
+                size_t       block_length = std::min (Asset_Archive::block_size, data.size () - index * Asset_Archive::block_size);
+
+                compressed.clear ();
+
+                if (compression == LZ4)
+                {
+                    lz4_compress (block, block_length, compressed);
+                }
+                else
+                if (!deflate_compress (block, block_length, compressed))
+                {
+                    return false;
+                }
+
+                if (compressed.size () < block_length)
+                {
+                    blocks.insert (blocks.end (), compressed.begin (), compressed.end ());
+                }
+                else
+                    blocks.insert (blocks.end (), block, block + block_length);
+
+                block_ends[index] = uint32_t(blocks.size ());
+            }
+
+            size_t payload_size = block_count * sizeof(uint32_t) + blocks.size ();
+
+            if (payload_size < data.size () - data.size () / 20)
+            {
+                file.codec = compression == LZ4 ? Asset_Archive::LZ4 : Asset_Archive::DEFLATE;
+
+                file.payload.resize (block_count * sizeof(uint32_t));
+
+                std::memcpy (file.payload.data (), block_ends.data (), file.payload.size ());
+
+                file.payload.insert (file.payload.end (), blocks.begin (), blocks.end ());
+
+                return true;
+            }
+        }
+
+        file.codec   = Asset_Archive::STORED;
+        file.payload.swap (data);
+
+        return true;
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    void write_padding (FILE * output, uint64_t & offset, uint64_t alignment)
+    {
+        while (offset % alignment != 0)
+        {
+            std::fputc (0, output);
+
+            offset++;
+        }
+    }
+
+}
+
+int main (int argc, char ** argv)
+{
+    Compression compression = AUTO;
+    int         argument    = 1;
+
+    if (argc == 5 && std::strcmp (argv[1], "-c") == 0)
+    {
+        std::string name = argv[2];
+
+        if (name == "auto"   ) compression = AUTO;    else
+        if (name == "stored" ) compression = STORED;  else
+        if (name == "lz4"    ) compression = LZ4;     else
+        if (name == "deflate") compression = DEFLATE; else
+        {
+            std::fprintf (stderr, "ERROR: unknown compression %s\n", name.c_str ());
+
+            return 1;
+        }
+
+        argument = 3;
+    }
+
+    if (argc - argument != 2)
+    {
+        std::fprintf (stderr, "usage: asset_packer [-c auto|stored|lz4|deflate] <assets directory> <archive>\n");
+
+        return 1;
+    }
+
+    // Los campos del archivo se escriben tal cual están en memoria, en little endian:
+
+    const uint32_t one = 1;
+
+    if (*reinterpret_cast< const char * >(&one) != 1)
+    {
+        std::fprintf (stderr, "ERROR: big endian hosts are not supported\n");
+
+        return 1;
+    }
+
+    std::string root         = argv[argument];
+    std::string archive_path = argv[argument + 1];
+    File_List   files;
+
+    struct stat output_status;
+
+    bool output_exists = stat (archive_path.c_str (), &output_status) == 0;
+
+    if (!collect_files (root, "", files, output_exists ? &output_status : nullptr)) return 1;
+
+    // El índice se ordena por hash (y por ruta dentro del mismo hash) para buscar en él con una
+    // búsqueda binaria:
+
+    std::sort
+    (
+        files.begin (), files.end (),
+        [] (const File & a, const File & b) { return a.hash < b.hash || (a.hash == b.hash && a.path < b.path); }
+    );
+
+    uint64_t original_size = 0;
+
+    for (auto & file : files)
+    {
+        if (!build_payload (file, compression))
+        {
+            std::fprintf (stderr, "ERROR: could not read %s\n", file.full_path.c_str ());
+
+            return 1;
+        }
+
+        original_size += file.size;
+    }
+
+    std::vector< Asset_Archive::Entry > entries(files.size ());
+
+    Asset_Archive::Header header;
+
+    header.magic        = Asset_Archive::magic;
+    header.version      = Asset_Archive::version;
+    header.entry_count  = uint32_t(files.size ());
+    header.names_offset = uint32_t(sizeof(Asset_Archive::Header) + files.size () * sizeof(Asset_Archive::Entry));
+
+    // Se calcula dónde irá cada ruta y los datos de cada archivo:
+
+    uint64_t offset = header.names_offset;
+
+    for (size_t index = 0; index < files.size (); ++index)
+    {
+        entries[index].hash        = files[index].hash;
+        entries[index].name_offset = uint32_t(offset);
+
+        offset += files[index].path.size () + 1;
+    }
+
+    uint64_t names_end = offset;
+
+    for (size_t index = 0; index < files.size (); ++index)
+    {
+        offset = (offset + Asset_Archive::alignment - 1) / Asset_Archive::alignment * Asset_Archive::alignment;
+
+        entries[index].offset      = uint32_t(offset);
+        entries[index].size        = files[index].size;
+        entries[index].stored_size = uint32_t(files[index].payload.size ());
+        entries[index].codec       = files[index].codec;
+
+        offset += files[index].payload.size ();
+    }
+
+    if (offset > 0xFFFFFFFFu)
+    {
+        std::fprintf (stderr, "ERROR: the archive would exceed 4 GB\n");
+
+        return 1;
+    }
+
+    // Se escribe el archivo:
+
+    FILE * output = std::fopen (archive_path.c_str (), "wb");
+
+    if (!output)
+    {
+        std::fprintf (stderr, "ERROR: could not create %s\n", archive_path.c_str ());
+
+        return 1;
+    }
+
+    std::fwrite (&header, sizeof(header), 1, output);
+    std::fwrite (entries.data (), sizeof(Asset_Archive::Entry), entries.size (), output);
+
+    for (auto & file : files)
+    {
+        std::fwrite (file.path.c_str (), 1, file.path.size () + 1, output);
+    }
+
+    offset = names_end;
+
+    for (auto & file : files)
+    {
+        write_padding (output, offset, Asset_Archive::alignment);
+
+        std::fwrite (file.payload.data (), 1, file.payload.size (), output);
+
+        offset += file.payload.size ();
+    }
+
+    if (std::fclose (output) != 0)
+    {
+        std::fprintf (stderr, "ERROR: could not write %s\n", archive_path.c_str ());
+
+        std::remove (archive_path.c_str ());
+
+        return 1;
+    }
+
+    unsigned compressed = 0;
+
+    for (auto & file : files) if (file.codec != Asset_Archive::STORED) compressed++;
+
+    std::printf
+    (
+        "%u assets (%u compressed) packed into %s: %llu bytes from %llu\n",
+        unsigned(files.size ()), compressed, archive_path.c_str (), (unsigned long long)offset, (unsigned long long)original_size
+    );
+
+    return 0;
+}
@@ -0,0 +1,491 @@
+/*
+ * PNG BENCHMARK
+ * Copyright © 2018+ Ángel Rodríguez Ballesteros
+ *
+ * Distributed under the Boost Software License, version  1.0
+ * See documents/LICENSE.TXT or www.boost.org/LICENSE_1_0.txt
+ *
+ * angel.rodriguez@esne.edu
+ *
+ * C2610172327
+ */
+
+// Herramienta de línea de comandos que mide la velocidad de decodificación de los PNG de una
+// carpeta de assets. Compara lodepng::decode() tal cual con basics::png_decode(). Se compila y
+// ejecuta en la máquina de desarrollo (Linux) y lee los archivos con el adaptador de Asset de
+// Linux, por ejemplo:
+//
+//     cmake -S ../../projects/host -B build -DBASICS_BUILD_TOOLS=ON
+//     cmake --build build --target png_benchmark
+//
+//     build/png_benchmark ../../../../assets
+//
+// Con la opción -n se elige el número de pasadas (5 por defecto). De cada imagen se toma el mejor
+// tiempo de todas las pasadas. Las columnas son:
+//
+//     lodepng     lodepng::decode() con su inflate y su conversión de color genérica
+//     inflate     lodepng::decode() con png_inflate() como custom_inflate
+//     basics      basics::png_decode() (inflate propio y decodificación directa a RGBA8)
+//
+// El unfilter de lodepng.cpp ya usa png_unfilter_scanline(), por lo que su mejora está incluida en
+// las tres columnas. La herramienta comprueba además que todos los caminos producen los mismos
+// píxeles.
+//
+// Una segunda tabla compara la decodificación directa en el Color_Buffer de png_decode() con la
+// que tenía antes: lodepng::decode() a un std::vector temporal que después se copia al Color_Buffer
+// (con el mismo png_inflate() para que solo cambie la copia). Cada llamada decodifica en un buffer
+// nuevo, como al cargar una textura, y además del tiempo se muestra el pico de memoria del heap
+// durante la llamada. Para medirlo se interceptan malloc(), realloc() y free() de glibc.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <dirent.h>
+#include <malloc.h>
+#include <sys/stat.h>
+#include <basics/Asset>
+#include <basics/png_decode>
+#include "lodepng.h"
+#include "png_internal.hpp"
+
+using basics::Asset;
+using basics::byte;
+using basics::Color_Buffer;
+using basics::Rgba8888;
+
+// -------------------------------------------------------------------------------------------------
+
+// Cuenta los bytes reservados en el heap. Se sustituyen las funciones de glibc, que siguen haciendo
+// el trabajo a través de sus nombres internos, así que también se cuenta la memoria que lodepng y
+// png_inflate() piden con malloc() y realloc():
+
+namespace
+{
+
+    size_t heap_used = 0;
+    size_t heap_peak = 0;
+
+    void count_allocation (size_t bytes)
+    {
+        heap_used += bytes;
+        heap_peak  = std::max (heap_peak, heap_used);
+    }
+
+    void count_release (size_t bytes)
+    {
+        heap_used -= std::min (heap_used, bytes);
+    }
+
+}
+
+extern "C"
+{
+
+    void * __libc_malloc  (size_t size);
+    void * __libc_calloc  (size_t count, size_t size);
+    void * __libc_realloc (void * block, size_t size);
+    void   __libc_free    (void * block);
+
+    void * malloc (size_t size) noexcept
+    {
+        void * block = __libc_malloc (size);
+
+        if (block) count_allocation (malloc_usable_size (block));
+
+        return block;
+    }
+
+    void * calloc (size_t count, size_t size) noexcept
+    {
+        void * block = __libc_calloc (count, size);
+
+        if (block) count_allocation (malloc_usable_size (block));
+
+        return block;
+    }
+
+    void * realloc (void * block, size_t size) noexcept
+    {
+        size_t old_size  = block ? malloc_usable_size (block) : 0;
+        void * new_block = __libc_realloc (block, size);
+
+        if (new_block || size == 0) count_release (old_size);
+        if (new_block             ) count_allocation (malloc_usable_size (new_block));
+
+        return new_block;
+    }
+
+    void free (void * block) noexcept
+    {
+        if (block) count_release (malloc_usable_size (block));
+
+        __libc_free (block);
+    }
+
+}
+
+namespace
+{
+
+    typedef std::chrono::steady_clock Clock;
+
+    struct Image
+    {
+        std::string         path;           ///< Ruta relativa a la carpeta de assets.
+        std::vector< byte > encoded;
+        unsigned            width;
+        unsigned            height;
+    };
+
+    typedef std::vector< Image > Image_List;
+
+    bool last_opaque;                       ///< Resultado de decode_copy() para que no se descarte su cálculo.
+
+    // ---------------------------------------------------------------------------------------------
+
+    bool ends_with (const std::string & text, const std::string & suffix)
+    {
+        return text.size () >= suffix.size () && text.compare (text.size () - suffix.size (), suffix.size (), suffix) == 0;
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    bool collect_images (const std::string & root, const std::string & relative_path, Image_List & images)
+    {
+        std::string directory_path = relative_path.empty () ? root : root + '/' + relative_path;
+        DIR       * directory      = opendir (directory_path.c_str ());
+
+        if (!directory)
+        {
+            std::fprintf (stderr, "ERROR: could not open the directory %s\n", directory_path.c_str ());
+
+            return false;
+        }
+
+        bool success = true;
+
+        while (dirent * item = readdir (directory))
+        {
+            std::string name = item->d_name;
+
+            if (name.empty () || name[0] == '.') continue;
+
+            std::string path = relative_path.empty () ? name : relative_path + '/' + name;
+            struct stat status;
+
+            if (stat ((root + '/' + path).c_str (), &status) != 0)
+            {
+                success = false;
+            }
+            else
+            if (S_ISDIR(status.st_mode))
+            {
+                success = collect_images (root, path, images) && success;
+            }
+            else
+            if (S_ISREG(status.st_mode) && ends_with (name, ".png"))
+            {
+                images.push_back ({ path, {}, 0, 0 });
+            }
+        }
+
+        closedir (directory);
+
+        return success;
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    /**
+     * Lee la imagen a través de basics::Asset, igual que la lee el juego.
+     */
+    bool load_image (Image & image)
+    {
+        std::shared_ptr< Asset > asset = Asset::open (image.path);
+
+        if (!asset || !asset->read_all (image.encoded))
+        {
+            std::fprintf (stderr, "ERROR: could not read %s\n", image.path.c_str ());
+
+            return false;
+        }
+
+        lodepng::State state;
+
+        if (lodepng_inspect (&image.width, &image.height, &state, image.encoded.data (), image.encoded.size ()) != 0)
+        {
+            std::fprintf (stderr, "ERROR: %s is not a valid PNG\n", image.path.c_str ());
+
+            return false;
+        }
+
+        return true;
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    bool decode_lodepng (const Image & image, std::vector< byte > & pixels)
+    {
+        unsigned width, height;
+
+        pixels.clear ();
+
+        return lodepng::decode (pixels, width, height, image.encoded.data (), image.encoded.size ()) == 0;
+    }
+
+    bool decode_inflate (const Image & image, std::vector< byte > & pixels)
+    {
+        unsigned       width, height;
+        lodepng::State state;
+
+        state.decoder.zlibsettings.custom_inflate = basics::png_inflate;
+
+        pixels.clear ();
+
+        return lodepng::decode (pixels, width, height, state, image.encoded.data (), image.encoded.size ()) == 0;
+    }
+
+    bool decode_basics (const Image & image, Color_Buffer< Rgba8888 > & color_buffer)
+    {
+        unsigned width, height;
+        bool     opaque;
+
+        return basics::png_decode (image.encoded.data (), image.encoded.size (), color_buffer, width, height, opaque);
+    }
+
+    /**
+     * Lo que hacía png_decode() antes de decodificar directamente en el Color_Buffer.
+     */
+    bool decode_copy (const Image & image, Color_Buffer< Rgba8888 > & color_buffer)
+    {
+        std::vector< byte > decoded_data;
+
+        if (!decode_inflate (image, decoded_data)) return false;
+
+        color_buffer.resize (image.width, image.height);
+
+        byte * buffer = color_buffer;
+
+        for (auto i = decoded_data.begin (); i != decoded_data.end (); ++i)
+        {
+            *buffer++ = *i;
+        }
+
+        bool opaque = true;
+
+        for (size_t alpha = 3, end = decoded_data.size (); alpha < end; alpha += 4)
+        {
+            if (decoded_data[alpha] != 0xFF)
+            {
+                opaque = false;
+                break;
+            }
+        }
+
+        last_opaque = opaque;
+
+        return true;
+    }
+
+    /**
+     * Decodifica la imagen en un Color_Buffer nuevo.
+     * @param peak Recibe los bytes del heap que llegan a estar reservados durante la llamada.
+     */
+    template< typename DECODE >
+    bool decode_fresh (const Image & image, DECODE decode, size_t & peak)
+    {
+        size_t base = heap_used;
+
+        heap_peak = base;
+
+        bool success;
+
+        {
+            Color_Buffer< Rgba8888 > color_buffer;
+
+            success = decode (image, color_buffer);
+        }
+
+        peak = heap_peak - base;
+
+        return success;
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    /**
+     * @return El mejor tiempo en segundos de todas las pasadas o un valor negativo si falla alguna.
+     */
+    template< typename DECODE >
+    double measure (unsigned passes, DECODE decode)
+    {
+        double best = 0.0;
+
+        for (unsigned pass = 0; pass < passes; ++pass)
+        {
+            Clock::time_point start = Clock::now ();
+
+            if (!decode ()) return -1.0;
+
+            double seconds = std::chrono::duration< double >(Clock::now () - start).count ();
+
+            if (pass == 0 || seconds < best) best = seconds;
+        }
+
+        return best;
+    }
+
+    double megabytes_per_second (double bytes, double seconds)
+    {
+        return seconds > 0.0 ? bytes / seconds / (1024.0 * 1024.0) : 0.0;
+    }
+
+}
+
+int main (int argc, char ** argv)
+{
+    unsigned passes   = 5;
+    int      argument = 1;
+
+    if (argc == 4 && std::strcmp (argv[1], "-n") == 0)
+    {
+        passes   = unsigned(std::max (1, std::atoi (argv[2])));
+        argument = 3;
+    }
+
+    if (argc - argument != 1)
+    {
+        std::fprintf (stderr, "usage: png_benchmark [-n passes] <assets directory>\n");
+
+        return 1;
+    }
+
+    std::string root = argv[argument];
+    Image_List  images;
+
+    Asset::set_root (root);
+
+    if (!collect_images (root, "", images)) return 1;
+
+    if (images.empty ())
+    {
+        std::fprintf (stderr, "ERROR: there are no PNG files in %s\n", root.c_str ());
+
+        return 1;
+    }
+
+    std::sort (images.begin (), images.end (), [] (const Image & a, const Image & b) { return a.path < b.path; });
+
+    std::printf ("%-40s %11s %10s %10s %10s %8s\n", "image", "size", "lodepng", "inflate", "basics", "speedup");
+
+    std::vector< byte >      pixels;
+    Color_Buffer< Rgba8888 > color_buffer;
+
+    double total_bytes   = 0.0;
+    double total_lodepng = 0.0;
+    double total_inflate = 0.0;
+    double total_basics  = 0.0;
+
+    for (Image & image : images)
+    {
+        if (!load_image (image)) return 1;
+
+        double lodepng_time = measure (passes, [&] () { return decode_lodepng (image, pixels      ); });
+        double inflate_time = measure (passes, [&] () { return decode_inflate (image, pixels      ); });
+        double basics_time  = measure (passes, [&] () { return decode_basics  (image, color_buffer); });
+
+        if (lodepng_time < 0.0 || inflate_time < 0.0 || basics_time < 0.0)
+        {
+            std::fprintf (stderr, "ERROR: could not decode %s\n", image.path.c_str ());
+
+            return 1;
+        }
+
+        // Los tres caminos deben dar los mismos píxeles (pixels contiene aún los del segundo):
+
+        if (pixels.size () != size_t(color_buffer.get_width ()) * color_buffer.get_height () * sizeof(Rgba8888)
+        ||  std::memcmp (pixels.data (), static_cast< byte * >(color_buffer), pixels.size ()) != 0)
+        {
+            std::fprintf (stderr, "ERROR: the decoded pixels of %s do not match\n", image.path.c_str ());
+
+            return 1;
+        }
+
+        char size[32];
+
+        std::snprintf (size, sizeof(size), "%ux%u", image.width, image.height);
+
+        std::printf
+        (
+            "%-40s %11s %8.3fms %8.3fms %8.3fms %7.2fx\n",
+            image.path.c_str (), size, lodepng_time * 1000.0, inflate_time * 1000.0, basics_time * 1000.0, lodepng_time / basics_time
+        );
+
+        total_bytes   += double(pixels.size ());
+        total_lodepng += lodepng_time;
+        total_inflate += inflate_time;
+        total_basics  += basics_time;
+    }
+
+    std::printf
+    (
+        "\n%u images, %.1f MB decoded\n"
+        "lodepng  %8.3fms %8.1f MB/s\n"
+        "inflate  %8.3fms %8.1f MB/s\n"
+        "basics   %8.3fms %8.1f MB/s (%.2fx)\n",
+        unsigned(images.size ()), total_bytes / (1024.0 * 1024.0),
+        total_lodepng * 1000.0, megabytes_per_second (total_bytes, total_lodepng),
+        total_inflate * 1000.0, megabytes_per_second (total_bytes, total_inflate),
+        total_basics  * 1000.0, megabytes_per_second (total_bytes, total_basics ), total_lodepng / total_basics
+    );
+
+    // Decodificación directa frente a decodificación con copia:
+
+    std::printf ("\n%-40s %10s %10s %11s %11s\n", "image", "copy", "direct", "copy peak", "direct peak");
+
+    double total_copy        = 0.0;
+    double total_direct      = 0.0;
+    size_t total_copy_peak   = 0;
+    size_t total_direct_peak = 0;
+
+    for (const Image & image : images)
+    {
+        size_t copy_peak   = 0;
+        size_t direct_peak = 0;
+
+        double copy_time   = measure (passes, [&] () { return decode_fresh (image, decode_copy,   copy_peak  ); });
+        double direct_time = measure (passes, [&] () { return decode_fresh (image, decode_basics, direct_peak); });
+
+        if (copy_time < 0.0 || direct_time < 0.0)
+        {
+            std::fprintf (stderr, "ERROR: could not decode %s\n", image.path.c_str ());
+
+            return 1;
+        }
+
+        std::printf
+        (
+            "%-40s %8.3fms %8.3fms %9zuKB %9zuKB\n",
+            image.path.c_str (), copy_time * 1000.0, direct_time * 1000.0, copy_peak / 1024, direct_peak / 1024
+        );
+
+        total_copy        += copy_time;
+        total_direct      += direct_time;
+        total_copy_peak    = std::max (total_copy_peak,   copy_peak  );
+        total_direct_peak  = std::max (total_direct_peak, direct_peak);
+    }
+
+    std::printf
+    (
+        "\ncopy     %8.3fms peak %zuKB\n"
+        "direct   %8.3fms peak %zuKB (%.2fx)\n",
+        total_copy   * 1000.0, total_copy_peak   / 1024,
+        total_direct * 1000.0, total_direct_peak / 1024, total_copy / total_direct
+    );
+
+    return 0;
+}
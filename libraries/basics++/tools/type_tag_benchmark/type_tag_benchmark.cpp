@@ -0,0 +1,274 @@
+/*
+ * TYPE TAG BENCHMARK
+ * Copyright © 2018+ Ángel Rodríguez Ballesteros
+ *
+ * Distributed under the Boost Software License, version  1.0
+ * See documents/LICENSE.TXT or www.boost.org/LICENSE_1_0.txt
+ *
+ * angel.rodriguez@esne.edu
+ *
+ * C2610172340
+ */
+
+// Microbenchmark de lo que cuesta en cada dibujado reconocer el tipo de las texturas y del canvas.
+// Compara las etiquetas de tipo (Texture_2D::get_backend() y Graphics_Context::get_renderer() con
+// su caché) con la búsqueda en el mapa y el dynamic_cast que se usaban antes. Se compila y ejecuta
+// en la máquina de desarrollo (Linux) con los adaptadores de Linux y necesita GLESv2 y EGL, porque
+// enlaza la biblioteca de OpenGL ES, por ejemplo:
+//
+//     cmake -S ../../projects/host -B build -DBASICS_BUILD_TOOLS=ON
+//     cmake --build build --target type_tag_benchmark
+//
+//     build/type_tag_benchmark
+//
+// Las texturas son opengles::Texture_2D reales creadas con su factoría (no se inicializan, así que
+// no hace falta un contexto de OpenGL ES) mezcladas con las de otro backend, y en cada dibujado se
+// elige una distinta para que el compilador no pueda resolver el tipo de antemano. Se comprueban
+// como lo hace Canvas_ES2 al dibujar un quad. Los renderers se buscan con el get_renderer() real de
+// Graphics_Context; el contexto y el canvas son mínimos porque los de OpenGL ES necesitan una
+// ventana y un contexto de EGL, pero get_renderer() solo usa el mapa y la etiqueta de Canvas.
+// Con -n se elige el número de dibujados por pasada (4 millones por defecto).
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+#include <basics/Canvas>
+#include <basics/Color_Buffer>
+#include <basics/Graphics_Context>
+#include <basics/Id>
+#include <basics/opengles/Texture_2D>
+#include <basics/Window>
+
+using namespace basics;
+
+namespace
+{
+
+    typedef std::chrono::steady_clock Clock;
+
+    // ---------------------------------------------------------------------------------------------
+
+    /**
+     * Textura de otro backend, que el renderer debe rechazar.
+     */
+    class Other_Texture final : public Texture_2D
+    {
+    public:
+
+        Other_Texture() : Texture_2D(ID(other), 64, 64)
+        {
+        }
+
+        bool initialize () override { return true; }
+        void finalize   () override { }
+    };
+
+    // ---------------------------------------------------------------------------------------------
+
+    class Bench_Window final : public Window
+    {
+    public:
+
+        Bench_Window() : Window(ID(window))
+        {
+        }
+
+        Size2u   get_size   () override { return { 1, 1 }; }
+        unsigned get_width  () override { return 1; }
+        unsigned get_height () override { return 1; }
+    };
+
+    class Bench_Canvas final : public Canvas
+    {
+    };
+
+    /**
+     * Contexto sin gráficos en el que se registran los renderers como lo hace el de OpenGL ES.
+     */
+    class Bench_Context final : public Graphics_Context
+    {
+    public:
+
+        Bench_Context(Window & window) : Graphics_Context(window)
+        {
+        }
+
+        /**
+         * Lo que hacía get_renderer() antes de usar las etiquetas de tipo.
+         */
+        template< class RENDERER >
+        RENDERER * get_renderer_with_dynamic_cast (Id id)
+        {
+            auto renderer = renderers.find (id);
+
+            return dynamic_cast< RENDERER * >(renderer != renderers.end () ? renderer->second.get () : nullptr);
+        }
+
+        void     invalidate         () override { }
+        void     suspend            () override { }
+        bool     resume             () override { return true; }
+        bool     is_available       () const override { return true; }
+        bool     is_current         () const override { return true; }
+        Id       get_id             () const override { return ID(bench); }
+        unsigned get_surface_width  () override { return 1; }
+        unsigned get_surface_height () override { return 1; }
+        bool     set_sync_swap      (bool) override { return true; }
+        void     reset_viewport     () override { }
+        void     set_viewport       (const Point2u &, const Size2u &) override { }
+        bool     make_current       () override { return true; }
+        bool     flush_and_display  () override { return true; }
+    };
+
+    // ---------------------------------------------------------------------------------------------
+
+    /**
+     * @return Los nanosegundos por iteración de la mejor pasada.
+     */
+    template< typename FUNCTION >
+    double measure (unsigned passes, size_t iterations, FUNCTION function)
+    {
+        double best = 0.0;
+
+        for (unsigned pass = 0; pass < passes; ++pass)
+        {
+            Clock::time_point start = Clock::now ();
+
+            function ();
+
+            double seconds = std::chrono::duration< double >(Clock::now () - start).count ();
+
+            if (pass == 0 || seconds < best) best = seconds;
+        }
+
+        return best * 1e9 / double(iterations);
+    }
+
+    // El resultado se guarda aquí para que el compilador no elimine los bucles:
+
+    volatile unsigned long sink;
+
+}
+
+int main (int argc, char ** argv)
+{
+    size_t   draws  = 4 * 1024 * 1024;
+    unsigned passes = 5;
+
+    if (argc == 3 && std::strcmp (argv[1], "-n") == 0)
+    {
+        draws = size_t(std::max (1, std::atoi (argv[2])));
+    }
+    else
+    if (argc != 1)
+    {
+        std::fprintf (stderr, "usage: type_tag_benchmark [-n draws]\n");
+
+        return 1;
+    }
+
+    // Texturas: tres de cada cuatro son del backend del renderer:
+
+    std::vector< std::shared_ptr< Texture_2D > > textures;
+
+    for (unsigned index = 0; index < 64; ++index)
+    {
+        if (index % 4 == 3)
+        {
+            textures.push_back (std::make_shared< Other_Texture > ());
+        }
+        else
+        {
+            Texture_2D::Options      options = {};
+            Color_Buffer< Rgba8888 > color_buffer(16 + index, 16);
+
+            options.width  = color_buffer.get_width  ();
+            options.height = color_buffer.get_height ();
+
+            textures.push_back (opengles::Texture_2D::create (ID(opengles2), color_buffer, options));
+        }
+    }
+
+    std::vector< const Texture_2D * > draw_list(draws);
+
+    unsigned random = 12345;
+
+    for (const Texture_2D * & texture : draw_list)
+    {
+        random  = random * 1664525u + 1013904223u;
+        texture = textures[(random >> 16) % textures.size ()].get ();
+    }
+
+    double dynamic_cast_time = measure (passes, draws, [&] ()
+    {
+        unsigned long sum = 0;
+
+        for (const Texture_2D * texture : draw_list)
+        {
+            const opengles::Texture_2D * opengl_es_texture = dynamic_cast< const opengles::Texture_2D * >(texture);
+
+            if (opengl_es_texture) sum += opengl_es_texture->get_width () + opengl_es_texture->has_alpha_plane ();
+        }
+
+        sink = sum;
+    });
+
+    double type_tag_time = measure (passes, draws, [&] ()
+    {
+        unsigned long sum = 0;
+
+        for (const Texture_2D * texture : draw_list)
+        {
+            if (texture && texture->get_backend () == ID(opengles2))
+            {
+                const opengles::Texture_2D * opengl_es_texture = static_cast< const opengles::Texture_2D * >(texture);
+
+                sum += opengl_es_texture->get_width () + opengl_es_texture->has_alpha_plane ();
+            }
+        }
+
+        sink = sum;
+    });
+
+    // Renderers: el contexto tiene varios registrados y cada escena pide el canvas en cada fotograma:
+
+    Bench_Window  window;
+    Bench_Context context(window);
+
+    context.add (ID(canvas), std::make_shared< Bench_Canvas > ());
+    context.add (ID(sprites), std::make_shared< Bench_Canvas > ());
+    context.add (ID(hud), std::make_shared< Bench_Canvas > ());
+
+    double map_lookup_time = measure (passes, draws, [&] ()
+    {
+        unsigned long sum = 0;
+
+        for (size_t frame = 0; frame < draws; ++frame)
+        {
+            sum += context.get_renderer_with_dynamic_cast< Canvas > (ID(canvas)) != nullptr;
+        }
+
+        sink = sum;
+    });
+
+    double cached_time = measure (passes, draws, [&] ()
+    {
+        unsigned long sum = 0;
+
+        for (size_t frame = 0; frame < draws; ++frame)
+        {
+            sum += context.get_renderer< Canvas > (ID(canvas)) != nullptr;
+        }
+
+        sink = sum;
+    });
+
+    std::printf ("%zu iterations, best of %u passes\n\n", draws, passes);
+    std::printf ("texture per draw    dynamic_cast %6.2fns   type tag %6.2fns   (%.1fx)\n", dynamic_cast_time, type_tag_time, dynamic_cast_time / type_tag_time);
+    std::printf ("renderer per frame  map + cast   %6.2fns   cached   %6.2fns   (%.1fx)\n", map_lookup_time,   cached_time,   map_lookup_time   / cached_time  );
+
+    return 0;
+}